@@ -77,7 +77,10 @@
 
 // Audio Synthesizer Libraries
 #include  "../Audio/audio.h"
+#include  "../Audio/audio_stream.h"
 #include  "../Synthesizer/piano.h"
+#include  "../Synthesizer/synth.h"
+#include  "../Synthesizer/render_cache.h"
 #include  "../Testbenches/SampleBasedSynthesizerTest.h"
 
 // Video Processing Libraries
@@ -86,6 +89,22 @@
 #include  <stdlib.h>
 #include  <string.h>
 #include "../Video/video.h"
+#include "../Video/video_kernel.h"
+#include "../Video/key_map.h"
+#include "../Video/tile_change.h"
+#include "../Video/bit_mask.h"
+#include "../Video/vga_buffer.h"
+#include "../Video/dirty_rect.h"
+#include "../Video/frame_sync.h"
+#include "../Video/key_cal.h"
+#include "../Video/key_state.h"
+#include "../Video/key_detect.h"
+#include "../Video/key_preview.h"
+#include "../Video/edge.h"
+#include "../Video/frame_ring.h"
+
+// Task Pipeline
+#include  "pipeline.h"
 
 // Compute absolute address of any slave component attached to lightweight bridge
 // base is address of component in QSYS window
@@ -94,15 +113,73 @@
 #define FPGA_TO_HPS_LW_ADDR(base)  ((void *) (((char *)  (ALT_LWFPGASLVS_ADDR))+ (base)))
 
 // App Priority
+// Frame sync only polls, audio output is closest to its deadline, capture must copy the frame before
+// the decoder overwrites it, rendering is the long-running batch work
 #define APP_TASK_PRIO 5
-#define VIDEO_PROCESS_TASK_PRIO 6
-#define GENERATE_SOUND_TASK_PRIO 7
+#define FRAME_SYNC_TASK_PRIO 6
+#define AUDIO_OUTPUT_TASK_PRIO 7
+#define NOTE_SCHEDULER_TASK_PRIO 8
+#define CAPTURE_TASK_PRIO 9
+#define KEY_DETECT_TASK_PRIO 10
+#define RENDER_MIX_TASK_PRIO 11
+#define SPECULATIVE_RENDER_TASK_PRIO 12
 
 // Task Size
 #define TASK_STACK_SIZE 4096
 #define AUDIO_TASK_STACK_SIZE 16384
 #define VIDEO_TASK_STACK_SIZE 8192
 
+// Frames rendered per push into the audio ring
+#define AUDIO_BLOCK_FRAMES 256
+
+// Pipeline Queue Depths
+#define NUM_CAPTURE_FRAMES 3
+#define NOTE_Q_SIZE 16
+#define NUM_AUDIO_BLOCKS 8
+#define SPECULATE_Q_SIZE 8
+
+// Most frames per second handed to capture, and how long after completing a frame may be copied
+// before it counts as late (the decoder is rewriting its top rows by then)
+#define FRAME_RATE_TARGET 30
+#define FRAME_LATE_MS 4
+#define FRAME_PERIOD_TICKS (OS_TICKS_PER_SEC / FRAME_RATE_TARGET)
+#define FRAME_LATE_TICKS ((FRAME_LATE_MS * OS_TICKS_PER_SEC + 999) / 1000)
+
+// What the key detector sees: the picture, edges from the Video-In core, or the same edges
+// computed from the picture in software
+#define EDGE_MODE_OFF 0
+#define EDGE_MODE_HARDWARE 1
+#define EDGE_MODE_SOFTWARE 2
+#define EDGE_MODE EDGE_MODE_OFF
+
+// Which captured frame detection takes next: the oldest waiting, or the newest with older ones
+// passed over and a full ring's newest replaced
+#define FRAME_RING_POLICY FRAME_RING_NEWEST_WINS
+
+// Seconds between pipeline metric reports from the watchdog task
+#define PIPELINE_REPORT_PERIOD_S 10
+
+// Piano Keys
+#define NUM_PIANO_KEYS 88
+
+// Frames between calibration attempts while no calibration is stored
+#define CALIBRATE_PERIOD 30
+
+// Calibration kept in the FPGA SDRAM past the VGA buffers, which survives an HPS reset while the
+// FPGA stays configured
+#define KEY_CAL_STORE ((KeyCal *)0xC0100000)
+
+// Simultaneous notes mixed by the renderer
+#define NUM_VOICES 2
+
+// Notes rendered ahead of their note-on
+#define RENDER_CACHE_SLOTS 4
+
+// Note event encoding for the note queue (key is 1 to 88, so events are never NULL)
+#define NOTE_EVENT(key, on) ((void *)(INT32U)(((key) << 1) | (on)))
+#define NOTE_EVENT_KEY(msg) (((INT32U)(msg)) >> 1)
+#define NOTE_EVENT_ON(msg) (((INT32U)(msg)) & 1)
+
 /*
 *********************************************************************************************************
 *                                       LOCAL GLOBAL VARIABLES
@@ -111,11 +188,67 @@
 
 // Task Stacks
 CPU_STK AppTaskStartStk[TASK_STACK_SIZE];
-CPU_STK VideoProcessTaskStk[VIDEO_TASK_STACK_SIZE];
-CPU_STK GenerateSoundTaskStk[AUDIO_TASK_STACK_SIZE];
-
-// Screen Buffer
-char screen_buffer[VIDEO_IN_PIXEL_SIZE];
+CPU_STK FrameSyncTaskStk[TASK_STACK_SIZE];
+CPU_STK CaptureTaskStk[VIDEO_TASK_STACK_SIZE];
+CPU_STK KeyDetectTaskStk[VIDEO_TASK_STACK_SIZE];
+CPU_STK NoteSchedulerTaskStk[TASK_STACK_SIZE];
+CPU_STK RenderMixTaskStk[AUDIO_TASK_STACK_SIZE];
+CPU_STK SpeculativeRenderTaskStk[AUDIO_TASK_STACK_SIZE];
+CPU_STK AudioOutputTaskStk[TASK_STACK_SIZE];
+
+// VGA Front and Back Buffers, the regions last drawn into the front one and the preview drawn into
+// them (see key_preview.h)
+static VgaBuffer vgaBuffer;
+static DirtyRects previewRects;
+static KeyPreview keyPreview;
+
+// Video-In Frame Completion, posted to capture through FrameSem
+static FrameSync frameSync;
+static OS_EVENT *FrameSem;
+
+// Captured Frames (same 512-byte row layout as the video-in buffer), the ring capture fills and
+// detection consumes them through, and FrameReadySem, posted once per frame filled
+static char captureFrames[NUM_CAPTURE_FRAMES][VIDEO_IN_FRAME_HEIGHT * VIDEO_IN_ROW_STRIDE];
+static FrameRing frameRing;
+static OS_EVENT *FrameReadySem;
+
+// Key Detector: the key regions in the captured frame, their calibration and the state detection
+// keeps between frames
+static KeyDetector keyDetector;
+
+#if EDGE_MODE == EDGE_MODE_SOFTWARE
+// Software Edges of the captured frame, in its row layout
+static EdgeFilter keyEdges;
+static unsigned char edgeFrame[VIDEO_IN_FRAME_HEIGHT * VIDEO_IN_ROW_STRIDE];
+#endif
+
+// Voices and Audio Blocks (interleaved stereo from the synth engine), and the block ending the stream
+static short voiceData[NUM_VOICES][MAX_PITCH_SHIFT_OUTPUT_ARRAY_SIZE];
+static SynthEngine synth;
+static short audioBlocks[NUM_AUDIO_BLOCKS][AUDIO_BLOCK_FRAMES * 2];
+static short * volatile audioLastBlock;
+static INT32U outputLeft[AUDIO_BLOCK_FRAMES], outputRight[AUDIO_BLOCK_FRAMES];
+
+// Speculative Renders of the keys the tracker predicts, RenderSem serializes pitchshift() and the cache
+static short renderBuffers[RENDER_CACHE_SLOTS][MAX_PITCH_SHIFT_OUTPUT_ARRAY_SIZE];
+static RenderCache renderCache;
+static OS_EVENT *RenderSem;
+
+// Pipeline Queues
+static void *NoteQStorage[NOTE_Q_SIZE];
+static void *AudioQStorage[NUM_AUDIO_BLOCKS];
+static void *FreeBlockQStorage[NUM_AUDIO_BLOCKS];
+static void *SpeculateQStorage[SPECULATE_Q_SIZE];
+
+static PipelineQueue NoteQ, AudioQ, FreeBlockQ, SpeculateQ;
+
+// Debounced Key transitions, posted to the scheduler through KeyEventSem
+static KeyEventRing keyEvents;
+static OS_EVENT *KeyEventSem;
+
+// Pipeline Stages
+static PipelineStage CaptureStage, KeyDetectStage, NoteSchedulerStage, RenderMixStage, AudioOutputStage;
+static PipelineStage SpeculateStage;
 
 // The Light Weight Video-In Controller
 volatile unsigned int *h2p_lw_video_in_control_addr = NULL;
@@ -130,8 +263,20 @@ volatile unsigned int *h2p_lw_video_edge_control_addr = NULL;
 
 // Task Processes
 static void WatchDogFeederTask (void *p_arg);
-static void VideoProcessTask (void *p_arg);
-static void GenerateSoundTask (void *p_arg);
+static void FrameSyncTask (void *p_arg);
+static void CaptureTask (void *p_arg);
+static void KeyDetectTask (void *p_arg);
+static void NoteSchedulerTask (void *p_arg);
+static void RenderMixTask (void *p_arg);
+static void AudioOutputTask (void *p_arg);
+static void SpeculativeRenderTask (void *p_arg);
+
+// Pipeline Setup
+static void PipelineInit (void);
+static void CreateTask (void (*task)(void *), OS_STK *stk, INT32U stk_size, INT8U prio);
+
+// Note Rendering
+static int RenderNote (int key, short *data);
 
 /*
 *********************************************************************************************************
@@ -197,8 +342,7 @@ int main ()
 	// Video In Configuration
 	*(h2p_lw_video_in_control_addr) = VIDEO_ON; // Turn On Video Capture
 	*(h2p_lw_video_in_resolution_addr) = VIDEO_DIMENSION;  // High 240 Low 320
-	*h2p_lw_video_edge_control_addr = EDGE_ON; // 1 means edges
-	*h2p_lw_video_edge_control_addr = EDGE_OFF; // 1 means edges
+	*h2p_lw_video_edge_control_addr = EDGE_MODE == EDGE_MODE_HARDWARE ? EDGE_ON : EDGE_OFF; // 1 means edges
 
 	// Create the start task.
 	// Watchdog Timer Loop
@@ -216,37 +360,20 @@ int main ()
 		exit(0); /* Handle error. */
 	}
 
-	// Create the Video task.
-	// Processes Video frames
-	os_err = OSTaskCreateExt((void (*)(void *)) VideoProcessTask,
-	                                 (void          * ) 0,
-	                                 (OS_STK        * )&VideoProcessTaskStk[VIDEO_TASK_STACK_SIZE - 1],
-	                                 (INT8U           ) VIDEO_PROCESS_TASK_PRIO,
-	                                 (INT16U          ) VIDEO_PROCESS_TASK_PRIO,
-	                                 (OS_STK        * )&VideoProcessTaskStk[0],
-	                                 (INT32U          ) VIDEO_TASK_STACK_SIZE,
-	                                 (void          * )0,
-	                                 (INT16U          )(OS_TASK_OPT_STK_CLR | OS_TASK_OPT_STK_CHK));
+	// Create the pipeline queues and stages
+	PipelineInit();
 
-	if (os_err != OS_ERR_NONE) {
-		exit(0); /* Handle error. */
-	}
+	// Create the pipeline tasks.
+	// Frame Sync -> Capture -> Key Detect -> Note Scheduler -> Render/Mix -> Audio Output
+	CreateTask(FrameSyncTask, FrameSyncTaskStk, TASK_STACK_SIZE, FRAME_SYNC_TASK_PRIO);
+	CreateTask(CaptureTask, CaptureTaskStk, VIDEO_TASK_STACK_SIZE, CAPTURE_TASK_PRIO);
+	CreateTask(KeyDetectTask, KeyDetectTaskStk, VIDEO_TASK_STACK_SIZE, KEY_DETECT_TASK_PRIO);
+	CreateTask(NoteSchedulerTask, NoteSchedulerTaskStk, TASK_STACK_SIZE, NOTE_SCHEDULER_TASK_PRIO);
+	CreateTask(RenderMixTask, RenderMixTaskStk, AUDIO_TASK_STACK_SIZE, RENDER_MIX_TASK_PRIO);
+	CreateTask(AudioOutputTask, AudioOutputTaskStk, TASK_STACK_SIZE, AUDIO_OUTPUT_TASK_PRIO);
 
-	// Create the Audio task.
-	// Generates the Audio
-//    os_err = OSTaskCreateExt((void (*)(void *)) GenerateSoundTask,
-//                                 (void          * ) 0,
-//                                 (OS_STK        * )&GenerateSoundTaskStk[AUDIO_TASK_STACK_SIZE - 1],
-//                                 (INT8U           ) GENERATE_SOUND_TASK_PRIO,
-//                                 (INT16U          ) GENERATE_SOUND_TASK_PRIO,
-//                                 (OS_STK        * )&GenerateSoundTaskStk[0],
-//                                 (INT32U          ) AUDIO_TASK_STACK_SIZE,
-//                                 (void          * )0,
-//                                 (INT16U          )(OS_TASK_OPT_STK_CLR | OS_TASK_OPT_STK_CHK));
-//
-//	if (os_err != OS_ERR_NONE) {
-//		exit(0); /* Handle error. */
-//	}
+	// Key Detect -> Speculative Render, below everything else
+	CreateTask(SpeculativeRenderTask, SpeculativeRenderTaskStk, AUDIO_TASK_STACK_SIZE, SPECULATIVE_RENDER_TASK_PRIO);
 
 	// CPU Initalize/Config
 	CPU_IntEn();
@@ -275,12 +402,40 @@ int main ()
 static  void  WatchDogFeederTask (void *p_arg)
 {
 
+	// Seconds since the last pipeline report
+	int seconds = 0;
+
 	// Configure and enable OS tick interrupt.
     BSP_OS_TmrTickInit(OS_TICKS_PER_SEC);
 
     // Loop Forever
     for(;;) {
 
+    	// Print stage and queue metrics
+    	if (++seconds >= PIPELINE_REPORT_PERIOD_S) {
+    		pipeline_report();
+    		printf("video-in   frames %8u  posted %8u  skipped %6u  dropped %6u  late %6u  max latency %3u ticks\n",
+    			   frameSync.frames, frameSync.posted, frameSync.skipped, frameSync.dropped,
+    			   frameSync.late, frameSync.max_latency);
+    		printf("frame ring filled %8u  dropped %6u  replaced %6u  taken %8u  skipped %6u  max age %3u ticks\n",
+    			   frameRing.filled, frameRing.dropped, frameRing.replaced, frameRing.taken,
+    			   frameRing.skipped, frameRing.max_age);
+    		printf("audio      irqs %10u  frames out %10u  underruns %6u  min fill %5u of %5u\n",
+    			   audio_stream_stats.irqs, audio_stream_stats.frames_out, audio_stream_stats.underruns,
+    			   audio_stream_stats.min_fill, AUDIO_RING_FRAMES);
+    		audio_stream_stats.min_fill = AUDIO_RING_FRAMES;
+    		printf("keys       frames %8u  events %8u  chatter %6u  overflows %6u\n",
+    			   keyDetector.state.frames, keyDetector.state.events, keyDetector.state.chatter, keyEvents.overflows);
+    		printf("pyramid    frames %8u  idle %10u  words packed %10u  background updates %8u\n",
+    			   keyDetector.pyramid.frames, keyDetector.pyramid.idle_frames, keyDetector.pyramid.words_packed,
+    			   keyDetector.background.updates);
+    		printf("speculate  renders %7u  hits %10u  misses %7u  hit rate %3u%%  wasted %6u  wasted ticks %8u of %8u  tracks %u\n",
+    			   renderCache.renders, renderCache.hits, renderCache.misses,
+    			   renderCache.hits + renderCache.misses ? 100 * renderCache.hits / (renderCache.hits + renderCache.misses) : 0,
+    			   renderCache.wasted, renderCache.wasted_ticks, renderCache.render_ticks, keyDetector.tracker.started);
+    		seconds = 0;
+    	}
+
     	// Reset the watchdog.
     	BSP_WatchDog_Reset();
 
@@ -302,9 +457,130 @@ static  void  WatchDogFeederTask (void *p_arg)
 
 /*
 *********************************************************************************************************
-*                                           VideoProcessTask()
+*                                           CreateTask()
 *
-* Description : Video Processing Task.
+* Description : Creates a pipeline task with stack checking, exiting on failure like main().
+*
+* Arguments   : task        Task entry point.
+*               stk         Task stack.
+*               stk_size    Number of OS_STK entries in stk.
+*               prio        Task priority (also used as its ID).
+*
+* Returns     : none.
+*********************************************************************************************************
+*/
+
+static  void  CreateTask (void (*task)(void *), OS_STK *stk, INT32U stk_size, INT8U prio)
+{
+	INT8U os_err;
+
+	os_err = OSTaskCreateExt(task,
+	                                 (void          * ) 0,
+	                                 (OS_STK        * )&stk[stk_size - 1],
+	                                 (INT8U           ) prio,
+	                                 (INT16U          ) prio,
+	                                 (OS_STK        * )&stk[0],
+	                                 (INT32U          ) stk_size,
+	                                 (void          * )0,
+	                                 (INT16U          )(OS_TASK_OPT_STK_CLR | OS_TASK_OPT_STK_CHK));
+
+	if (os_err != OS_ERR_NONE) {
+		exit(0); /* Handle error. */
+	}
+}
+
+/*
+*********************************************************************************************************
+*                                           RenderNote()
+*
+* Description : Renders a note by pitch shifting the sample of its octave.
+*
+* Arguments   : key         Piano key, 1 to NUM_PIANO_KEYS.
+*               data        Buffer of MAX_PITCH_SHIFT_OUTPUT_ARRAY_SIZE samples to render into.
+*
+* Returns     : Samples rendered, 0 for a key with no sample.
+*
+* Notes       : (1) pitchshift() works in shared state, the caller must hold RenderSem.
+*********************************************************************************************************
+*/
+
+static  int  RenderNote (int key, short *data)
+{
+	int index = 0;
+	Sample *tempSample = sizeOfSound(key, &index);
+	Sample *voiceSample = &(Sample) { .size = 0, .data = data };
+
+	if (tempSample == NULL) {
+		return 0;
+	}
+
+	voiceSample->size = tempSample->size;
+	pitchshift(&tempSample, &voiceSample, index);
+
+	return voiceSample->size;
+}
+
+/*
+*********************************************************************************************************
+*                                           PipelineInit()
+*
+* Description : Creates the bounded queues between the pipeline stages and fills the free lists.
+*
+* Arguments   : none.
+*
+* Returns     : none.
+*
+* Notes       : (1) Audio blocks circulate between a "full" queue and a "free" queue, so a stage can
+*                   never run more than the pool size ahead of its consumer.  Captured frames go
+*                   round frameRing instead, which never blocks capture (see CaptureTask()).
+*********************************************************************************************************
+*/
+
+static  void  PipelineInit (void)
+{
+	short *buffers[RENDER_CACHE_SLOTS];
+	unsigned char *frames[NUM_CAPTURE_FRAMES];
+	int i;
+
+	pipeline_queue_create(&NoteQ, NoteQStorage, NOTE_Q_SIZE, "notes");
+	pipeline_queue_create(&AudioQ, AudioQStorage, NUM_AUDIO_BLOCKS, "audio");
+	pipeline_queue_create(&FreeBlockQ, FreeBlockQStorage, NUM_AUDIO_BLOCKS, "freeblocks");
+	pipeline_queue_create(&SpeculateQ, SpeculateQStorage, SPECULATE_Q_SIZE, "speculate");
+
+	FrameSem = OSSemCreate(0);
+	FrameReadySem = OSSemCreate(0);
+	KeyEventSem = OSSemCreate(0);
+	RenderSem = OSSemCreate(1);
+	key_event_init(&keyEvents);
+
+	for (i = 0; i < RENDER_CACHE_SLOTS; i++) {
+		buffers[i] = renderBuffers[i];
+	}
+	renderCacheInit(&renderCache, buffers, RENDER_CACHE_SLOTS, MAX_PITCH_SHIFT_OUTPUT_ARRAY_SIZE);
+
+	pipeline_stage_init(&CaptureStage, "capture");
+	pipeline_stage_init(&KeyDetectStage, "detect");
+	pipeline_stage_init(&NoteSchedulerStage, "schedule");
+	pipeline_stage_init(&RenderMixStage, "render");
+	pipeline_stage_init(&AudioOutputStage, "output");
+	pipeline_stage_init(&SpeculateStage, "speculate");
+
+	for (i = 0; i < NUM_CAPTURE_FRAMES; i++) {
+		frames[i] = (unsigned char *)captureFrames[i];
+	}
+	frame_ring_init(&frameRing, frames, NUM_CAPTURE_FRAMES, FRAME_RING_POLICY);
+
+	for (i = 0; i < NUM_AUDIO_BLOCKS; i++) {
+		OSQPost(FreeBlockQ.event, audioBlocks[i]);
+	}
+}
+
+/*
+*********************************************************************************************************
+*                                           FrameSyncTask()
+*
+* Description : Polls the Video-In DMA controller every tick and posts FrameSem when a frame completes
+*               that capture should copy, at no more than FRAME_RATE_TARGET frames per second.
 *
 * Arguments   : p_arg       Argument passed by 'OSTaskCreate()'.
 *
@@ -312,69 +588,226 @@ static  void  WatchDogFeederTask (void *p_arg)
 *
 * Created by  : main().
 *
-* Notes       : (1) The ticker MUST be initialised AFTER multitasking has started.
+* Notes       : (1) The controller raises no interrupt, so a tick of polling is the frame latency.
+*               (2) FrameSem never counts past one.  The video-in buffer only holds the newest frame,
+*                   so a frame capture has not woken for yet is dropped in favour of the next.
 *********************************************************************************************************
 */
 
-static  void  VideoProcessTask (void *p_arg)
+static  void  FrameSyncTask (void *p_arg)
 {
 
-	// VGA Pixel Buffer
-	volatile unsigned int * vga_pixel_ptr = SDRAM_BASE;
+	frame_sync_init(&frameSync, FPGA_TO_HPS_LW_ADDR(VIDEO_IN_BASE), FRAME_PERIOD_TICKS, FRAME_LATE_TICKS);
+
+	// Loop Forever
+    for(;;) {
+
+    	if (frame_sync_poll(&frameSync, OSTimeGet())) {
+    		OSSemPost(FrameSem);
+    	}
+
+    	OSTimeDly(1);
+    }
+
+}
+
+/*
+*********************************************************************************************************
+*                                           CaptureTask()
+*
+* Description : Capture stage.  Waits for FrameSyncTask to report a completed frame, copies it into
+*               the next slot of frameRing with its frame number and completion tick, and wakes key
+*               detection.
+*
+* Arguments   : p_arg       Argument passed by 'OSTaskCreate()'.
+*
+* Returns     : none.
+*
+* Created by  : main().
+*
+* Notes       : (1) Capture never waits for detection.  With NUM_CAPTURE_FRAMES slots the next frame
+*                   is copied while detection works on the last one, and when every slot is full
+*                   FRAME_RING_POLICY decides: FRAME_RING_NEWEST_WINS copies over the newest frame
+*                   still waiting, FRAME_RING_KEEP_OLDEST drops the new one.
+*               (2) Capture outranks key detection so the copy starts within a tick of the frame
+*                   completing; frames copied later than FRAME_LATE_MS count as late.
+*********************************************************************************************************
+*/
+
+static  void  CaptureTask (void *p_arg)
+{
 
 	// Video Input Buffer
 	volatile unsigned int * video_in_ptr = FPGA_ONCHIP_BASE;
+	INT8U os_err;
+
+	// Loop Forever
+    for(;;) {
+
+    	// Wait for the next frame
+		OSSemPend(FrameSem, 0, &os_err);
+
+		INT32U start = OSTimeGet();
+		FrameRingSlot *slot;
+		int j;
+
+		frame_sync_take(&frameSync, start);
+
+		slot = frame_ring_fill_begin(&frameRing);
+		if (slot == NULL) {
+			continue;
+		}
+
+		// Copy the visible part of each row
+		for (j = 0; j < VIDEO_IN_FRAME_HEIGHT; j++) {
+			memcpy(slot->data + j * VIDEO_IN_ROW_STRIDE, (char *)video_in_ptr + j * VIDEO_IN_ROW_STRIDE, VIDEO_IN_FRAME_WIDTH);
+		}
+
+		frame_ring_fill_end(&frameRing, slot, frameSync.frames, frameSync.ready_tick);
+		OSSemPost(FrameReadySem);
+		pipeline_stage_done(&CaptureStage, start);
+    }
+
+}
+
+/*
+*********************************************************************************************************
+*                                           KeyDetectTask()
+*
+* Description : Key detection stage.  Takes each captured frame from frameRing and runs it through
+*               keyDetector (see key_detect.h), waking the scheduler for key transitions and sending
+*               the keys the tracker predicts to the speculative renderer.  Every KEY_PREVIEW_PERIOD
+*               frames the changed tiles and keys are drawn into the VGA back buffer, which is then swapped in.
+*
+* Arguments   : p_arg       Argument passed by 'OSTaskCreate()'.
+*
+* Returns     : none.
+*
+* Created by  : main().
+*
+* Notes       : (1) Capture alone advances frameRing's fill index and this task alone its consume
+*                   index.  FrameReadySem counts fills, not frames waiting, so after frames were
+*                   skipped or replaced a wake may find nothing new and goes back to waiting.
+*               (2) The slot from frame_ring_acquire() is held until frame_ring_release() at the end
+*                   of the loop, after the preview has read it, and capture never writes a held slot.
+*                   Only one slot is ever held, which is what lets FRAME_RING_NEWEST_WINS replace the
+*                   newest waiting frame with two slots or more without touching the held one.
+*********************************************************************************************************
+*/
+
+static  void  KeyDetectTask (void *p_arg)
+{
+
+	// Preview Index
+	INT32U preview_count = 0;
 
-	// Video Input Index
-	int i,j;
+	// Word and Key Index
+	int t, k;
 
-	// Clear the screen
-	VGA_box (vga_pixel_ptr, 0, 0, 639, 479, 0x03);
+	// Keys sent to be rendered ahead while they stay predicted
+	unsigned int requested[KEY_MAP_MASK_WORDS];
 
-	// Copy current screen
-	memcpy(screen_buffer, vga_pixel_ptr, VGA_AREA * sizeof(char *));
+	// Calibration State
+	int calibrated;
+
+	// Key regions, from the stored calibration or equal zones until one is found
+	key_detect_init(&keyDetector);
+	calibrated = key_cal_valid(KEY_CAL_STORE) && key_detect_use_cal(&keyDetector, KEY_CAL_STORE) == 0;
+	if (!calibrated) {
+		key_detect_use_default(&keyDetector);
+	}
+	memset(requested, 0, sizeof(requested));
+#if EDGE_MODE == EDGE_MODE_SOFTWARE
+	edge_filter_init(&keyEdges);
+#endif
+
+	// Clear both screens and draw the released keys, the first preview draws every tile
+	vga_buffer_init(&vgaBuffer, (void *)VGA_BUFFER_CTRL_BASE,
+					(unsigned char *)VGA_BUFFER_0_ADDR, VGA_BUFFER_0_ADDR,
+					(unsigned char *)VGA_BUFFER_1_ADDR, VGA_BUFFER_1_ADDR);
+	dirty_rect_init(&previewRects, VIDEO_IN_WIDTH, VIDEO_IN_HEIGHT);
+	key_preview_init(&keyPreview);
+	for (t = 0; t < 2; t++) {
+		key_preview_clear(vgaBuffer.pixels[t], &keyDetector);
+	}
 
 	// Loop Forever
     for(;;) {
 
-    	// Delay
-		OSTimeDlyHMSM(0, 0, 0, 500);
+    	INT8U err;
+    	const FrameRingSlot *slot;
+    	const unsigned char *frame;
+    	INT32U start;
+
+    	// Wake per frame filled, taking the frame the policy picks (note 1)
+    	OSSemPend(FrameReadySem, 0, &err);
+    	start = OSTimeGet();
+    	slot = frame_ring_acquire(&frameRing, start);
+    	if (slot == NULL) {
+    		continue;
+    	}
+    	frame = slot->data;
+
+#if EDGE_MODE == EDGE_MODE_SOFTWARE
+		// Detect on edges, like the core sends in edge mode
+		edge_filter_frame(&keyEdges, frame, VIDEO_IN_ROW_STRIDE, edgeFrame, VIDEO_IN_ROW_STRIDE, 0, VIDEO_IN_FRAME_HEIGHT);
+		frame = edgeFrame;
+#endif
+
+		// Look for the keyboard every CALIBRATE_PERIOD frames until it is found
+		if (!calibrated && keyDetector.frames % CALIBRATE_PERIOD == 0 &&
+			key_detect_calibrate(&keyDetector, frame) == KEY_CAL_OK &&
+			key_detect_use_cal(&keyDetector, &keyDetector.cal) == 0) {
+			memcpy(KEY_CAL_STORE, &keyDetector.cal, sizeof(KeyCal));
+			calibrated = keyPreview.strip_stale = 1;
+		}
+
+		// Detect, on the rectified strip when there is one, waking the scheduler only for
+		// transitions; the preview draws the frame detected on
+		if (key_detect_frame(&keyDetector, frame, &keyEvents) > 0) {
+			OSSemPost(KeyEventSem);
+		}
+
+		// Render the keys the fingertips are heading for, each once while it stays predicted and up
+		for (t = 0; t < KEY_MAP_MASK_WORDS; t++) {
+			unsigned int ahead = keyDetector.tracker.predicted[t] & ~keyDetector.state.down[t] & ~requested[t];
 
-		// Read Video-in and Image Process frame to buffer
-		// Loop through Video dimension
-		for (i=0; i<320; i++) {
-			for (j=10; j<240; j++) {
+			while (ahead != 0) {
+				k = 32 * t + BIT_MASK_CTZ(ahead);
+				pipeline_post(&SpeculateQ, NOTE_EVENT(k + 1, 1));
+				ahead &= ahead - 1;
+			}
+			requested[t] = keyDetector.tracker.predicted[t];
+		}
 
-				// Read in Pixel
-				int pixel = video_in_read_pixel(video_in_ptr, i, j);
+		key_preview_frame(&keyPreview, &keyDetector);
 
-				// Find RGB values
-				int r = (pixel & 0b11100000) >> 5;
-				int g = (pixel & 0b00011100) >> 2;
-				int b = pixel & 0b00000011;
+		// Update the back buffer and show it, put off while the last swap waits for the retrace
+		if (++preview_count >= KEY_PREVIEW_PERIOD && !vga_buffer_swap_pending(&vgaBuffer)) {
+			unsigned char *back = vgaBuffer.pixels[vgaBuffer.back];
 
-				// Check if over white threshold and set to RED
-				if(r + g + b > 16) pixel = 0b11100000;
+			// Catch up with what the front buffer got last time, then draw what changed since
+			dirty_rect_flush(&previewRects, back, vgaBuffer.pixels[vgaBuffer.back ^ 1], VGA_Y);
+			key_preview_draw(&keyPreview, back, &keyDetector, &previewRects);
 
-				// Copy pixel to Screen
-				screen_buffer[((j+240)<<10) + (i+320)] = pixel;
-			}
+			vga_buffer_swap(&vgaBuffer);
+			preview_count = 0;
 		}
 
-		// Memory Copy Screen Buffer to VGA
-		memcpy(vga_pixel_ptr, screen_buffer, VGA_AREA * sizeof(char));
+		// The slot can be refilled (note 2)
+		frame_ring_release(&frameRing);
 
-		// Delay
-		OSTimeDlyHMSM(0, 0, 0, 500);
+		pipeline_stage_done(&KeyDetectStage, start);
     }
 
 }
 
 /*
 *********************************************************************************************************
-*                                           GenerateSoundTask()
+*                                           NoteSchedulerTask()
 *
-* Description : Generate Sound Task.
+* Description : Note scheduler stage.  Woken by KeyEventSem, moves the key transitions from the event
+*               ring onto the note queue.
 *
 * Arguments   : p_arg       Argument passed by 'OSTaskCreate()'.
 *
@@ -382,51 +815,245 @@ static  void  VideoProcessTask (void *p_arg)
 *
 * Created by  : main().
 *
-* Notes       : (1) The ticker MUST be initialised AFTER multitasking has started.
+* Notes       : (1) A note event is never dropped: a lost note-off would hold a voice on and a lost
+*                   note-on would be silent.  While NoteQ is full the scheduler sleeps a tick at a
+*                   time, leaving later transitions in the event ring, until the renderer catches up.
 *********************************************************************************************************
 */
 
-static  void  GenerateSoundTask (void *p_arg)
+static  void  NoteSchedulerTask (void *p_arg)
 {
-	// Audio Base
-	volatile int * audio_ptr = (int *) AUDIO_BASE;
 
-	// Looping variables
-    int i = 0, i_s= 1;
+	// Loop Forever
+    for(;;) {
+
+    	INT8U err;
+    	KeyEvent event;
+
+    	OSSemPend(KeyEventSem, 0, &err);
 
-    // Struct Sample initalization
-	Sample *samples_t = NULL;	
+    	INT32U start = OSTimeGet();
+
+    	if (err != OS_ERR_NONE) {
+    		continue;
+    	}
+
+    	// A wakeup may find events an earlier one already took
+    	while (key_event_pop(&keyEvents, &event) == 0) {
+    		pipeline_post_blocking(&NoteQ, NOTE_EVENT(event.key + 1, event.down));
+    	}
+
+    	pipeline_stage_done(&NoteSchedulerStage, start);
+    }
+
+}
+
+/*
+*********************************************************************************************************
+*                                           RenderMixTask()
+*
+* Description : Voice renderer and mixer stage.  Renders a note into a synth engine voice for each
+*               note-on event, or copies it from the render cache when it was rendered ahead, releases
+*               it on note-off, and has the engine mix the active voices into audio blocks for the
+*               output stage.
+*
+* Arguments   : p_arg       Argument passed by 'OSTaskCreate()'.
+*
+* Returns     : none.
+*
+* Created by  : main().
+*
+* Notes       : (1) Waiting for a free block is what throttles this stage to the codec rate.
+*               (2) A note-on when every voice is busy replaces the voice that has played longest.
+*               (3) A note-on may wait for the speculative render in progress to finish.  Nothing runs
+*                   between the two priorities, so the wait is never longer than one render.
+*               (4) The block in which the last voice finishes ends the stream: the output stage calls
+*                   audio_stream_end() once it is queued, so the silence until the next note-on is not
+*                   counted as underruns.
+*********************************************************************************************************
+*/
+
+static  void  RenderMixTask (void *p_arg)
+{
+
+	SynthConfig config;
+
+	synthConfigDefault(&config);
+	config.sample_rate = AUDIO_SAMPLE_RATE;
+	config.block_frames = AUDIO_BLOCK_FRAMES;
+	config.num_voices = NUM_VOICES;
+	config.format = SYNTH_FORMAT_S16;
+	synthInit(&synth, &config);
 
 	// Loop Forever
     for(;;) {
 
-        int fifospace = *(audio_ptr + 1);
-    	if ( (fifospace & 0xFF000000) && (fifospace & 0x00FF0000) )
-    	{
-    		if (samples_t != NULL && i < samples_t->size)
-    		{
-        		int r = samples_t->data[i++];
-        		*(audio_ptr + 2) = r;
-        		*(audio_ptr + 3) = r;
+    	INT8U err;
+    	void *event;
+
+    	// Sleep on the note queue when silent, otherwise just pick up pending notes
+    	event = synthActiveVoices(&synth) ? pipeline_accept(&NoteQ) : pipeline_pend(&NoteQ, 0, &err);
+
+    	while (event != NULL) {
+    		INT32U start = OSTimeGet();
+    		int key = NOTE_EVENT_KEY(event);
+
+    		if (NOTE_EVENT_ON(event)) {
+    			int voice = synthAllocVoice(&synth);
+    			const RenderSlot *slot;
+    			int size;
+
+    			// Rendered ahead or rendered now (note 3)
+    			OSSemPend(RenderSem, 0, &err);
+    			slot = renderCacheHit(&renderCache, key, OSTimeGet());
+    			if (slot != NULL) {
+    				memcpy(voiceData[voice], slot->data, slot->size * sizeof(short));
+    				size = slot->size;
+    			}
+    			else {
+    				size = RenderNote(key, voiceData[voice]);
+    			}
+    			OSSemPost(RenderSem);
+
+    			if (size > 0) {
+    				synthNoteOn(&synth, voice, key, voiceData[voice], size);
+    			}
     		}
-    		else
-    		{
-    			i = 0;
-    			i_s += 1;
-
-    			int tempIndex = 0;
-    			int *index = &tempIndex;
-    			Sample *tempSample1 = sizeOfSound(i_s, index);
-    			short sampleData[MAX_PITCH_SHIFT_OUTPUT_ARRAY_SIZE];
-
-    			samples_t = &(Sample) { .size = tempSample1->size, .data = sampleData };
-    			pitchshift(&tempSample1, &samples_t, *index);
+    		else {
+    			synthNoteOff(&synth, key);
     		}
 
-    		if (i_s > 88)
-    		{
-    			break;
-    		}
+    		pipeline_stage_done(&RenderMixStage, start);
+    		event = pipeline_accept(&NoteQ);
     	}
+
+    	// Mix one block
+    	short *block = (short *)pipeline_pend(&FreeBlockQ, 0, &err);
+
+    	if (err != OS_ERR_NONE) {
+    		continue;
+    	}
+
+    	synthRender(&synth, block, AUDIO_BLOCK_FRAMES);
+
+    	// Nothing left sounding, this block ends the stream (note 4)
+    	if (synthActiveVoices(&synth) == 0) {
+    		audioLastBlock = block;
+    	}
+
+    	pipeline_post_blocking(&AudioQ, block);
     }
+
+}
+
+/*
+*********************************************************************************************************
+*                                           SpeculativeRenderTask()
+*
+* Description : Speculative render stage.  Renders the keys the tracker expects to be pressed into the
+*               render cache, so their note-on only has to copy them.
+*
+* Arguments   : p_arg       Argument passed by 'OSTaskCreate()'.
+*
+* Returns     : none.
+*
+* Created by  : main().
+*
+* Notes       : (1) Runs below every other task and only on time they leave.  A key already cached,
+*                   pressed since it was sent or no longer predicted is not rendered.
+*               (2) The cache reuses the slot played longest ago.  One evicted before it was played
+*                   counts as wasted, with the ticks its render took.
+*********************************************************************************************************
+*/
+
+static  void  SpeculativeRenderTask (void *p_arg)
+{
+
+	// Loop Forever
+    for(;;) {
+
+    	INT8U err;
+    	void *event = pipeline_pend(&SpeculateQ, 0, &err);
+    	INT32U start = OSTimeGet();
+    	RenderSlot *slot;
+    	int key;
+
+    	if (err != OS_ERR_NONE) {
+    		continue;
+    	}
+
+    	key = NOTE_EVENT_KEY(event);
+
+    	// Skip what there is no point rendering (note 1)
+    	if (((keyDetector.state.down[(key - 1) >> 5] >> ((key - 1) & 31)) & 1) ||
+    		!((keyDetector.tracker.predicted[(key - 1) >> 5] >> ((key - 1) & 31)) & 1)) {
+    		continue;
+    	}
+
+    	OSSemPend(RenderSem, 0, &err);
+    	slot = renderCacheFind(&renderCache, key) == NULL ? renderCacheClaim(&renderCache, key, start) : NULL;
+    	if (slot != NULL) {
+    		INT32U render_start = OSTimeGet();
+    		int size = RenderNote(key, slot->data);
+
+    		renderCacheReady(&renderCache, slot, size, OSTimeGet(), OSTimeGet() - render_start);
+    	}
+    	OSSemPost(RenderSem);
+
+    	pipeline_stage_done(&SpeculateStage, start);
+    }
+
+}
+
+/*
+*********************************************************************************************************
+*                                           AudioOutputTask()
+*
+* Description : Audio output stage.  Moves mixed blocks into the interrupt driven audio ring.
+*
+* Arguments   : p_arg       Argument passed by 'OSTaskCreate()'.
+*
+* Returns     : none.
+*
+* Created by  : main().
+*********************************************************************************************************
+*/
+
+static  void  AudioOutputTask (void *p_arg)
+{
+
+	// Output is fed by the write interrupt from here on
+	audio_stream_init();
+
+	// Loop Forever
+    for(;;) {
+
+    	INT8U err;
+    	short *block = (short *)pipeline_pend(&AudioQ, 0, &err);
+    	INT32U start = OSTimeGet();
+    	int k;
+
+    	if (err != OS_ERR_NONE) {
+    		continue;
+    	}
+
+    	// Split the interleaved block into the codec's per-channel words
+    	for (k = 0; k < AUDIO_BLOCK_FRAMES; k++) {
+    		outputLeft[k] = (INT32U)(INT32S)block[2 * k];
+    		outputRight[k] = (INT32U)(INT32S)block[2 * k + 1];
+    	}
+
+		// Queue for the write interrupt, sleeping only while the ring is full
+		audio_stream_write_blocking(outputLeft, outputRight, AUDIO_BLOCK_FRAMES);
+
+		// The last block before silence, running dry after it is not an underrun
+		if (block == audioLastBlock) {
+			audioLastBlock = NULL;
+			audio_stream_end();
+		}
+
+		OSQPost(FreeBlockQ.event, block);
+		pipeline_stage_done(&AudioOutputStage, start);
+    }
+
 }
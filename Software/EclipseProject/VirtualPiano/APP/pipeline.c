@@ -0,0 +1,210 @@
+/*
+*********************************************************************************************************
+*
+*                                          PIPELINE CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : pipeline.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Thin wrappers over OSQPost()/OSQPend() that record queue metrics.  Two posting
+* 				  policies are offered: pipeline_post() drops the message when the queue is full (for
+* 				  stages where only the newest data matters), pipeline_post_blocking() sleeps a tick and
+* 				  retries so that a slow consumer throttles its producer.
+*
+*********************************************************************************************************
+*/
+
+#include  <stdio.h>
+#include  "pipeline.h"
+
+static PipelineQueue *queues[PIPELINE_MAX_QUEUES];
+static INT8U num_queues = 0;
+
+static PipelineStage *stages[PIPELINE_MAX_QUEUES];
+static INT8U num_stages = 0;
+
+/*
+*********************************************************************************************************
+*                                           pipeline_queue_create()
+*
+* Description : Creates a bounded message queue and registers it for pipeline_report().
+*
+* Arguments   : queue       Queue to initialize
+*               storage     Array of size message pointers used by the OS
+*               size        Capacity of the queue
+*               name        Name shown in reports
+*
+*********************************************************************************************************
+*/
+
+void pipeline_queue_create(PipelineQueue *queue, void **storage, INT16U size, const char *name)
+{
+	INT8U err;
+
+	queue->event = OSQCreate(storage, size);
+	queue->name = name;
+	queue->size = size;
+	queue->max_occupancy = 0;
+	queue->posts = 0;
+	queue->full = 0;
+	queue->drops = 0;
+
+	OSEventNameSet(queue->event, (INT8U *)name, &err);
+
+	if (num_queues < PIPELINE_MAX_QUEUES) {
+		queues[num_queues++] = queue;
+	}
+}
+
+/*
+*********************************************************************************************************
+*                                           pipeline_occupancy()
+*
+* Returns     : The number of messages waiting in the queue
+*
+*********************************************************************************************************
+*/
+
+INT16U pipeline_occupancy(PipelineQueue *queue)
+{
+	OS_Q_DATA data;
+
+	if (OSQQuery(queue->event, &data) != OS_ERR_NONE) {
+		return 0;
+	}
+
+	return data.OSNMsgs;
+}
+
+static void pipeline_posted(PipelineQueue *queue)
+{
+	INT16U occupancy = pipeline_occupancy(queue);
+
+	queue->posts++;
+	if (occupancy > queue->max_occupancy) {
+		queue->max_occupancy = occupancy;
+	}
+}
+
+/*
+*********************************************************************************************************
+*                                           pipeline_post()
+*
+* Description : Posts without waiting.  A full queue drops the message.
+*
+* Returns     : OS_ERR_NONE if the message was queued, OS_ERR_Q_FULL if it was dropped
+*
+*********************************************************************************************************
+*/
+
+INT8U pipeline_post(PipelineQueue *queue, void *msg)
+{
+	INT8U err = OSQPost(queue->event, msg);
+
+	if (err == OS_ERR_NONE) {
+		pipeline_posted(queue);
+	}
+	else if (err == OS_ERR_Q_FULL) {
+		queue->full++;
+		queue->drops++;
+	}
+
+	return err;
+}
+
+/*
+*********************************************************************************************************
+*                                           pipeline_post_blocking()
+*
+* Description : Posts, sleeping one tick at a time while the queue is full.
+*
+*********************************************************************************************************
+*/
+
+void pipeline_post_blocking(PipelineQueue *queue, void *msg)
+{
+	while (OSQPost(queue->event, msg) == OS_ERR_Q_FULL) {
+		queue->full++;
+		OSTimeDly(1);
+	}
+
+	pipeline_posted(queue);
+}
+
+void *pipeline_pend(PipelineQueue *queue, INT32U timeout, INT8U *err)
+{
+	return OSQPend(queue->event, timeout, err);
+}
+
+void *pipeline_accept(PipelineQueue *queue)
+{
+	INT8U err;
+
+	return OSQAccept(queue->event, &err);
+}
+
+/*
+*********************************************************************************************************
+*                                           pipeline_stage_init()
+*
+* Description : Registers a stage for pipeline_report().
+*
+*********************************************************************************************************
+*/
+
+void pipeline_stage_init(PipelineStage *stage, const char *name)
+{
+	stage->name = name;
+	stage->processed = 0;
+	stage->busy_ticks = 0;
+
+	if (num_stages < PIPELINE_MAX_QUEUES) {
+		stages[num_stages++] = stage;
+	}
+}
+
+/*
+*********************************************************************************************************
+*                                           pipeline_stage_done()
+*
+* Description : Accounts for one handled message that started at start_tick (from OSTimeGet()).
+*
+*********************************************************************************************************
+*/
+
+void pipeline_stage_done(PipelineStage *stage, INT32U start_tick)
+{
+	stage->processed++;
+	stage->busy_ticks += OSTimeGet() - start_tick;
+}
+
+/*
+*********************************************************************************************************
+*                                           pipeline_report()
+*
+* Description : Prints stage throughput and queue occupancy.  A queue that sits near its size points at
+* 				a slow consumer; a stage whose busy time approaches wall time is the bottleneck.
+*
+*********************************************************************************************************
+*/
+
+void pipeline_report(void)
+{
+	INT8U i;
+
+	printf("---- PIPELINE @ %u ticks ----\n", OSTimeGet());
+
+	for (i = 0; i < num_stages; i++) {
+		printf("%-10s processed %8u  busy %8u ticks\n",
+			   stages[i]->name, stages[i]->processed, stages[i]->busy_ticks);
+	}
+
+	for (i = 0; i < num_queues; i++) {
+		printf("%-10s %2u/%2u (max %2u)  posts %8u  full %6u  drops %6u\n",
+			   queues[i]->name, pipeline_occupancy(queues[i]), queues[i]->size, queues[i]->max_occupancy,
+			   queues[i]->posts, queues[i]->full, queues[i]->drops);
+	}
+}
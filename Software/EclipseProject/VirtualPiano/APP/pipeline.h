@@ -0,0 +1,54 @@
+/*
+*********************************************************************************************************
+*
+*                                          PIPELINE HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : pipeline.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Bounded uC/OS-II message queues that link the capture, key detection, note scheduler,
+* 				  renderer/mixer and audio output tasks.  Every queue keeps post, full and drop counts
+* 				  and its occupancy high-water mark, so the stage that backs up is visible at run time.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __PIPELINE_H__
+#define __PIPELINE_H__
+
+#include  <ucos_ii.h>
+
+#define PIPELINE_MAX_QUEUES 8
+
+typedef struct {
+	OS_EVENT       *event;
+	const char     *name;
+	INT16U          size;
+	INT16U          max_occupancy;	// deepest the queue has been
+	INT32U          posts;			// messages accepted
+	INT32U          full;			// posts that found the queue full (backpressure)
+	INT32U          drops;			// messages discarded because the queue was full
+} PipelineQueue;
+
+typedef struct {
+	const char     *name;
+	INT32U          processed;		// messages handled
+	INT32U          busy_ticks;		// OS ticks spent handling them
+} PipelineStage;
+
+void pipeline_queue_create(PipelineQueue *queue, void **storage, INT16U size, const char *name);
+INT8U pipeline_post(PipelineQueue *queue, void *msg);
+void pipeline_post_blocking(PipelineQueue *queue, void *msg);
+void *pipeline_pend(PipelineQueue *queue, INT32U timeout, INT8U *err);
+void *pipeline_accept(PipelineQueue *queue);
+INT16U pipeline_occupancy(PipelineQueue *queue);
+
+void pipeline_stage_init(PipelineStage *stage, const char *name);
+void pipeline_stage_done(PipelineStage *stage, INT32U start_tick);
+
+void pipeline_report(void);
+
+#endif /* __PIPELINE_H__ */
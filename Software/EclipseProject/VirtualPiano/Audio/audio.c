@@ -220,63 +220,170 @@ INT32U read_audio_data(INT32U * buffer, INT32U len, INT32U channel) {
  *********************************************************************************************************
  *                                    write_audio_data()
  *
- * Description : Writes audio data to the Altera University IP core from a buffer
+ * Description : Writes audio data to the Altera University IP core from a buffer.  The fifospace
+ * 				 register is read once and as many words as currently fit are written in one burst.
  *
  * Arguments   : buffer	       	A buffer allocated to hold the audio data
- * 				len				The number of samples to be read
+ * 				len				The number of samples to be written
  * 				channel 		Specifies which channel
  *
- * Returns     : The number of audio samples read into the buffer
+ * Returns     : The number of audio samples written from the buffer
  *
  *********************************************************************************************************
  */
 INT32U write_audio_data(INT32U * buffer, INT32U len, INT32U channel) {
 
-	printf("write has been called\n");
-
 	INT32U fifospace;
-	INT32U count = 0;
+	INT32U num_words;
+	INT32U data_offset;
+	INT32U count;
 
-	while (count < len)
+	// determine the number of available space for words in the channel
+	fifospace = alt_read_word(AUDIO_BASE + AUDIO_FIFOSPACE_OFFSET);
+
+	if (channel == LEFT_CHANNEL)
 	{
-		// determine the number of available space for words in the channel
-		fifospace = alt_read_word(AUDIO_BASE + AUDIO_FIFOSPACE_OFFSET);
+		num_words = (fifospace & AUDIO_FIFOSPACE_WSLC_MASK) >> AUDIO_FIFOSPACE_WSLC_BIT_OFFSET;
+		data_offset = AUDIO_LEFTDATA_OFFSET;
+	}
+	else if (channel == RIGHT_CHANNEL)
+	{
+		num_words = (fifospace & AUDIO_FIFOSPACE_WSRC_MASK) >> AUDIO_FIFOSPACE_WSRC_BIT_OFFSET;
+		data_offset = AUDIO_RIGHTDATA_OFFSET;
+	}
+	else
+	{
+		return 0;
+	}
 
-		INT8U num_words;
-		if (channel == LEFT_CHANNEL)
-		{
-			num_words = (fifospace & AUDIO_FIFOSPACE_WSLC_MASK) >> AUDIO_FIFOSPACE_WSLC_BIT_OFFSET;
-		}
-		else if (channel == RIGHT_CHANNEL)
-		{
-			num_words = (fifospace & AUDIO_FIFOSPACE_WSRC_MASK) >> AUDIO_FIFOSPACE_WSRC_BIT_OFFSET;
-		}
+	if (num_words > len)
+	{
+		num_words = len;
+	}
 
-		printf("numwords: %d\n", num_words);
+	// write the burst
+	for (count = 0; count < num_words; count++)
+	{
+		alt_write_word(AUDIO_BASE + data_offset, buffer[count]);
+	}
 
-		// write word to the next available space
-		if (num_words > 0)
-		{
-			if (channel == LEFT_CHANNEL)
-			{
-				alt_write_word(AUDIO_BASE + AUDIO_LEFTDATA_OFFSET, buffer[count]);
-			}
-			else if (channel == RIGHT_CHANNEL)
-			{
-				alt_write_word(AUDIO_BASE + AUDIO_RIGHTDATA_OFFSET, buffer[count]);
-			}
-			count = count + 1;
-		}
-		else
-		{
-			break;
-		}
+	return count;
+
+}
 
+
+
+/*
+ *********************************************************************************************************
+ *                                    write_audio_frames()
+ *
+ * Description : Writes stereo frames to the Altera University IP core without waiting.  The fifospace
+ * 				 register is read once and min(space, num_frames) frames are written in one burst.
+ *
+ * Arguments   : left	       	Left channel samples
+ * 				right			Right channel samples
+ * 				num_frames		The number of frames available in left and right
+ *
+ * Returns     : The number of frames written
+ *
+ *********************************************************************************************************
+ */
+INT32U write_audio_frames(const INT32U * left, const INT32U * right, INT32U num_frames) {
+
+	INT32U fifospace;
+	INT32U left_space, right_space;
+	INT32U num_writes;
+	INT32U count;
+
+	fifospace = alt_read_word(AUDIO_BASE + AUDIO_FIFOSPACE_OFFSET);
+	left_space = (fifospace & AUDIO_FIFOSPACE_WSLC_MASK) >> AUDIO_FIFOSPACE_WSLC_BIT_OFFSET;
+	right_space = (fifospace & AUDIO_FIFOSPACE_WSRC_MASK) >> AUDIO_FIFOSPACE_WSRC_BIT_OFFSET;
+
+	num_writes = (left_space < right_space) ? left_space : right_space;
+	if (num_writes > num_frames)
+	{
+		num_writes = num_frames;
 	}
 
-	alt_write_byte(AUDIO_BASE + AUDIO_CONTROL_OFFSET, 0xC);
-	alt_write_byte(AUDIO_BASE + AUDIO_CONTROL_OFFSET, 0x0);
+	for (count = 0; count < num_writes; count++)
+	{
+		alt_write_word(AUDIO_BASE + AUDIO_LEFTDATA_OFFSET, left[count]);
+		alt_write_word(AUDIO_BASE + AUDIO_RIGHTDATA_OFFSET, right[count]);
+	}
 
 	return count;
+}
+
 
+
+/*
+ *********************************************************************************************************
+ *                                    wait_audio_write_threshold()
+ *
+ * Description : Sleeps until the outgoing FIFOs have drained down to the write interrupt threshold
+ * 				 (75% empty).  The delay is computed from the current fill level and the codec sample
+ * 				 rate, so the calling task gives up the CPU instead of polling fifospace.
+ *
+ *********************************************************************************************************
+ */
+void wait_audio_write_threshold() {
+
+	INT32U fifospace;
+	INT32U left_space, right_space, space;
+	INT32U frames_to_drain;
+	INT32U ticks;
+
+	fifospace = alt_read_word(AUDIO_BASE + AUDIO_FIFOSPACE_OFFSET);
+	left_space = (fifospace & AUDIO_FIFOSPACE_WSLC_MASK) >> AUDIO_FIFOSPACE_WSLC_BIT_OFFSET;
+	right_space = (fifospace & AUDIO_FIFOSPACE_WSRC_MASK) >> AUDIO_FIFOSPACE_WSRC_BIT_OFFSET;
+	space = (left_space < right_space) ? left_space : right_space;
+
+	if (space >= AUDIO_WRITE_THRESHOLD)
+	{
+		return;
+	}
+
+	// round up to whole OS ticks, always yielding at least one
+	frames_to_drain = AUDIO_WRITE_THRESHOLD - space;
+	ticks = (frames_to_drain * OS_TICKS_PER_SEC + AUDIO_SAMPLE_RATE - 1) / AUDIO_SAMPLE_RATE;
+	if (ticks == 0)
+	{
+		ticks = 1;
+	}
+
+	OSTimeDly(ticks);
+}
+
+
+
+/*
+ *********************************************************************************************************
+ *                                    write_audio_frames_blocking()
+ *
+ * Description : Writes all stereo frames to the Altera University IP core, sleeping until the write
+ * 				 interrupt threshold whenever the outgoing FIFOs are full.
+ *
+ * Arguments   : left	       	Left channel samples
+ * 				right			Right channel samples
+ * 				num_frames		The number of frames to write
+ *
+ * Returns     : The number of frames written (always num_frames)
+ *
+ *********************************************************************************************************
+ */
+INT32U write_audio_frames_blocking(const INT32U * left, const INT32U * right, INT32U num_frames) {
+
+	INT32U count = 0;
+
+	while (count < num_frames)
+	{
+		count += write_audio_frames(left + count, right + count, num_frames - count);
+
+		if (count < num_frames)
+		{
+			wait_audio_write_threshold();
+		}
+	}
+
+	return count;
 }
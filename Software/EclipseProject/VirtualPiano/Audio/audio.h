@@ -20,6 +20,7 @@
 #include <hps.h>
 #include <os_cpu.h>
 #include <socal.h>
+#include <ucos_ii.h>
 
 #define FPGA_TO_HPS_LW_ADDR(base)  ((void *) (((char *)  (ALT_LWFPGASLVS_ADDR))+ (base)))
 
@@ -71,6 +72,11 @@
 #define AUDIO_LEFTDATA_OFFSET 8
 #define AUDIO_RIGHTDATA_OFFSET 12
 
+// Codec output rate and FIFO geometry of the Audio core
+#define AUDIO_SAMPLE_RATE 48000
+#define AUDIO_FIFO_DEPTH 128
+#define AUDIO_WRITE_THRESHOLD ((AUDIO_FIFO_DEPTH * 3) / 4)
+
 void reset_audio_core();
 void enable_audio_read_interrupt();
 void disable_audio_read_interrupt();
@@ -80,4 +86,7 @@ INT32U is_audio_read_interrupt_pending();
 INT32U is_audio_write_interrupt_pending();
 INT32U read_audio_data(INT32U * buffer, INT32U len, INT32U channel);
 INT32U write_audio_data(INT32U * buffer, INT32U len, INT32U channel);
+INT32U write_audio_frames(const INT32U * left, const INT32U * right, INT32U num_frames);
+INT32U write_audio_frames_blocking(const INT32U * left, const INT32U * right, INT32U num_frames);
+void wait_audio_write_threshold();
 
@@ -0,0 +1,255 @@
+/*
+*********************************************************************************************************
+*
+*                                          AUDIO STREAM CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : audio_stream.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The write interrupt is level sensitive: it stays asserted while the outgoing FIFO is
+* 				  75% empty.  When the ring runs dry the ISR therefore disables it and flags the stream
+* 				  as starved; the next audio_stream_write() turns it back on.  Running dry counts as
+* 				  an underrun only while a stream is active, not once audio_stream_end() has said the
+* 				  last frames are queued.
+*
+*********************************************************************************************************
+*/
+
+#include  <lib_def.h>
+#include  <bsp_int.h>
+#include  "audio_stream.h"
+
+static AudioRing audio_ring;
+
+AudioStreamStats audio_stream_stats;
+
+/*
+ *********************************************************************************************************
+ *                                    audio_stream_init()
+ *
+ * Description : Empties the ring and the codec FIFOs, and installs the write interrupt handler.
+ * 				 The interrupt itself is enabled by the first audio_stream_write().
+ *
+ *********************************************************************************************************
+ */
+void audio_stream_init()
+{
+	disable_audio_write_interrupt();
+	reset_audio_core();
+
+	audio_ring.head = 0;
+	audio_ring.tail = 0;
+	audio_stream_reset_stats();
+	audio_stream_stats.starved = 1;
+	audio_stream_stats.active = 0;
+
+	BSP_IntVectSet(AUDIO_IRQ_ID,	// Audio core IRQ via lwhpsfpga bus
+				   AUDIO_IRQ_PRIO,	// prio
+				   DEF_BIT_00,		// cpu target list
+				   audio_write_isr	// ISR
+				   );
+
+	BSP_IntSrcEn(AUDIO_IRQ_ID);
+}
+
+
+
+/*
+ *********************************************************************************************************
+ *                                    audio_stream_reset_stats()
+ *
+ * Description : Clears the interrupt, frame and underrun counters and restarts the fill low-water mark
+ *
+ *********************************************************************************************************
+ */
+void audio_stream_reset_stats()
+{
+	audio_stream_stats.irqs = 0;
+	audio_stream_stats.frames_out = 0;
+	audio_stream_stats.underruns = 0;
+	audio_stream_stats.min_fill = AUDIO_RING_FRAMES;
+}
+
+
+
+/*
+ *********************************************************************************************************
+ *                                    audio_stream_fill()
+ *
+ * Returns     : The number of frames queued in the ring
+ *
+ *********************************************************************************************************
+ */
+INT32U audio_stream_fill()
+{
+	return audio_ring.head - audio_ring.tail;
+}
+
+
+
+/*
+ *********************************************************************************************************
+ *                                    audio_stream_write()
+ *
+ * Description : Copies as many stereo frames as fit into the ring without waiting
+ *
+ * Arguments   : left	       	Left channel samples
+ * 				right			Right channel samples
+ * 				num_frames		The number of frames available in left and right
+ *
+ * Returns     : The number of frames queued
+ *
+ *********************************************************************************************************
+ */
+INT32U audio_stream_write(const INT32U * left, const INT32U * right, INT32U num_frames)
+{
+	INT32U head = audio_ring.head;
+	INT32U space = AUDIO_RING_FRAMES - (head - audio_ring.tail);
+	INT32U count;
+
+	if (num_frames > space)
+	{
+		num_frames = space;
+	}
+
+	for (count = 0; count < num_frames; count++)
+	{
+		audio_ring.left[(head + count) & AUDIO_RING_MASK] = left[count];
+		audio_ring.right[(head + count) & AUDIO_RING_MASK] = right[count];
+	}
+
+	// publish the frames before the ISR can see the new head
+	AUDIO_RING_BARRIER();
+	audio_ring.head = head + count;
+
+	if (count > 0)
+	{
+		audio_stream_stats.active = 1;
+	}
+
+	if (count > 0 && audio_stream_stats.starved)
+	{
+		audio_stream_stats.starved = 0;
+		enable_audio_write_interrupt();
+	}
+
+	return count;
+}
+
+
+
+/*
+ *********************************************************************************************************
+ *                                    audio_stream_write_blocking()
+ *
+ * Description : Queues all stereo frames, sleeping one OS tick whenever the ring is full
+ *
+ * Arguments   : left	       	Left channel samples
+ * 				right			Right channel samples
+ * 				num_frames		The number of frames to queue
+ *
+ * Returns     : The number of frames queued (always num_frames)
+ *
+ *********************************************************************************************************
+ */
+INT32U audio_stream_write_blocking(const INT32U * left, const INT32U * right, INT32U num_frames)
+{
+	INT32U count = 0;
+
+	while (count < num_frames)
+	{
+		count += audio_stream_write(left + count, right + count, num_frames - count);
+
+		if (count < num_frames)
+		{
+			OSTimeDly(1);
+		}
+	}
+
+	return count;
+}
+
+
+
+/*
+ *********************************************************************************************************
+ *                                    audio_stream_end()
+ *
+ * Description : Marks the frames queued so far as the end of the stream, so the interrupt that finds
+ * 				 the ring empty after them parks without counting an underrun.  The next
+ * 				 audio_stream_write() starts a new stream.
+ *
+ *********************************************************************************************************
+ */
+void audio_stream_end()
+{
+	audio_stream_stats.active = 0;
+}
+
+
+
+/*
+ *********************************************************************************************************
+ *                                    audio_write_isr()
+ *
+ * Description : Write interrupt handler.  Reads fifospace once and moves min(space, ring fill)
+ * 				 frames from the ring into the codec FIFOs.
+ *
+ * Arguments   : cpu_id			CPU that took the interrupt (unused)
+ *
+ *********************************************************************************************************
+ */
+void audio_write_isr(CPU_INT32U cpu_id)
+{
+	INT32U tail = audio_ring.tail;
+	INT32U fill = audio_ring.head - tail;
+	INT32U fifospace;
+	INT32U left_space, right_space, space;
+	INT32U count;
+
+	(void)cpu_id;
+
+	audio_stream_stats.irqs++;
+
+	// An ended stream drains to empty by design, only a running one's low-water mark counts
+	if (audio_stream_stats.active && fill < audio_stream_stats.min_fill)
+	{
+		audio_stream_stats.min_fill = fill;
+	}
+
+	if (fill == 0)
+	{
+		// nothing to play, stop the level interrupt until the task queues more
+		if (audio_stream_stats.active)
+		{
+			audio_stream_stats.underruns++;
+		}
+		audio_stream_stats.starved = 1;
+		disable_audio_write_interrupt();
+		return;
+	}
+
+	fifospace = alt_read_word(AUDIO_BASE + AUDIO_FIFOSPACE_OFFSET);
+	left_space = (fifospace & AUDIO_FIFOSPACE_WSLC_MASK) >> AUDIO_FIFOSPACE_WSLC_BIT_OFFSET;
+	right_space = (fifospace & AUDIO_FIFOSPACE_WSRC_MASK) >> AUDIO_FIFOSPACE_WSRC_BIT_OFFSET;
+	space = (left_space < right_space) ? left_space : right_space;
+
+	if (space > fill)
+	{
+		space = fill;
+	}
+
+	for (count = 0; count < space; count++)
+	{
+		alt_write_word(AUDIO_BASE + AUDIO_LEFTDATA_OFFSET, audio_ring.left[(tail + count) & AUDIO_RING_MASK]);
+		alt_write_word(AUDIO_BASE + AUDIO_RIGHTDATA_OFFSET, audio_ring.right[(tail + count) & AUDIO_RING_MASK]);
+	}
+
+	// release the slots only after they have been read
+	AUDIO_RING_BARRIER();
+	audio_ring.tail = tail + count;
+	audio_stream_stats.frames_out += count;
+}
@@ -0,0 +1,68 @@
+/*
+*********************************************************************************************************
+*
+*                                          AUDIO STREAM CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : audio_stream.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Interrupt driven output for the Altera University IP "Audio" core.  A synthesis task
+* 				  pushes stereo frames into a single-producer/single-consumer ring, and the write
+* 				  interrupt (outgoing FIFO 75% empty) refills the codec FIFO from it.  The ring is lock
+* 				  free: the task only advances head, the ISR only advances tail.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __AUDIO_STREAM_H__
+#define __AUDIO_STREAM_H__
+
+#include <cpu.h>
+#include "audio.h"
+
+// NB: Set the GIC interrupt ID of the Audio core here, according to the QSYS IRQ assignment
+// (FPGA IRQ n is GIC ID 72 + n)
+#define AUDIO_IRQ_ID 78u
+#define AUDIO_IRQ_PRIO 1u
+
+// Ring capacity in stereo frames, must be a power of two
+#define AUDIO_RING_FRAMES 2048
+#define AUDIO_RING_MASK (AUDIO_RING_FRAMES - 1)
+
+// Orders the sample stores before the index store that publishes them
+#if defined(__ARMCC_VERSION)
+#define AUDIO_RING_BARRIER() __dmb(0xF)
+#else
+#define AUDIO_RING_BARRIER() __sync_synchronize()
+#endif
+
+typedef struct {
+	INT32U left[AUDIO_RING_FRAMES];
+	INT32U right[AUDIO_RING_FRAMES];
+	volatile INT32U head;			// frames pushed, written by the task only
+	volatile INT32U tail;			// frames popped, written by the ISR only
+} AudioRing;
+
+typedef struct {
+	volatile INT32U irqs;			// write interrupts serviced
+	volatile INT32U frames_out;		// frames moved from the ring to the codec
+	volatile INT32U underruns;		// interrupts that found the ring empty mid-stream
+	volatile INT32U min_fill;		// lowest ring level seen mid-stream by the ISR since the last reset
+	volatile INT32U starved;		// write interrupt disabled because the ring ran dry
+	volatile INT32U active;			// frames written since audio_stream_end(), so running dry is an underrun
+} AudioStreamStats;
+
+extern AudioStreamStats audio_stream_stats;
+
+void audio_stream_init();
+void audio_stream_reset_stats();
+INT32U audio_stream_fill();
+INT32U audio_stream_write(const INT32U * left, const INT32U * right, INT32U num_frames);
+INT32U audio_stream_write_blocking(const INT32U * left, const INT32U * right, INT32U num_frames);
+void audio_stream_end();
+void audio_write_isr(CPU_INT32U cpu_id);
+
+#endif /* __AUDIO_STREAM_H__ */
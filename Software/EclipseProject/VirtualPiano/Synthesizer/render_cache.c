@@ -0,0 +1,192 @@
+/*
+*********************************************************************************************************
+*
+*                                           RENDER CACHE CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : render_cache.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Nothing here blocks or locks.  Tasks sharing a cache must serialize their calls, and
+* 				  a slot claimed for rendering is passed over by renderCacheHit() until it is ready.
+*********************************************************************************************************
+*/
+
+#include "render_cache.h"
+
+/*
+	Name: 			void renderCacheInit(cache, buffers, num_slots, capacity)
+
+	Description: 	Empties the cache and gives each slot its buffer
+
+	Inputs:
+			short**			buffers 	num_slots buffers of capacity samples each
+			int				num_slots 	Slots to use, at most RENDER_CACHE_MAX_SLOTS
+			int				capacity 	Samples each buffer holds
+
+	Outputs:
+			RenderCache*	cache 		The cache to initialize
+*/
+void renderCacheInit(RenderCache *cache, short **buffers, int num_slots, int capacity)
+{
+	if (num_slots > RENDER_CACHE_MAX_SLOTS)
+	{
+		num_slots = RENDER_CACHE_MAX_SLOTS;
+	}
+
+	cache->num_slots = num_slots;
+	cache->renders = 0;
+	cache->render_ticks = 0;
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->wasted = 0;
+	cache->wasted_ticks = 0;
+
+	for (int i = 0; i < num_slots; i++)
+	{
+		cache->slots[i].data = buffers[i];
+		cache->slots[i].capacity = capacity;
+		cache->slots[i].size = 0;
+		cache->slots[i].key = -1;
+		cache->slots[i].state = RENDER_SLOT_EMPTY;
+		cache->slots[i].played = 0;
+		cache->slots[i].stamp = 0;
+		cache->slots[i].cost = 0;
+	}
+}
+
+/*
+	Name: 			RenderSlot *renderCacheFind(cache, key)
+
+	Description: 	Finds the slot holding or rendering a key
+
+	Inputs:
+			int				key 		Piano key, 1 to 88
+
+	Outputs:
+			RenderSlot*		return 		The slot, or 0 if the key is not cached
+*/
+RenderSlot *renderCacheFind(RenderCache *cache, int key)
+{
+	for (int i = 0; i < cache->num_slots; i++)
+	{
+		if (cache->slots[i].state != RENDER_SLOT_EMPTY && cache->slots[i].key == key)
+		{
+			return &cache->slots[i];
+		}
+	}
+
+	return 0;
+}
+
+/*
+	Name: 			RenderSlot *renderCacheClaim(cache, key, now)
+
+	Description: 	Takes a slot to render a key into: an empty one, otherwise the ready one
+					used longest ago.  An evicted render that was never played is counted as
+					wasted.
+
+	Inputs:
+			int				key 		Piano key, 1 to 88
+			unsigned int	now 		Current tick
+
+	Outputs:
+			RenderSlot*		return 		The slot, marked RENDERING, or 0 if every slot is rendering
+*/
+RenderSlot *renderCacheClaim(RenderCache *cache, int key, unsigned int now)
+{
+	RenderSlot *victim = 0;
+
+	for (int i = 0; i < cache->num_slots; i++)
+	{
+		RenderSlot *slot = &cache->slots[i];
+
+		if (slot->state == RENDER_SLOT_EMPTY)
+		{
+			victim = slot;
+			break;
+		}
+
+		if (slot->state == RENDER_SLOT_READY && (victim == 0 || now - slot->stamp > now - victim->stamp))
+		{
+			victim = slot;
+		}
+	}
+
+	if (victim == 0)
+	{
+		return 0;
+	}
+
+	if (victim->state == RENDER_SLOT_READY && !victim->played)
+	{
+		cache->wasted++;
+		cache->wasted_ticks += victim->cost;
+	}
+
+	victim->key = key;
+	victim->size = 0;
+	victim->played = 0;
+	victim->state = RENDER_SLOT_RENDERING;
+	victim->stamp = now;
+
+	return victim;
+}
+
+/*
+	Name: 			void renderCacheReady(cache, slot, size, now, cost)
+
+	Description: 	Marks a claimed slot rendered, or empty again if size is 0
+
+	Inputs:
+			RenderSlot*		slot 		Slot from renderCacheClaim
+			int				size 		Samples rendered into it
+			unsigned int	now 		Current tick
+			unsigned int	cost 		Ticks the render took
+*/
+void renderCacheReady(RenderCache *cache, RenderSlot *slot, int size, unsigned int now, unsigned int cost)
+{
+	slot->size = size;
+	slot->stamp = now;
+	slot->cost = cost;
+
+	if (size <= 0)
+	{
+		slot->state = RENDER_SLOT_EMPTY;
+		return;
+	}
+
+	cache->renders++;
+	cache->render_ticks += cost;
+	slot->state = RENDER_SLOT_READY;
+}
+
+/*
+	Name: 			const RenderSlot *renderCacheHit(cache, key, now)
+
+	Description: 	Looks up a key for a note-on, counting a hit or a miss
+
+	Inputs:
+			int				key 		Piano key, 1 to 88
+			unsigned int	now 		Current tick
+
+	Outputs:
+			RenderSlot*		return 		The rendered slot, or 0 if the note must be rendered now
+*/
+const RenderSlot *renderCacheHit(RenderCache *cache, int key, unsigned int now)
+{
+	RenderSlot *slot = renderCacheFind(cache, key);
+
+	if (slot == 0 || slot->state != RENDER_SLOT_READY)
+	{
+		cache->misses++;
+		return 0;
+	}
+
+	cache->hits++;
+	slot->played = 1;
+	slot->stamp = now;
+	return slot;
+}
@@ -0,0 +1,63 @@
+/*
+*********************************************************************************************************
+*
+*                                       RENDER CACHE HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : render_cache.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Notes rendered ahead of their note-on.  A render takes far longer than a video frame,
+* 				  so keys the tracker expects to be pressed are rendered at low priority into a slot
+* 				  here, and the note-on that follows copies the slot instead of rendering.  Slots
+* 				  are reused least recently used first; one evicted before it was ever played counts
+* 				  as wasted, with the ticks its render took.  The cache only keeps state and counts,
+* 				  the caller renders and owns the buffers.
+*********************************************************************************************************
+*/
+
+#ifndef __RENDER_CACHE_H__
+#define __RENDER_CACHE_H__
+
+#define RENDER_CACHE_MAX_SLOTS 8
+
+typedef enum {
+	RENDER_SLOT_EMPTY,
+	RENDER_SLOT_RENDERING,			// claimed, being written
+	RENDER_SLOT_READY
+} RenderSlotState;
+
+typedef struct {
+	short          *data;
+	int             capacity;		// samples data holds
+	int             size;			// samples rendered
+	int             key;
+	RenderSlotState state;
+	int             played;			// served a note-on since it was rendered
+	unsigned int    stamp;			// tick it was rendered or last played
+	unsigned int    cost;			// ticks the render took
+} RenderSlot;
+
+typedef struct {
+	RenderSlot      slots[RENDER_CACHE_MAX_SLOTS];
+	int             num_slots;
+
+	// Statistics since renderCacheInit
+	unsigned int    renders;		// speculative renders finished
+	unsigned int    render_ticks;
+	unsigned int    hits;			// note-ons served from a slot
+	unsigned int    misses;			// note-ons rendered on demand
+	unsigned int    wasted;			// renders evicted without being played
+	unsigned int    wasted_ticks;
+} RenderCache;
+
+/* Method declarations */
+void renderCacheInit(RenderCache *cache, short **buffers, int num_slots, int capacity);
+RenderSlot *renderCacheFind(RenderCache *cache, int key);
+RenderSlot *renderCacheClaim(RenderCache *cache, int key, unsigned int now);
+void renderCacheReady(RenderCache *cache, RenderSlot *slot, int size, unsigned int now, unsigned int cost);
+const RenderSlot *renderCacheHit(RenderCache *cache, int key, unsigned int now);
+
+#endif /* __RENDER_CACHE_H__ */
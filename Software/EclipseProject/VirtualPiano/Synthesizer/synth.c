@@ -0,0 +1,301 @@
+/*
+*********************************************************************************************************
+*
+*                                          SYNTH ENGINE CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : synth.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The engine never allocates; voices only point at note renders owned by the caller.
+* 				  Samples are recorded at SYNTH_SOURCE_RATE and resampled to the output rate with a
+* 				  16.16 fixed point step and linear interpolation, so a note plays at its true pitch
+* 				  whatever rate the backend runs at.
+*********************************************************************************************************
+*/
+
+#include "synth.h"
+
+/*
+	Name: 			void synthConfigDefault(config)
+
+	Description: 	Fills a configuration with the codec rate, the default block size and
+					interleaved 16-bit output
+
+	Outputs:
+			SynthConfig*	config 		The configuration to fill
+*/
+void synthConfigDefault(SynthConfig *config)
+{
+	config->sample_rate = SYNTH_DEFAULT_SAMPLE_RATE;
+	config->block_frames = SYNTH_DEFAULT_BLOCK_FRAMES;
+	config->num_voices = SYNTH_MAX_VOICES;
+	config->format = SYNTH_FORMAT_S16;
+}
+
+/*
+	Name: 			void synthInit(engine, config)
+
+	Description: 	Resets all voices and derives the resampling step and release length from
+					the configured output rate
+
+	Inputs:
+			SynthConfig*	config 		Output rate, block size and sample format
+
+	Outputs:
+			SynthEngine*	engine 		The engine to initialize
+*/
+void synthInit(SynthEngine *engine, const SynthConfig *config)
+{
+	engine->config = *config;
+
+	if (engine->config.sample_rate <= 0)
+	{
+		engine->config.sample_rate = SYNTH_DEFAULT_SAMPLE_RATE;
+	}
+
+	if (engine->config.block_frames <= 0)
+	{
+		engine->config.block_frames = SYNTH_DEFAULT_BLOCK_FRAMES;
+	}
+
+	if (engine->config.num_voices <= 0 || engine->config.num_voices > SYNTH_MAX_VOICES)
+	{
+		engine->config.num_voices = SYNTH_MAX_VOICES;
+	}
+
+	// Source samples consumed per output frame
+	engine->step = (unsigned int)(((unsigned long long)SYNTH_SOURCE_RATE << SYNTH_FRAC_BITS) / engine->config.sample_rate);
+	engine->release_frames = engine->config.sample_rate * SYNTH_RELEASE_MS / 1000;
+
+	for (int i = 0; i < SYNTH_MAX_VOICES; i++)
+	{
+		engine->voices[i].data = 0;
+		engine->voices[i].size = 0;
+		engine->voices[i].key = -1;
+		engine->voices[i].active = 0;
+		engine->voices[i].index = 0;
+		engine->voices[i].frac = 0;
+		engine->voices[i].release = -1;
+		engine->voices[i].age = 0;
+	}
+}
+
+/*
+	Name: 			int synthAllocVoice(engine)
+
+	Description: 	Picks the voice a new note should use: a free one if there is one, otherwise
+					the one that has been playing the longest. The caller renders the note into
+					that voice's buffer and then calls synthNoteOn with the same index.
+
+	Inputs:
+			SynthEngine*	engine 		The engine
+
+	Outputs:
+			int 			The voice index
+*/
+int synthAllocVoice(SynthEngine *engine)
+{
+	int voice = 0;
+
+	for (int i = 0; i < engine->config.num_voices; i++)
+	{
+		if (!engine->voices[i].active)
+		{
+			return i;
+		}
+
+		if (engine->voices[i].age > engine->voices[voice].age)
+		{
+			voice = i;
+		}
+	}
+
+	return voice;
+}
+
+/*
+	Name: 			void synthNoteOn(engine, voice, key, data, size)
+
+	Description: 	Starts a voice playing a rendered note from the beginning
+
+	Inputs:
+			int 			voice 		The voice index from synthAllocVoice
+			int 			key 		The key the note belongs to, used by synthNoteOff
+			short* 			data 		The rendered note at SYNTH_SOURCE_RATE
+			int 			size 		The number of samples in data
+
+	Outputs:
+			SynthEngine*	engine 		The engine
+*/
+void synthNoteOn(SynthEngine *engine, int voice, int key, const short *data, int size)
+{
+	SynthVoice *v;
+
+	if (voice < 0 || voice >= engine->config.num_voices || data == 0 || size < 2)
+	{
+		return;
+	}
+
+	v = &engine->voices[voice];
+	v->data = data;
+	v->size = size;
+	v->key = key;
+	v->index = 0;
+	v->frac = 0;
+	v->release = -1;
+	v->age = 0;
+	v->active = 1;
+}
+
+/*
+	Name: 			void synthNoteOff(engine, key)
+
+	Description: 	Fades out every held voice playing the key over SYNTH_RELEASE_MS instead of
+					cutting it, which would click
+
+	Inputs:
+			int 			key 		The released key
+
+	Outputs:
+			SynthEngine*	engine 		The engine
+*/
+void synthNoteOff(SynthEngine *engine, int key)
+{
+	for (int i = 0; i < SYNTH_MAX_VOICES; i++)
+	{
+		SynthVoice *v = &engine->voices[i];
+
+		if (v->active && v->key == key && v->release < 0)
+		{
+			v->release = engine->release_frames;
+		}
+	}
+}
+
+/*
+	Name: 			int synthActiveVoices(engine)
+
+	Description: 	Counts the voices still sounding
+
+	Inputs:
+			SynthEngine*	engine 		The engine
+
+	Outputs:
+			int 			The number of active voices
+*/
+int synthActiveVoices(SynthEngine *engine)
+{
+	int count = 0;
+
+	for (int i = 0; i < SYNTH_MAX_VOICES; i++)
+	{
+		count += engine->voices[i].active;
+	}
+
+	return count;
+}
+
+/*
+	Name: 			void synthRender(engine, out, num_frames)
+
+	Description: 	Mixes every active voice into num_frames interleaved stereo frames in the
+					configured format and advances the voices. Silence is written when no voice
+					is active, so a backend can call this unconditionally once per block.
+
+	Inputs:
+			SynthEngine*	engine 		The engine
+			int 			num_frames 	The number of stereo frames to produce
+
+	Outputs:
+			void* 			out 		short[2 * num_frames] or float[2 * num_frames]
+*/
+void synthRender(SynthEngine *engine, void *out, int num_frames)
+{
+	short *out_s16 = (short *)out;
+	float *out_f32 = (float *)out;
+	int release_frames = engine->release_frames > 0 ? engine->release_frames : 1;
+
+	for (int i = 0; i < SYNTH_MAX_VOICES; i++)
+	{
+		engine->voices[i].age += engine->voices[i].active;
+	}
+
+	for (int n = 0; n < num_frames; n++)
+	{
+		int mix = 0;
+
+		for (int i = 0; i < SYNTH_MAX_VOICES; i++)
+		{
+			SynthVoice *v = &engine->voices[i];
+			int s0, s1, sample;
+
+			if (!v->active)
+			{
+				continue;
+			}
+
+			// Linear interpolation between the two neighbouring source samples
+			s0 = v->data[v->index];
+			s1 = v->data[v->index + 1];
+			sample = s0 + (((s1 - s0) * (int)(v->frac >> 1)) >> (SYNTH_FRAC_BITS - 1));
+
+			if (v->release >= 0)
+			{
+				sample = sample * v->release / release_frames;
+				v->release--;
+			}
+
+			mix += sample;
+
+			v->frac += engine->step;
+			v->index += v->frac >> SYNTH_FRAC_BITS;
+			v->frac &= SYNTH_FRAC_ONE - 1;
+
+			if (v->index >= v->size - 1 || v->release == 0)
+			{
+				v->active = 0;
+				v->key = -1;
+			}
+		}
+
+		// Saturate the mix to 16 bits
+		if (mix > 32767)
+		{
+			mix = 32767;
+		}
+		else if (mix < -32768)
+		{
+			mix = -32768;
+		}
+
+		if (engine->config.format == SYNTH_FORMAT_F32)
+		{
+			out_f32[2 * n] = out_f32[2 * n + 1] = mix * (1.0f / 32768.0f);
+		}
+		else
+		{
+			out_s16[2 * n] = out_s16[2 * n + 1] = (short)mix;
+		}
+	}
+}
+
+/*
+	Name: 			void synthRenderCallback(ctx, out, num_frames)
+
+	Description: 	SynthRenderCallback adapter so backends can drive an engine without knowing
+					its type
+
+	Inputs:
+			void* 			ctx 		The SynthEngine
+			int 			num_frames 	The number of stereo frames to produce
+
+	Outputs:
+			void* 			out 		The block to fill
+*/
+void synthRenderCallback(void *ctx, void *out, int num_frames)
+{
+	synthRender((SynthEngine *)ctx, out, num_frames);
+}
@@ -0,0 +1,79 @@
+/*
+*********************************************************************************************************
+*
+*                                          SYNTH ENGINE HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : synth.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Block based playback engine for the sample based synthesizer.  piano.c renders whole
+* 				  notes; the engine keeps a set of voices pointing at those renders and produces
+* 				  fixed size blocks of interleaved stereo audio from them on demand, which is what
+* 				  an audio backend (the codec ring on the board, a WAV file on a host) asks for.
+*********************************************************************************************************
+*/
+
+#ifndef __SYNTH_H__
+#define __SYNTH_H__
+
+// Rate of the prerecorded piano samples
+#define SYNTH_SOURCE_RATE 44100
+
+#define SYNTH_MAX_VOICES 8
+#define SYNTH_DEFAULT_BLOCK_FRAMES 256
+#define SYNTH_DEFAULT_SAMPLE_RATE 48000
+
+// Note-off fade length
+#define SYNTH_RELEASE_MS 20
+
+// Position step resolution (16.16 fixed point)
+#define SYNTH_FRAC_BITS 16
+#define SYNTH_FRAC_ONE (1 << SYNTH_FRAC_BITS)
+
+typedef enum {
+	SYNTH_FORMAT_S16,		// interleaved stereo short
+	SYNTH_FORMAT_F32		// interleaved stereo float, full scale +-1.0
+} SynthFormat;
+
+typedef struct {
+	int             sample_rate;
+	int             block_frames;
+	int             num_voices;		// voices in use, at most SYNTH_MAX_VOICES
+	SynthFormat     format;
+} SynthConfig;
+
+typedef struct {
+	const short    *data;
+	int             size;
+	int             key;
+	int             active;
+	int             index;			// integer part of the read position
+	unsigned int    frac;			// fractional part of the read position
+	int             release;		// frames of fade left after note-off, -1 while held
+	unsigned int    age;			// blocks since note-on, for voice stealing
+} SynthVoice;
+
+typedef struct {
+	SynthConfig     config;
+	unsigned int    step;			// source samples per output frame, 16.16
+	int             release_frames;
+	SynthVoice      voices[SYNTH_MAX_VOICES];
+} SynthEngine;
+
+// Callback an audio backend calls for each block, out holds num_frames interleaved stereo frames
+typedef void (*SynthRenderCallback)(void *ctx, void *out, int num_frames);
+
+/* Method declarations */
+void synthConfigDefault(SynthConfig *config);
+void synthInit(SynthEngine *engine, const SynthConfig *config);
+int synthAllocVoice(SynthEngine *engine);
+void synthNoteOn(SynthEngine *engine, int voice, int key, const short *data, int size);
+void synthNoteOff(SynthEngine *engine, int key);
+int synthActiveVoices(SynthEngine *engine);
+void synthRender(SynthEngine *engine, void *out, int num_frames);
+void synthRenderCallback(void *ctx, void *out, int num_frames);
+
+#endif /* __SYNTH_H__ */
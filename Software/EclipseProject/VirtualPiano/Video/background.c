@@ -0,0 +1,47 @@
+/*
+*********************************************************************************************************
+*
+*                                             BACKGROUND CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : background.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "video_kernel.h"
+#include "background.h"
+
+/****************************************************************************************
+ * Subroutine to empty the model
+****************************************************************************************/
+void background_init(Background *background, int shift, int hot_shift, int delta)
+{
+	memset(background, 0, sizeof(*background));
+	background->shift = shift;
+	background->hot_shift = hot_shift > shift ? hot_shift : shift;
+	background->delta = delta < 0 ? 0 : (delta > 8192 ? 8192 : delta);
+}
+
+/****************************************************************************************
+ * Subroutine to learn the last level 1 window of a pyramid
+****************************************************************************************/
+void background_update(Background *background, const Pyramid *pyramid)
+{
+	// The first samples are taken whole
+	int shift = background->updates == 0 ? 0 : background->shift;
+	int hot_shift = background->updates == 0 ? 0 : background->hot_shift;
+	int cy;
+
+	for (cy = pyramid->cy0; cy < pyramid->cy1; cy++) {
+		int offset = cy * PYRAMID_WIDTH + pyramid->cx0;
+
+		video_ema_q8(background->means + offset, pyramid->level1 + offset, pyramid->cx1 - pyramid->cx0,
+					 shift, hot_shift, background->delta, background->limits + offset);
+	}
+
+	background->updates++;
+}
@@ -0,0 +1,57 @@
+/*
+*********************************************************************************************************
+*
+*                                         BACKGROUND HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : background.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Running background of the keyboard, so a lit key is found by how much brighter it is
+* 				  than usual rather than by a fixed r + g + b threshold that stops working when the
+* 				  room lighting changes.  The model is kept at pyramid level 1: per 2x2 block, the
+* 				  running mean of its brightest pixel in Q8 fixed point (r + g + b times 256).  Each
+* 				  update moves the mean a 1/2^shift step towards the sample with shifts only, in a
+* 				  vector kernel 8 blocks per step; a block that is lit now learns at 1/2^hot_shift
+* 				  so a held key is not soaked into the background within a few seconds.
+*
+* 				  Every update also sets each block's limit, (mean + delta) >> 8.  A pixel brighter
+* 				  than the limit of its block is lit, and a block is hot when its level 1 value is
+* 				  above the limit, so pyramid_build() and pyramid_refine() use the limits in place of
+* 				  their fixed threshold and lookup table and still agree exactly.  Updates are called
+* 				  on their own schedule, independent of how often frames are detected.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __BACKGROUND_H__
+#define __BACKGROUND_H__
+
+#include "pyramid.h"
+
+// 1/64 of the difference per update, 1/512 on lit blocks
+#define BACKGROUND_SHIFT_DEFAULT 6
+#define BACKGROUND_HOT_SHIFT_DEFAULT 9
+
+// How much brighter than its mean a block must be to be lit, Q8 (1.5 steps of r + g + b)
+#define BACKGROUND_DELTA_DEFAULT 384
+
+typedef struct {
+	unsigned short  means[PYRAMID_HEIGHT * PYRAMID_WIDTH];		// Q8
+	unsigned char   limits[PYRAMID_HEIGHT * PYRAMID_WIDTH];		// pixels above this are lit
+	int             shift, hot_shift;
+	int             delta;			// Q8, 0 to 8192
+
+	// Statistics since background_init
+	unsigned int    updates;
+} Background;
+
+// Empty model; the first update takes its samples as they are
+void background_init(Background *background, int shift, int hot_shift, int delta);
+
+// Learns the level 1 window of the pyramid's last build
+void background_update(Background *background, const Pyramid *pyramid);
+
+#endif /* __BACKGROUND_H__ */
@@ -0,0 +1,185 @@
+/*
+*********************************************************************************************************
+*
+*                                             BIT MASK CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : bit_mask.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "video_kernel.h"
+#include "bit_mask.h"
+
+#if defined(__GNUC__) && defined(__POPCNT__)
+#define BIT_COUNT(word) __builtin_popcount(word)
+#else
+#define BIT_COUNT(word) bit_mask_popcount(word)
+#endif
+
+// Bits x0..x1-1 of one row's words are ORed into row
+static void bit_mask_span(unsigned int *row, int x0, int x1)
+{
+	while (x0 < x1) {
+		int end = ((x0 >> 5) + 1) << 5;
+		int stop = x1 < end ? x1 : end;
+		unsigned int high = (stop & 31) ? (1u << (stop & 31)) - 1 : 0xFFFFFFFFu;
+
+		row[x0 >> 5] |= high & (0xFFFFFFFFu << (x0 & 31));
+		x0 = stop;
+	}
+}
+
+/****************************************************************************************
+ * Pack the bright pixels of a block of rows
+****************************************************************************************/
+void bit_mask_build(BitMask *mask, const unsigned char *frame, int frame_stride,
+					int first_row, int last_row, const PixelLut *lut)
+{
+	int y;
+
+	for (y = first_row; y < last_row; y++) {
+		video_bright_bits_lut(frame + y * frame_stride, VIDEO_IN_FRAME_WIDTH, lut,
+							  &mask->bits[y * BIT_MASK_ROW_WORDS]);
+	}
+}
+
+/****************************************************************************************
+ * Turn every key of a map into mask words
+****************************************************************************************/
+int bit_mask_build_keys(KeyBitMasks *keys, const KeyMap *map)
+{
+	unsigned int row[BIT_MASK_ROW_WORDS];
+	int k, s, y, w;
+
+	keys->num_words = 0;
+
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		const KeyRegion *region = &map->keys[k];
+
+		keys->first[k] = (unsigned short)keys->num_words;
+		keys->min_pixels[k] = region->min_pixels;
+
+		if (region->min_pixels == 0) {
+			continue;
+		}
+
+		// Polygon spans are in row order, so one pass picks up each row's spans
+		s = 0;
+		for (y = region->y0; y < region->y1; y++) {
+			memset(row, 0, sizeof(row));
+
+			if (region->num_spans == 0) {
+				bit_mask_span(row, region->x0, region->x1);
+			}
+			for (; s < region->num_spans && map->spans[region->first_span + s].y == y; s++) {
+				bit_mask_span(row, map->spans[region->first_span + s].x0, map->spans[region->first_span + s].x1);
+			}
+
+			for (w = 0; w < BIT_MASK_ROW_WORDS; w++) {
+				if (row[w] == 0) {
+					continue;
+				}
+
+				if (keys->num_words == BIT_MASK_MAX_KEY_WORDS) {
+					keys->num_words = 0;
+					memset(keys->first, 0, sizeof(keys->first));
+					return -1;
+				}
+
+				keys->words[keys->num_words].word = (unsigned short)(y * BIT_MASK_ROW_WORDS + w);
+				keys->words[keys->num_words].key = (unsigned short)k;
+				keys->words[keys->num_words].bits = row[w];
+				keys->num_words++;
+			}
+		}
+	}
+
+	keys->first[KEY_MAP_KEYS] = (unsigned short)keys->num_words;
+
+	return 0;
+}
+
+// Counts the bright pixels of key k and sets its bit in pressed if it reaches min_pixels
+static void score_key(const KeyBitMasks *keys, const BitMask *mask, int k,
+					  unsigned short *key_counts, unsigned int *pressed)
+{
+	const KeyMaskWord *word = &keys->words[keys->first[k]];
+	const KeyMaskWord *end = &keys->words[keys->first[k + 1]];
+	int count = 0;
+
+	// Most of a frame is dark, so an empty word skips the count
+	for (; word < end; word++) {
+		unsigned int bits = mask->bits[word->word] & word->bits;
+
+		if (bits != 0) {
+			count += BIT_COUNT(bits);
+		}
+	}
+
+	key_counts[k] = (unsigned short)count;
+
+	if (keys->min_pixels[k] != 0 && count >= keys->min_pixels[k]) {
+		pressed[k >> 5] |= 1u << (k & 31);
+	}
+}
+
+/****************************************************************************************
+ * Score every key against a mask
+****************************************************************************************/
+void bit_mask_score_keys(const KeyBitMasks *keys, const BitMask *mask,
+						 unsigned short *key_counts, unsigned int *pressed)
+{
+	int k;
+
+	memset(pressed, 0, KEY_MAP_MASK_WORDS * sizeof(unsigned int));
+
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		score_key(keys, mask, k, key_counts, pressed);
+	}
+}
+
+/****************************************************************************************
+ * Score the keys of a set against a mask
+****************************************************************************************/
+void bit_mask_score_key_set(const KeyBitMasks *keys, const BitMask *mask, const unsigned int *which,
+							unsigned short *key_counts, unsigned int *pressed)
+{
+	int w;
+
+	for (w = 0; w < KEY_MAP_MASK_WORDS; w++) {
+		unsigned int visit = which[w];
+
+		while (visit != 0) {
+			int k = (w << 5) + BIT_MASK_CTZ(visit);
+
+			visit &= visit - 1;
+			pressed[w] &= ~(1u << (k & 31));
+			score_key(keys, mask, k, key_counts, pressed);
+		}
+	}
+}
+
+/****************************************************************************************
+ * Count set bits
+****************************************************************************************/
+int bit_mask_popcount(unsigned int word)
+{
+	word = word - ((word >> 1) & 0x55555555u);
+	word = (word & 0x33333333u) + ((word >> 2) & 0x33333333u);
+	word = (word + (word >> 4)) & 0x0F0F0F0Fu;
+
+	return (int)((word * 0x01010101u) >> 24);
+}
+
+/****************************************************************************************
+ * Count trailing zero bits, word must not be 0
+****************************************************************************************/
+int bit_mask_ctz(unsigned int word)
+{
+	return bit_mask_popcount((word & (0u - word)) - 1);
+}
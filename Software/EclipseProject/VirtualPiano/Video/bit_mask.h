@@ -0,0 +1,81 @@
+/*
+*********************************************************************************************************
+*
+*                                          BIT MASK HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : bit_mask.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The bright pixels of a video-in frame packed one bit per pixel, 320x240 in 9600 bytes
+* 				  instead of the 76800 of a byte mask.  Each key of a KeyMap is turned once into the
+* 				  list of mask words it covers with the bits of its pixels set, so scoring a key is an
+* 				  AND and a popcount per word: a key 4 pixels wide over 100 rows is about 150 words,
+* 				  all 88 keys a little over 10000.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __BIT_MASK_H__
+#define __BIT_MASK_H__
+
+#include "pixel_lut.h"
+#include "key_map.h"
+
+// Words per row and per frame, pixel (x, y) is bit x & 31 of word y * BIT_MASK_ROW_WORDS + (x >> 5)
+#define BIT_MASK_ROW_WORDS ((VIDEO_IN_FRAME_WIDTH + 31) / 32)
+#define BIT_MASK_WORDS (BIT_MASK_ROW_WORDS * VIDEO_IN_FRAME_HEIGHT)
+
+// Room for every key to straddle a word boundary on every row
+#define BIT_MASK_MAX_KEY_WORDS (KEY_MAP_KEYS * VIDEO_IN_FRAME_HEIGHT * 2)
+
+// Count trailing zeros, word must not be 0
+#if defined(__GNUC__)
+#define BIT_MASK_CTZ(word) __builtin_ctz(word)
+#else
+#define BIT_MASK_CTZ(word) bit_mask_ctz(word)
+#endif
+
+#define BIT_MASK_TEST(mask, x, y) (((mask)->bits[(y) * BIT_MASK_ROW_WORDS + ((x) >> 5)] >> ((x) & 31)) & 1)
+
+typedef struct {
+	unsigned int    bits[BIT_MASK_WORDS];
+} BitMask;
+
+// One mask word of a key
+typedef struct {
+	unsigned short  word;			// index into BitMask.bits
+	unsigned short  key;
+	unsigned int    bits;			// pixels of the key in that word
+} KeyMaskWord;
+
+typedef struct {
+	KeyMaskWord     words[BIT_MASK_MAX_KEY_WORDS];
+	int             num_words;
+	unsigned short  first[KEY_MAP_KEYS + 1];	// key k's words are words[first[k]..first[k + 1]-1]
+	unsigned short  min_pixels[KEY_MAP_KEYS];	// copied from the map, 0 disables the key
+} KeyBitMasks;
+
+// Packs the bright test of rows first_row..last_row-1, other rows are left as they were
+void bit_mask_build(BitMask *mask, const unsigned char *frame, int frame_stride,
+					int first_row, int last_row, const PixelLut *lut);
+
+// Builds the word lists of every key in the map, returns 0 on success or -1 if they don't fit
+int bit_mask_build_keys(KeyBitMasks *keys, const KeyMap *map);
+
+// Counts the bright pixels in every key and sets bit key in pressed for each key reaching its min_pixels
+void bit_mask_score_keys(const KeyBitMasks *keys, const BitMask *mask,
+						 unsigned short *key_counts, unsigned int *pressed);
+
+// bit_mask_score_keys() for the keys whose bit is set in which, other keys keep their counts and bits
+void bit_mask_score_key_set(const KeyBitMasks *keys, const BitMask *mask, const unsigned int *which,
+							unsigned short *key_counts, unsigned int *pressed);
+
+// Portable bit counts.  Neither the Cortex-A9 nor baseline x86 has a popcount instruction, where
+// GCC's builtin is a library call that is slower than this.
+int bit_mask_popcount(unsigned int word);
+int bit_mask_ctz(unsigned int word);
+
+#endif /* __BIT_MASK_H__ */
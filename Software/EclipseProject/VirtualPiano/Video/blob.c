@@ -0,0 +1,228 @@
+/*
+*********************************************************************************************************
+*
+*                                          BLOB LABELLING CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : blob.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "blob.h"
+
+// Root of a run's component, halving the path on the way
+static int blob_find(BlobLabeller *labeller, int run)
+{
+	while (labeller->parent[run] != run) {
+		labeller->parent[run] = labeller->parent[labeller->parent[run]];
+		run = labeller->parent[run];
+	}
+
+	return run;
+}
+
+// Joins two components, the older root survives and takes the other's statistics
+static void blob_union(BlobLabeller *labeller, int a, int b)
+{
+	BlobStats *keep, *gone;
+
+	a = blob_find(labeller, a);
+	b = blob_find(labeller, b);
+
+	if (a == b) {
+		return;
+	}
+
+	if (b < a) {
+		int t = a;
+		a = b;
+		b = t;
+	}
+
+	labeller->parent[b] = (unsigned short)a;
+
+	keep = &labeller->stats[a];
+	gone = &labeller->stats[b];
+	keep->area += gone->area;
+	keep->sum_x += gone->sum_x;
+	keep->sum_y += gone->sum_y;
+	keep->x0 = gone->x0 < keep->x0 ? gone->x0 : keep->x0;
+	keep->y0 = gone->y0 < keep->y0 ? gone->y0 : keep->y0;
+	keep->x1 = gone->x1 > keep->x1 ? gone->x1 : keep->x1;
+	keep->y1 = gone->y1 > keep->y1 ? gone->y1 : keep->y1;
+}
+
+// Adds a blob to the output, keeping the largest BLOB_MAX_BLOBS sorted by area
+static void blob_report(BlobLabeller *labeller, const BlobStats *stats)
+{
+	int i = labeller->num_blobs;
+
+	if (i == BLOB_MAX_BLOBS) {
+		labeller->blobs_dropped++;
+
+		if (stats->area <= labeller->blobs[BLOB_MAX_BLOBS - 1].area) {
+			return;
+		}
+		i--;
+	}
+	else {
+		labeller->num_blobs++;
+	}
+
+	while (i > 0 && labeller->blobs[i - 1].area < stats->area) {
+		labeller->blobs[i] = labeller->blobs[i - 1];
+		i--;
+	}
+
+	labeller->blobs[i].area = stats->area;
+	labeller->blobs[i].cx = (float)stats->sum_x / stats->area;
+	labeller->blobs[i].cy = (float)stats->sum_y / stats->area;
+	labeller->blobs[i].x0 = stats->x0;
+	labeller->blobs[i].y0 = stats->y0;
+	labeller->blobs[i].x1 = stats->x1;
+	labeller->blobs[i].y1 = stats->y1;
+}
+
+/****************************************************************************************
+ * Set up a labeller
+****************************************************************************************/
+void blob_init(BlobLabeller *labeller, unsigned int min_area)
+{
+	labeller->num_runs = 0;
+	labeller->num_blobs = 0;
+	labeller->min_area = min_area;
+	labeller->runs_dropped = 0;
+	labeller->blobs_dropped = 0;
+}
+
+// Starts a component for run x0..x1-1 of row y and joins it to the runs it touches in the row above,
+// *above is the first run above that may still touch and moves right as runs are added
+static void blob_add_run(BlobLabeller *labeller, int x0, int x1, int y, int *above, int above_end)
+{
+	int run, i;
+
+	if (labeller->num_runs == BLOB_MAX_RUNS) {
+		labeller->runs_dropped++;
+		return;
+	}
+
+	run = labeller->num_runs++;
+	labeller->runs[run].x0 = (short)x0;
+	labeller->runs[run].x1 = (short)x1;
+	labeller->runs[run].y = (short)y;
+	labeller->parent[run] = (unsigned short)run;
+	labeller->stats[run].area = (unsigned int)(x1 - x0);
+	labeller->stats[run].sum_x = (unsigned int)((x0 + x1 - 1) * (x1 - x0) / 2);
+	labeller->stats[run].sum_y = (unsigned int)(y * (x1 - x0));
+	labeller->stats[run].x0 = (short)x0;
+	labeller->stats[run].x1 = (short)x1;
+	labeller->stats[run].y0 = (short)y;
+	labeller->stats[run].y1 = (short)(y + 1);
+
+	// Runs above that end before this one starts (diagonals included) can't touch it
+	while (*above < above_end && labeller->runs[*above].x1 < x0) {
+		(*above)++;
+	}
+
+	// Join every run above that overlaps, the last one may touch the next run too
+	for (i = *above; i < above_end && labeller->runs[i].x0 <= x1; i++) {
+		blob_union(labeller, run, i);
+	}
+}
+
+/****************************************************************************************
+ * Label the bright pixels of a window of a bit mask
+****************************************************************************************/
+int blob_label(BlobLabeller *labeller, const BitMask *mask, int x0, int y0, int x1, int y1)
+{
+	int above_first = 0, above_end = 0;
+	int first_word = x0 >> 5;
+	int last_word = (x1 - 1) >> 5;
+	unsigned int first_bits = 0xFFFFFFFFu << (x0 & 31);
+	unsigned int last_bits = (x1 & 31) ? (1u << (x1 & 31)) - 1 : 0xFFFFFFFFu;
+	int y, w, i;
+
+	labeller->num_runs = 0;
+	labeller->num_blobs = 0;
+
+	if (x1 <= x0 || x0 < 0 || x1 > VIDEO_IN_FRAME_WIDTH) {
+		return 0;
+	}
+
+	for (y = y0; y < y1; y++) {
+		const unsigned int *row = &mask->bits[y * BIT_MASK_ROW_WORDS];
+		int row_first = labeller->num_runs;
+		int above = above_first;
+		int start = -1;
+
+		for (w = first_word; w <= last_word; w++) {
+			unsigned int word = row[w];
+			int bit = 0;
+
+			if (w == first_word) {
+				word &= first_bits;
+			}
+			if (w == last_word) {
+				word &= last_bits;
+			}
+
+			// Alternate between the next set bit (run start) and the next clear bit (run end)
+			while (bit < 32) {
+				unsigned int rest = word >> bit;
+
+				if (start < 0) {
+					if (rest == 0) {
+						break;
+					}
+					bit += BIT_MASK_CTZ(rest);
+					start = (w << 5) + bit;
+				}
+				else {
+					if (rest == 0xFFFFFFFFu >> bit) {
+						break;			// run goes on into the next word
+					}
+					bit += BIT_MASK_CTZ(~rest);
+					blob_add_run(labeller, start, (w << 5) + bit, y, &above, above_end);
+					start = -1;
+				}
+			}
+		}
+
+		if (start >= 0) {
+			blob_add_run(labeller, start, x1, y, &above, above_end);
+		}
+
+		above_first = row_first;
+		above_end = labeller->num_runs;
+	}
+
+	for (i = 0; i < labeller->num_runs; i++) {
+		if (labeller->parent[i] == i && labeller->stats[i].area >= labeller->min_area) {
+			blob_report(labeller, &labeller->stats[i]);
+		}
+	}
+
+	return labeller->num_blobs;
+}
+
+/****************************************************************************************
+ * Attribute blobs to keys by centroid
+****************************************************************************************/
+void blob_keys(const BlobLabeller *labeller, const unsigned char *labels, unsigned int *mask)
+{
+	int i;
+
+	memset(mask, 0, KEY_MAP_MASK_WORDS * sizeof(unsigned int));
+
+	for (i = 0; i < labeller->num_blobs; i++) {
+		int key = labels[(int)labeller->blobs[i].cy * VIDEO_IN_FRAME_WIDTH + (int)labeller->blobs[i].cx];
+
+		if (key != KEY_MAP_NO_KEY) {
+			mask[key >> 5] |= 1u << (key & 31);
+		}
+	}
+}
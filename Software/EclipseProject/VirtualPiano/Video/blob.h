@@ -0,0 +1,79 @@
+/*
+*********************************************************************************************************
+*
+*                                         BLOB LABELLING HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : blob.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Connected-component labelling of the bright pixels in a video-in frame, so two
+* 				  fingers or LEDs on neighbouring keys come out as two blobs instead of one pixel
+* 				  count.  The frame's bit mask is scanned once.  Each row is reduced to runs of set
+* 				  bits, found a word at a time with count-trailing-zeros, each run is joined
+* 				  (8-connected) to the runs it touches in the row above with union-find, and the area,
+* 				  coordinate sums and bounding box are merged into the root as runs join, so no second
+* 				  pass over the pixels or the labels is needed.  Everything lives in fixed size arrays;
+* 				  runs past BLOB_MAX_RUNS are dropped and counted.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __BLOB_H__
+#define __BLOB_H__
+
+#include "key_map.h"
+#include "bit_mask.h"
+
+// Runs in one frame
+#define BLOB_MAX_RUNS 4096
+
+// Blobs reported, the largest are kept
+#define BLOB_MAX_BLOBS 32
+
+typedef struct {
+	unsigned int    area;
+	float           cx, cy;			// centroid
+	short           x0, y0;			// bounding box, x1 and y1 exclusive
+	short           x1, y1;
+} Blob;
+
+typedef struct {
+	short           x0, x1;			// x1 exclusive
+	short           y;
+} BlobRun;
+
+// Statistics of the component rooted at a run
+typedef struct {
+	unsigned int    area;
+	unsigned int    sum_x, sum_y;
+	short           x0, y0;
+	short           x1, y1;
+} BlobStats;
+
+typedef struct {
+	BlobRun         runs[BLOB_MAX_RUNS];
+	unsigned short  parent[BLOB_MAX_RUNS];
+	BlobStats       stats[BLOB_MAX_RUNS];
+	int             num_runs;
+	unsigned int    min_area;		// smaller blobs are not reported
+
+	Blob            blobs[BLOB_MAX_BLOBS];	// largest first
+	int             num_blobs;
+
+	// Statistics since blob_init
+	unsigned int    runs_dropped;
+	unsigned int    blobs_dropped;
+} BlobLabeller;
+
+void blob_init(BlobLabeller *labeller, unsigned int min_area);
+
+// Labels the set pixels of columns x0..x1-1 and rows y0..y1-1 of the mask, returns the number of blobs
+int blob_label(BlobLabeller *labeller, const BitMask *mask, int x0, int y0, int x1, int y1);
+
+// Sets the bit of the key under each blob's centroid, looked up in a key_map_build_labels() table
+void blob_keys(const BlobLabeller *labeller, const unsigned char *labels, unsigned int *mask);
+
+#endif /* __BLOB_H__ */
@@ -0,0 +1,148 @@
+/*
+*********************************************************************************************************
+*
+*                                         DIRTY RECTANGLE CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : dirty_rect.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "dirty_rect.h"
+
+#define RECT_AREA(r) ((int)((r)->x1 - (r)->x0) * ((r)->y1 - (r)->y0))
+
+// Bounding box of two rectangles
+static DirtyRect dirty_rect_union(const DirtyRect *a, const DirtyRect *b)
+{
+	DirtyRect u;
+
+	u.x0 = a->x0 < b->x0 ? a->x0 : b->x0;
+	u.y0 = a->y0 < b->y0 ? a->y0 : b->y0;
+	u.x1 = a->x1 > b->x1 ? a->x1 : b->x1;
+	u.y1 = a->y1 > b->y1 ? a->y1 : b->y1;
+	return u;
+}
+
+// Pixels the bounding box covers outside both rectangles
+static int dirty_rect_waste(const DirtyRect *a, const DirtyRect *b)
+{
+	DirtyRect u = dirty_rect_union(a, b);
+	int ox = (a->x1 < b->x1 ? a->x1 : b->x1) - (a->x0 > b->x0 ? a->x0 : b->x0);
+	int oy = (a->y1 < b->y1 ? a->y1 : b->y1) - (a->y0 > b->y0 ? a->y0 : b->y0);
+	int overlap = ox > 0 && oy > 0 ? ox * oy : 0;
+
+	return RECT_AREA(&u) - (RECT_AREA(a) + RECT_AREA(b) - overlap);
+}
+
+/****************************************************************************************
+ * Start with no regions
+****************************************************************************************/
+void dirty_rect_init(DirtyRects *dirty, int width, int height)
+{
+	dirty->count = 0;
+	dirty->width = (short)width;
+	dirty->height = (short)height;
+	dirty->flushes = 0;
+	dirty->bytes_flushed = 0;
+}
+
+/****************************************************************************************
+ * Add a drawn region
+****************************************************************************************/
+void dirty_rect_add(DirtyRects *dirty, int x0, int y0, int x1, int y1)
+{
+	DirtyRect rect;
+	int i, merged;
+
+	x0 = x0 < 0 ? 0 : x0;
+	y0 = y0 < 0 ? 0 : y0;
+	x1 = x1 > dirty->width ? dirty->width : x1;
+	y1 = y1 > dirty->height ? dirty->height : y1;
+
+	if (x0 >= x1 || y0 >= y1) {
+		return;
+	}
+
+	rect.x0 = (short)x0;
+	rect.y0 = (short)y0;
+	rect.x1 = (short)x1;
+	rect.y1 = (short)y1;
+
+	// Absorb every rectangle close enough, the grown rectangle may reach others
+	do {
+		merged = 0;
+
+		for (i = 0; i < dirty->count; i++) {
+			if (dirty_rect_waste(&rect, &dirty->rects[i]) <= DIRTY_RECT_MERGE_SLACK) {
+				rect = dirty_rect_union(&rect, &dirty->rects[i]);
+				dirty->rects[i] = dirty->rects[--dirty->count];
+				merged = 1;
+				break;
+			}
+		}
+	} while (merged);
+
+	if (dirty->count < DIRTY_RECT_MAX) {
+		dirty->rects[dirty->count++] = rect;
+		return;
+	}
+
+	// Full, grow the rectangle that grows least
+	{
+		int best = 0, best_growth = 0;
+
+		for (i = 0; i < DIRTY_RECT_MAX; i++) {
+			DirtyRect u = dirty_rect_union(&rect, &dirty->rects[i]);
+			int growth = RECT_AREA(&u) - RECT_AREA(&dirty->rects[i]);
+
+			if (i == 0 || growth < best_growth) {
+				best = i;
+				best_growth = growth;
+			}
+		}
+
+		dirty->rects[best] = dirty_rect_union(&rect, &dirty->rects[best]);
+	}
+}
+
+/****************************************************************************************
+ * Area covered
+****************************************************************************************/
+unsigned int dirty_rect_area(const DirtyRects *dirty)
+{
+	unsigned int area = 0;
+	int i;
+
+	for (i = 0; i < dirty->count; i++) {
+		area += (unsigned int)RECT_AREA(&dirty->rects[i]);
+	}
+
+	return area;
+}
+
+/****************************************************************************************
+ * Copy the regions between screens
+****************************************************************************************/
+void dirty_rect_flush(DirtyRects *dirty, unsigned char *dst, const unsigned char *src, int stride)
+{
+	int i, y;
+
+	for (i = 0; i < dirty->count; i++) {
+		const DirtyRect *rect = &dirty->rects[i];
+		int width = rect->x1 - rect->x0;
+
+		for (y = rect->y0; y < rect->y1; y++) {
+			memcpy(dst + y * stride + rect->x0, src + y * stride + rect->x0, width);
+		}
+
+		dirty->bytes_flushed += (unsigned long)width * (rect->y1 - rect->y0);
+	}
+
+	dirty->count = 0;
+	dirty->flushes++;
+}
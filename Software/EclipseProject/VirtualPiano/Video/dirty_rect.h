@@ -0,0 +1,57 @@
+/*
+*********************************************************************************************************
+*
+*                                       DIRTY RECTANGLE HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : dirty_rect.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Collects the screen regions drawn since the last flush, merging rectangles that
+* 				  overlap or sit close enough that one box wastes no more than DIRTY_RECT_MERGE_SLACK
+* 				  pixels, and copies just those regions between screens one memcpy per row.  With
+* 				  double buffering the regions drawn into the back buffer are flushed from it into the
+* 				  other buffer before that one is drawn next, so each frame moves only what changed.
+* 				  When the list is full the new region joins whichever rectangle grows least.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __DIRTY_RECT_H__
+#define __DIRTY_RECT_H__
+
+#define DIRTY_RECT_MAX 16
+
+// Pixels a merged box may cover beyond its two rectangles
+#define DIRTY_RECT_MERGE_SLACK 256
+
+// x1 and y1 exclusive
+typedef struct {
+	short           x0, y0;
+	short           x1, y1;
+} DirtyRect;
+
+typedef struct {
+	DirtyRect       rects[DIRTY_RECT_MAX];
+	int             count;
+	short           width, height;	// regions are clipped to the screen
+
+	// Statistics
+	unsigned int    flushes;
+	unsigned long   bytes_flushed;
+} DirtyRects;
+
+void dirty_rect_init(DirtyRects *dirty, int width, int height);
+
+// Marks x0..x1-1, y0..y1-1 as drawn
+void dirty_rect_add(DirtyRects *dirty, int x0, int y0, int x1, int y1);
+
+// Pixels covered by the rectangles
+unsigned int dirty_rect_area(const DirtyRects *dirty);
+
+// Copies every rectangle from src to dst, both with rows stride bytes apart, and empties the list
+void dirty_rect_flush(DirtyRects *dirty, unsigned char *dst, const unsigned char *src, int stride);
+
+#endif /* __DIRTY_RECT_H__ */
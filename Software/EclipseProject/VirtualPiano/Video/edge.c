@@ -0,0 +1,65 @@
+/*
+*********************************************************************************************************
+*
+*                                               EDGE CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : edge.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "video_kernel.h"
+#include "edge.h"
+
+/****************************************************************************************
+ * Subroutine to empty the row window
+****************************************************************************************/
+void edge_filter_init(EdgeFilter *edge)
+{
+	memset(edge, 0, sizeof(*edge));
+}
+
+/****************************************************************************************
+ * Subroutine to find the edges of a window of rows
+****************************************************************************************/
+void edge_filter_frame(EdgeFilter *edge, const unsigned char *frame, int frame_stride,
+					   unsigned char *out, int out_stride, int y0, int y1)
+{
+	int y;
+
+	if (y0 < 0) {
+		y0 = 0;
+	}
+	if (y1 > VIDEO_IN_FRAME_HEIGHT) {
+		y1 = VIDEO_IN_FRAME_HEIGHT;
+	}
+	if (y0 >= y1) {
+		return;
+	}
+
+	// Prime the window with the row above the first and the first
+	for (y = y0 > 0 ? y0 - 1 : 0; y <= y0; y++) {
+		video_grey(frame + y * frame_stride, VIDEO_IN_FRAME_WIDTH, edge->grey[y % 3]);
+	}
+
+	for (y = y0; y < y1; y++) {
+		if (y + 1 < VIDEO_IN_FRAME_HEIGHT) {
+			video_grey(frame + (y + 1) * frame_stride, VIDEO_IN_FRAME_WIDTH, edge->grey[(y + 1) % 3]);
+		}
+
+		if (y == 0 || y == VIDEO_IN_FRAME_HEIGHT - 1) {
+			memset(out + y * out_stride, 0, VIDEO_IN_FRAME_WIDTH);
+		}
+		else {
+			video_sobel(edge->grey[(y - 1) % 3], edge->grey[y % 3], edge->grey[(y + 1) % 3],
+						VIDEO_IN_FRAME_WIDTH, out + y * out_stride);
+		}
+	}
+
+	edge->rows += y1 - y0;
+	edge->frames++;
+}
@@ -0,0 +1,49 @@
+/*
+*********************************************************************************************************
+*
+*                                            EDGE HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : edge.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Software edges in the format of the Video-In core's edge mode (EDGE_ON written at
+* 				  EDGE_OFFSET), so the detector can be run on edges without the FPGA and on a host.
+* 				  In edge mode the core streams an 8-bit edge strength per pixel, which reaches the
+* 				  DMA buffer as a grey RGB332 pixel: the strength's top three bits in r and g, its top
+* 				  two in b.  edge_filter_frame() writes the same pixels into a frame with the same
+* 				  row layout.  The strength is the 3x3 Sobel |gx| + |gy| of the frame's luma,
+* 				  saturated at 255; the core's own filtering ahead of its Sobel stage is not modelled,
+* 				  so strengths near an edge can differ from the hardware's, never the format.
+*
+* 				  Each row is converted to grey once and kept in a three row window, so a frame costs
+* 				  one grey conversion and one Sobel pass per row, both vector kernels.  The top and
+* 				  bottom frame rows have no neighbours and are written as 0, like out[0] and
+* 				  out[count - 1] of every row.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __EDGE_H__
+#define __EDGE_H__
+
+#include "video.h"
+
+typedef struct {
+	unsigned char   grey[3][VIDEO_IN_FRAME_WIDTH];		// rows y - 1, y and y + 1, by y % 3
+
+	// Statistics since edge_filter_init
+	unsigned int    frames;
+	unsigned int    rows;
+} EdgeFilter;
+
+// Empty window
+void edge_filter_init(EdgeFilter *edge);
+
+// Writes the edges of rows y0 to y1 - 1 of an RGB332 frame to the same rows of out
+void edge_filter_frame(EdgeFilter *edge, const unsigned char *frame, int frame_stride,
+					   unsigned char *out, int out_stride, int y0, int y1);
+
+#endif /* __EDGE_H__ */
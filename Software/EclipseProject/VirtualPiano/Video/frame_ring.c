@@ -0,0 +1,112 @@
+/*
+*********************************************************************************************************
+*
+*                                            FRAME RING CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : frame_ring.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "frame_ring.h"
+
+/****************************************************************************************
+ * Subroutine to empty the ring
+****************************************************************************************/
+void frame_ring_init(FrameRing *ring, unsigned char **buffers, int size, FrameRingPolicy policy)
+{
+	int i;
+
+	memset(ring, 0, sizeof(*ring));
+
+	size = size > FRAME_RING_MAX_FRAMES ? FRAME_RING_MAX_FRAMES : size;
+	for (i = 0; i < size; i++) {
+		ring->slots[i].data = buffers[i];
+	}
+
+	ring->size = size;
+	ring->policy = policy;
+}
+
+/****************************************************************************************
+ * Subroutine to find the producer a slot for the next frame
+****************************************************************************************/
+FrameRingSlot *frame_ring_fill_begin(FrameRing *ring)
+{
+	unsigned int fill = ring->fill;
+
+	ring->replacing = 0;
+
+	if (fill - ring->consume < (unsigned int)ring->size) {
+		return &ring->slots[fill % ring->size];
+	}
+
+	if (ring->policy == FRAME_RING_KEEP_OLDEST) {
+		ring->dropped++;
+		return NULL;
+	}
+
+	// Full: the newest waiting frame is never the held one with two slots or more
+	ring->replacing = 1;
+	ring->replaced++;
+	return &ring->slots[(fill - 1) % ring->size];
+}
+
+/****************************************************************************************
+ * Subroutine to publish a filled slot
+****************************************************************************************/
+void frame_ring_fill_end(FrameRing *ring, FrameRingSlot *slot, unsigned int seq, unsigned int stamp)
+{
+	slot->seq = seq;
+	slot->stamp = stamp;
+	ring->filled++;
+
+	if (!ring->replacing) {
+		FRAME_RING_BARRIER();
+		ring->fill = ring->fill + 1;
+	}
+}
+
+/****************************************************************************************
+ * Subroutine to take the consumer's next frame
+****************************************************************************************/
+const FrameRingSlot *frame_ring_acquire(FrameRing *ring, unsigned int now)
+{
+	unsigned int fill = ring->fill;
+	unsigned int consume = ring->consume;
+	const FrameRingSlot *slot;
+
+	if (consume == fill) {
+		return NULL;
+	}
+
+	// Pass over all but the newest, publishing which slot is held before reading it
+	if (ring->policy == FRAME_RING_NEWEST_WINS && fill - consume > 1) {
+		ring->skipped += fill - 1 - consume;
+		ring->consume = fill - 1;
+		consume = fill - 1;
+	}
+	FRAME_RING_BARRIER();
+
+	slot = &ring->slots[consume % ring->size];
+	if (now - slot->stamp > ring->max_age) {
+		ring->max_age = now - slot->stamp;
+	}
+	ring->taken++;
+
+	return slot;
+}
+
+/****************************************************************************************
+ * Subroutine to hand the held slot back
+****************************************************************************************/
+void frame_ring_release(FrameRing *ring)
+{
+	// Finish with the frame before the producer can see the slot free
+	FRAME_RING_BARRIER();
+	ring->consume = ring->consume + 1;
+}
@@ -0,0 +1,89 @@
+/*
+*********************************************************************************************************
+*
+*                                       FRAME RING HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : frame_ring.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : A ring of captured frame buffers between capture, which copies each completed frame out
+* 				  of the video-in buffer, and detection, which works on the copies.  Capture fills slot
+* 				  fill % size and advances fill, detection holds slot consume % size while it works and
+* 				  advances consume when done, so capture of the next frame overlaps processing of this
+* 				  one and neither waits on the other.  Each frame carries the controller's sequence
+* 				  number and the tick it completed, so a gap in the numbers is a frame lost somewhere
+* 				  and the tick gives its age when detection gets to it.
+*
+* 				  With FRAME_RING_KEEP_OLDEST frames are processed in order and a frame finding the
+* 				  ring full is dropped.  With FRAME_RING_NEWEST_WINS detection always takes the newest
+* 				  frame, skipping any older ones, and a frame finding the ring full replaces the
+* 				  newest waiting one, for the least latency.
+*
+* 				  As with the key event ring, each index is written by one side only and nothing
+* 				  locks.  A replaced frame is rewritten in place, which is safe because the producer
+* 				  outranks the consumer on one core: the consumer can be preempted anywhere, but once
+* 				  it has published the slot it holds the producer leaves that slot alone, and a
+* 				  rewrite that preempts it runs to completion before it looks at the slot.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __FRAME_RING_H__
+#define __FRAME_RING_H__
+
+#define FRAME_RING_MAX_FRAMES 8
+
+// Orders the frame and slot stores before the index store that publishes them
+#if defined(__ARMCC_VERSION)
+#define FRAME_RING_BARRIER() __dmb(0xF)
+#else
+#define FRAME_RING_BARRIER() __sync_synchronize()
+#endif
+
+typedef enum {
+	FRAME_RING_KEEP_OLDEST,			// in order, new frames dropped when full
+	FRAME_RING_NEWEST_WINS			// newest first, older frames skipped or replaced
+} FrameRingPolicy;
+
+typedef struct {
+	unsigned char  *data;			// frame buffer, video-in row layout
+	unsigned int    seq;			// controller frame number
+	unsigned int    stamp;			// tick it completed
+} FrameRingSlot;
+
+typedef struct {
+	FrameRingSlot   slots[FRAME_RING_MAX_FRAMES];
+	int             size;
+	FrameRingPolicy policy;
+	volatile unsigned int fill;		// frames filled, written by the producer only
+	volatile unsigned int consume;	// frames consumed or skipped, written by the consumer only
+	int             replacing;		// the slot being filled replaces the newest waiting frame
+
+	// Statistics, each written by one side
+	unsigned int    filled;			// producer: frames copied in
+	unsigned int    dropped;		// producer: frames that found the ring full
+	unsigned int    replaced;		// producer: waiting frames replaced by a newer one
+	unsigned int    taken;			// consumer: frames processed
+	unsigned int    skipped;		// consumer: frames passed over for a newer one
+	unsigned int    max_age;		// consumer: most ticks from completion to being taken
+} FrameRing;
+
+// Empties the ring and gives it size buffers, 2 to FRAME_RING_MAX_FRAMES
+void frame_ring_init(FrameRing *ring, unsigned char **buffers, int size, FrameRingPolicy policy);
+
+// Producer: the slot to copy the next frame into, or NULL if it is to be dropped
+FrameRingSlot *frame_ring_fill_begin(FrameRing *ring);
+
+// Producer: publishes the slot from frame_ring_fill_begin() with its frame number and tick
+void frame_ring_fill_end(FrameRing *ring, FrameRingSlot *slot, unsigned int seq, unsigned int stamp);
+
+// Consumer: the next frame by the policy, held until frame_ring_release(), or NULL if none waits
+const FrameRingSlot *frame_ring_acquire(FrameRing *ring, unsigned int now);
+
+// Consumer: hands the held slot back to the producer
+void frame_ring_release(FrameRing *ring);
+
+#endif /* __FRAME_RING_H__ */
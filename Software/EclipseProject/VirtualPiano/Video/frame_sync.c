@@ -0,0 +1,91 @@
+/*
+*********************************************************************************************************
+*
+*                                       VIDEO-IN FRAME SYNC CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : frame_sync.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include "frame_sync.h"
+
+/****************************************************************************************
+ * Subroutine to start watching the controller for completed frames
+****************************************************************************************/
+void frame_sync_init(FrameSync *sync, void *base, unsigned int period, unsigned int late_ticks)
+{
+	sync->base = base;
+	sync->period = period;
+	sync->late_ticks = late_ticks;
+	sync->ready_tick = 0;
+	sync->started = 0;
+	sync->pending = 0;
+	sync->frames = 0;
+	sync->posted = 0;
+	sync->taken = 0;
+	sync->skipped = 0;
+	sync->dropped = 0;
+	sync->late = 0;
+	sync->max_latency = 0;
+
+	// Swapping to the buffer already in use leaves capture where it is
+	alt_write_word((char *)base + FRAME_SYNC_BACK_OFFSET, alt_read_word((char *)base + FRAME_SYNC_BUFFER_OFFSET));
+	alt_write_word((char *)base + FRAME_SYNC_BUFFER_OFFSET, 1);
+}
+
+/****************************************************************************************
+ * Subroutine to check for a completed frame and decide whether to hand it on
+****************************************************************************************/
+int frame_sync_poll(FrameSync *sync, unsigned int now)
+{
+	if (alt_read_word((char *)sync->base + FRAME_SYNC_STATUS_OFFSET) & FRAME_SYNC_STATUS_SWAP) {
+		return 0;
+	}
+
+	sync->frames++;
+	alt_write_word((char *)sync->base + FRAME_SYNC_BUFFER_OFFSET, 1);
+
+	// Hold the target rate, with a quarter period of slack for the polling interval
+	if (sync->started && now - sync->ready_tick < sync->period - sync->period / 4) {
+		sync->skipped++;
+		return 0;
+	}
+
+	sync->started = 1;
+	sync->ready_tick = now;
+
+	// The consumer has not woken for the last frame yet, it will find this one instead
+	if (sync->pending) {
+		sync->dropped++;
+		return 0;
+	}
+
+	sync->pending = 1;
+	sync->posted++;
+	return 1;
+}
+
+/****************************************************************************************
+ * Subroutine to mark the waiting frame taken
+****************************************************************************************/
+unsigned int frame_sync_take(FrameSync *sync, unsigned int now)
+{
+	unsigned int latency = now - sync->ready_tick;
+
+	sync->pending = 0;
+	sync->taken++;
+
+	if (latency > sync->late_ticks) {
+		sync->late++;
+	}
+
+	if (latency > sync->max_latency) {
+		sync->max_latency = latency;
+	}
+
+	return latency;
+}
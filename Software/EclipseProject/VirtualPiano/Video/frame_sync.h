@@ -0,0 +1,65 @@
+/*
+*********************************************************************************************************
+*
+*                                    VIDEO-IN FRAME SYNC HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : frame_sync.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Frame completion for the Altera University IP "Video-In DMA Controller", which has no
+* 				  interrupt.  A swap is requested with Backbuffer loaded with the address already in
+* 				  Buffer, so the buffer never moves, and the controller holds the S bit of Status until
+* 				  the frame it is writing is complete.  frame_sync_poll() sees S clear, counts the frame
+* 				  and requests the next swap.
+*
+* 				  Frames are handed on at no more than a target rate and one at a time: a frame that
+* 				  completes before the last one handed on was taken replaces it and counts as dropped,
+* 				  and a frame taken more than a set number of ticks after it completed counts as late.
+* 				  Times are in OS ticks supplied by the caller, so nothing here depends on the kernel.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __FRAME_SYNC_H__
+#define __FRAME_SYNC_H__
+
+#include <hps.h>
+#include <socal.h>
+
+// Video-In DMA Controller registers
+#define FRAME_SYNC_BUFFER_OFFSET 0x00		// writing it requests a swap
+#define FRAME_SYNC_BACK_OFFSET 0x04
+#define FRAME_SYNC_STATUS_OFFSET 0x0c
+#define FRAME_SYNC_STATUS_SWAP 0x01			// S: swap requested, frame not yet complete
+
+typedef struct {
+	void           *base;			// controller registers
+	unsigned int    period;			// ticks between frames handed on at the target rate
+	unsigned int    late_ticks;		// a frame taken later than this after completing is late
+	unsigned int    ready_tick;		// when the frame waiting to be taken completed
+	int             started;		// a frame has been handed on
+	int             pending;		// and not taken yet
+
+	// Statistics
+	unsigned int    frames;			// frames the controller completed
+	unsigned int    posted;			// frames handed on
+	unsigned int    taken;
+	unsigned int    skipped;		// completed sooner than the target rate allows
+	unsigned int    dropped;		// replaced by a newer frame before they were taken
+	unsigned int    late;
+	unsigned int    max_latency;	// most ticks from completion to being taken
+} FrameSync;
+
+// Starts watching for frame completion, handing frames on every period ticks at most
+void frame_sync_init(FrameSync *sync, void *base, unsigned int period, unsigned int late_ticks);
+
+// Non-zero when a frame has completed that the consumer should be woken for
+int frame_sync_poll(FrameSync *sync, unsigned int now);
+
+// Marks the waiting frame taken, returning the ticks since it completed
+unsigned int frame_sync_take(FrameSync *sync, unsigned int now);
+
+#endif /* __FRAME_SYNC_H__ */
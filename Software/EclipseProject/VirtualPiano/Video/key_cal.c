@@ -0,0 +1,395 @@
+/*
+*********************************************************************************************************
+*
+*                                        KEYBOARD CALIBRATION CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_cal.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include "key_cal.h"
+
+// Furthest a row's keyboard edge may be off the first fit of its side, pixels
+#define KEY_CAL_OUTLINE_SLACK 2.0f
+
+typedef struct {
+	short           x0, x1;
+} KeyCalRun;
+
+// Gray level midway between the 5th and 95th percentiles of the frame
+static int find_threshold(const unsigned char *frame, int frame_stride, const PixelLut *lut)
+{
+	unsigned int histogram[PIXEL_LUT_SIZE];
+	unsigned int total = VIDEO_IN_FRAME_WIDTH * VIDEO_IN_FRAME_HEIGHT, sum = 0;
+	int low = -1, high = -1;
+	int g, x, y;
+
+	memset(histogram, 0, sizeof(histogram));
+
+	for (y = 0; y < VIDEO_IN_FRAME_HEIGHT; y++) {
+		for (x = 0; x < VIDEO_IN_FRAME_WIDTH; x++) {
+			histogram[PIXEL_LUT_GRAY(lut, frame[y * frame_stride + x])]++;
+		}
+	}
+
+	for (g = 0; g < PIXEL_LUT_SIZE; g++) {
+		sum += histogram[g];
+
+		if (low < 0 && sum * 20 >= total) {
+			low = g;
+		}
+		if (high < 0 && sum * 20 >= total * 19) {
+			high = g;
+		}
+	}
+
+	return (low + high) / 2;
+}
+
+// Per column count of pixels on the light (or dark) side of threshold over rows y0..y1-1
+static void column_profile(const unsigned char *frame, int frame_stride, const PixelLut *lut,
+						   int threshold, int light, int y0, int y1, unsigned short *counts)
+{
+	int x, y;
+
+	memset(counts, 0, VIDEO_IN_FRAME_WIDTH * sizeof(unsigned short));
+
+	for (y = y0; y < y1; y++) {
+		const unsigned char *row = frame + y * frame_stride;
+
+		for (x = 0; x < VIDEO_IN_FRAME_WIDTH; x++) {
+			counts[x] += (PIXEL_LUT_GRAY(lut, row[x]) > threshold) == light;
+		}
+	}
+}
+
+// Runs of columns x0..x1-1 counted in more than half of rows rows, returns how many (at most max_runs + 1)
+static int find_runs(const unsigned short *counts, int rows, int x0, int x1, int min_width,
+					 KeyCalRun *runs, int max_runs)
+{
+	int num_runs = 0, start = -1;
+	int x;
+
+	for (x = x0; x <= x1; x++) {
+		int on = x < x1 && counts[x] * 2 > rows;
+
+		if (on && start < 0) {
+			start = x;
+		}
+		else if (!on && start >= 0) {
+			if (x - start >= min_width) {
+				if (num_runs == max_runs) {
+					return max_runs + 1;
+				}
+				runs[num_runs].x0 = (short)start;
+				runs[num_runs].x1 = (short)x;
+				num_runs++;
+			}
+			start = -1;
+		}
+	}
+
+	return num_runs;
+}
+
+// Keyboard rows: the longest run of rows at least a quarter light, returns -1 if under 8 rows
+static int find_rows(const unsigned char *frame, int frame_stride, const PixelLut *lut,
+					 int threshold, short *top, short *bottom)
+{
+	int run_start = -1;
+	int x, y;
+
+	*top = *bottom = 0;
+
+	for (y = 0; y <= VIDEO_IN_FRAME_HEIGHT; y++) {
+		int light = 0;
+
+		if (y < VIDEO_IN_FRAME_HEIGHT) {
+			for (x = 0; x < VIDEO_IN_FRAME_WIDTH; x++) {
+				light += PIXEL_LUT_GRAY(lut, frame[y * frame_stride + x]) > threshold;
+			}
+		}
+
+		if (light * 4 >= VIDEO_IN_FRAME_WIDTH && y < VIDEO_IN_FRAME_HEIGHT) {
+			run_start = run_start < 0 ? y : run_start;
+		}
+		else if (run_start >= 0) {
+			if (y - run_start > *bottom - *top) {
+				*top = (short)run_start;
+				*bottom = (short)y;
+			}
+			run_start = -1;
+		}
+	}
+
+	return *bottom - *top < 8 ? -1 : 0;
+}
+
+// Fits x = a + b * y through the points, dropping those more than KEY_CAL_OUTLINE_SLACK off
+// the first fit, returns -1 with fewer than 8 points left
+static int fit_side(const float *xs, int y0, int y1, float *a, float *b)
+{
+	int pass, y;
+
+	*a = *b = 0.0f;
+
+	for (pass = 0; pass < 2; pass++) {
+		float n = 0.0f, sy = 0.0f, sx = 0.0f, syy = 0.0f, sxy = 0.0f, det;
+
+		for (y = y0; y < y1; y++) {
+			float yc = y + 0.5f;
+			float x = xs[y];
+
+			if (x < 0.0f || (pass > 0 && (x - (*a + *b * yc)) * (x - (*a + *b * yc)) > KEY_CAL_OUTLINE_SLACK * KEY_CAL_OUTLINE_SLACK)) {
+				continue;
+			}
+			n += 1.0f;
+			sy += yc;
+			sx += x;
+			syy += yc * yc;
+			sxy += yc * x;
+		}
+
+		det = n * syy - sy * sy;
+		if (n < 8.0f || det == 0.0f) {
+			return -1;
+		}
+		*b = (n * sxy - sy * sx) / det;
+		*a = (sx - *b * sy) / n;
+	}
+
+	return 0;
+}
+
+/****************************************************************************************
+ * Find the outline of the keyboard in a frame
+****************************************************************************************/
+int key_cal_find_outline(const unsigned char *frame, int frame_stride, const PixelLut *lut, short *corners)
+{
+	float lefts[VIDEO_IN_FRAME_HEIGHT], rights[VIDEO_IN_FRAME_HEIGHT];
+	float left_a, left_b, right_a, right_b;
+	int threshold, x, y;
+	short top, bottom;
+
+	threshold = find_threshold(frame, frame_stride, lut);
+	if (find_rows(frame, frame_stride, lut, threshold, &top, &bottom) != 0) {
+		return KEY_CAL_ERR_NO_KEYBOARD;
+	}
+
+	// First and last light pixel of every keyboard row, the row's centre being y + 0.5
+	for (y = top; y < bottom; y++) {
+		const unsigned char *row = frame + y * frame_stride;
+
+		lefts[y] = rights[y] = -1.0f;
+		for (x = 0; x < VIDEO_IN_FRAME_WIDTH; x++) {
+			if (PIXEL_LUT_GRAY(lut, row[x]) > threshold) {
+				lefts[y] = lefts[y] < 0.0f ? (float)x : lefts[y];
+				rights[y] = (float)(x + 1);
+			}
+		}
+	}
+
+	if (fit_side(lefts, top, bottom, &left_a, &left_b) != 0 ||
+		fit_side(rights, top, bottom, &right_a, &right_b) != 0) {
+		return KEY_CAL_ERR_NO_KEYBOARD;
+	}
+
+	// Where the sides cross the first and last keyboard row edges
+	corners[0] = (short)(left_a + left_b * top + 0.5f);
+	corners[1] = top;
+	corners[2] = (short)(right_a + right_b * top + 0.5f);
+	corners[3] = top;
+	corners[4] = (short)(right_a + right_b * bottom + 0.5f);
+	corners[5] = bottom;
+	corners[6] = (short)(left_a + left_b * bottom + 0.5f);
+	corners[7] = bottom;
+
+	if (corners[2] - corners[0] < KEY_CAL_WHITE_KEYS || corners[4] - corners[6] < KEY_CAL_WHITE_KEYS) {
+		return KEY_CAL_ERR_NO_KEYBOARD;
+	}
+
+	return KEY_CAL_OK;
+}
+
+/****************************************************************************************
+ * Find the keys in a reference frame
+****************************************************************************************/
+int key_cal_find(KeyCal *cal, const unsigned char *frame, int frame_stride, const PixelLut *lut)
+{
+	unsigned short counts[VIDEO_IN_FRAME_WIDTH];
+	unsigned short dark[VIDEO_IN_FRAME_HEIGHT];
+	KeyCalRun white[KEY_CAL_WHITE_KEYS], black[KEY_CAL_BLACK_KEYS];
+	int threshold, rows, min_dark, max_dark, min_width;
+	int i, j, k, x, y;
+
+	memset(cal, 0, sizeof(*cal));
+	threshold = find_threshold(frame, frame_stride, lut);
+	cal->threshold = (unsigned char)threshold;
+
+	// Keyboard rows
+	if (find_rows(frame, frame_stride, lut, threshold, &cal->top, &cal->bottom) != 0) {
+		return KEY_CAL_ERR_NO_KEYBOARD;
+	}
+
+	// Keyboard columns: light in the bottom eighth, which only white keys reach
+	rows = (cal->bottom - cal->top) / 8;
+	column_profile(frame, frame_stride, lut, threshold, 1, cal->bottom - rows, cal->bottom, counts);
+	cal->left = VIDEO_IN_FRAME_WIDTH;
+	for (x = 0; x < VIDEO_IN_FRAME_WIDTH; x++) {
+		if (counts[x] * 2 > rows) {
+			cal->left = cal->left < x ? cal->left : (short)x;
+			cal->right = (short)(x + 1);
+		}
+	}
+
+	if (cal->right - cal->left < KEY_CAL_WHITE_KEYS) {
+		return KEY_CAL_ERR_NO_KEYBOARD;
+	}
+
+	// Black keys end below the last row with more dark pixels than halfway between the extremes
+	min_dark = VIDEO_IN_FRAME_WIDTH;
+	max_dark = 0;
+	for (y = cal->top; y < cal->bottom; y++) {
+		const unsigned char *row = frame + y * frame_stride;
+
+		dark[y] = 0;
+		for (x = cal->left; x < cal->right; x++) {
+			dark[y] += PIXEL_LUT_GRAY(lut, row[x]) <= threshold;
+		}
+		min_dark = dark[y] < min_dark ? dark[y] : min_dark;
+		max_dark = dark[y] > max_dark ? dark[y] : max_dark;
+	}
+
+	cal->split = cal->top;
+	for (y = cal->top; y < cal->bottom; y++) {
+		if (dark[y] * 2 > min_dark + max_dark) {
+			cal->split = (short)(y + 1);
+		}
+	}
+
+	if (cal->split <= cal->top || cal->split >= cal->bottom) {
+		return KEY_CAL_ERR_BLACK_KEYS;
+	}
+
+	// White keys: light runs below the black keys, split at the middle of the gaps between them
+	column_profile(frame, frame_stride, lut, threshold, 1, cal->split, cal->bottom, counts);
+	if (find_runs(counts, cal->bottom - cal->split, cal->left, cal->right, 1, white, KEY_CAL_WHITE_KEYS) != KEY_CAL_WHITE_KEYS) {
+		return KEY_CAL_ERR_WHITE_KEYS;
+	}
+
+	for (i = 1; i < KEY_CAL_WHITE_KEYS; i++) {
+		short boundary = (short)((white[i - 1].x1 + white[i].x0) / 2);
+
+		white[i - 1].x1 = boundary;
+		white[i].x0 = boundary;
+	}
+	white[0].x0 = cal->left;
+	white[KEY_CAL_WHITE_KEYS - 1].x1 = cal->right;
+
+	// Black keys: dark runs above at least half a white key wide, wider than the gaps between
+	// white keys even where resampling a rectified strip doubled a gap
+	min_width = (cal->right - cal->left + KEY_CAL_WHITE_KEYS) / (KEY_CAL_WHITE_KEYS * 2);
+	min_width = min_width < 2 ? 2 : min_width;
+	column_profile(frame, frame_stride, lut, threshold, 0, cal->top, cal->split, counts);
+	if (find_runs(counts, cal->split - cal->top, cal->left, cal->right, min_width, black, KEY_CAL_BLACK_KEYS) != KEY_CAL_BLACK_KEYS) {
+		return KEY_CAL_ERR_BLACK_KEYS;
+	}
+
+	// Interleave them left to right, narrowing each white key to the columns between its black neighbours
+	for (i = j = k = 0; k < KEY_MAP_KEYS; k++) {
+		KeyCalKey *key = &cal->keys[k];
+
+		if (j < KEY_CAL_BLACK_KEYS && (i == KEY_CAL_WHITE_KEYS || black[j].x0 + black[j].x1 < white[i].x0 + white[i].x1)) {
+			key->x0 = key->top_x0 = black[j].x0;
+			key->x1 = key->top_x1 = black[j].x1;
+			key->black = 1;
+			j++;
+			continue;
+		}
+
+		key->x0 = key->top_x0 = white[i].x0;
+		key->x1 = key->top_x1 = white[i].x1;
+
+		if (j > 0 && black[j - 1].x1 > key->top_x0) {
+			key->top_x0 = black[j - 1].x1;
+		}
+		if (j < KEY_CAL_BLACK_KEYS && black[j].x0 < key->top_x1) {
+			key->top_x1 = black[j].x0;
+		}
+		i++;
+	}
+
+	cal->num_keys = KEY_MAP_KEYS;
+	key_cal_seal(cal);
+	return KEY_CAL_OK;
+}
+
+/****************************************************************************************
+ * Build a key map from a calibration
+****************************************************************************************/
+void key_cal_apply(const KeyCal *cal, KeyMap *map)
+{
+	int k;
+
+	key_map_init(map);
+
+	for (k = 0; k < cal->num_keys && k < KEY_MAP_KEYS; k++) {
+		const KeyCalKey *key = &cal->keys[k];
+
+		if (key->black) {
+			key_map_set_rect(map, k, key->x0, cal->top, key->x1, cal->split);
+		}
+		else if (key->top_x0 == key->x0 && key->top_x1 == key->x1) {
+			key_map_set_rect(map, k, key->x0, cal->top, key->x1, cal->bottom);
+		}
+		else if (key->top_x1 <= key->top_x0) {
+			key_map_set_rect(map, k, key->x0, cal->split, key->x1, cal->bottom);
+		}
+		else {
+			// Narrow between the black keys, full width below them
+			short points[16] = {
+				key->top_x0, cal->top,		key->top_x1, cal->top,
+				key->top_x1, cal->split,	key->x1, cal->split,
+				key->x1, cal->bottom,		key->x0, cal->bottom,
+				key->x0, cal->split,		key->top_x0, cal->split
+			};
+
+			key_map_set_polygon(map, k, points, 8);
+		}
+	}
+}
+
+/****************************************************************************************
+ * Checksum and seal a calibration for storage
+****************************************************************************************/
+static unsigned int checksum(const KeyCal *cal)
+{
+	const unsigned char *bytes = (const unsigned char *)cal;
+	unsigned int hash = 2166136261u;
+	size_t i;
+
+	for (i = 0; i < offsetof(KeyCal, checksum); i++) {
+		hash = (hash ^ bytes[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+void key_cal_seal(KeyCal *cal)
+{
+	cal->magic = KEY_CAL_MAGIC;
+	cal->version = KEY_CAL_VERSION;
+	cal->checksum = checksum(cal);
+}
+
+int key_cal_valid(const KeyCal *cal)
+{
+	return cal->magic == KEY_CAL_MAGIC && cal->version == KEY_CAL_VERSION &&
+		   cal->num_keys == KEY_MAP_KEYS && cal->checksum == checksum(cal);
+}
@@ -0,0 +1,92 @@
+/*
+*********************************************************************************************************
+*
+*                                     KEYBOARD CALIBRATION HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_cal.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Finds the 88 keys in a reference frame of the keyboard with no hands over it, the
+* 				  black keys towards the top of the frame.  Gray levels are split into key and gap at
+* 				  the midpoint of the 5th and 95th percentiles.  The keyboard rows are the longest run
+* 				  of rows that are mostly light, the black keys end where the dark count per row
+* 				  drops, the white keys are the light runs of the column profile below the black
+* 				  keys and the black keys the wide dark runs of the column profile above.
+*
+* 				  The result is a KeyCal: the keyboard rows and the columns of every key, white keys
+* 				  narrowing between their black neighbours.  key_cal_apply() turns it into a KeyMap,
+* 				  from which key_map_build_labels() makes the pixel to key table and
+* 				  bit_mask_build_keys() the per-key masks.  A KeyCal is plain data with a magic number,
+* 				  version and checksum, so it can be stored as it is and trusted on the next start
+* 				  only if key_cal_valid() says so.
+*
+* 				  Seen at an angle the keyboard is a trapezoid and its key boundaries slant.
+* 				  key_cal_find_outline() fits a line through the first and through the last light
+* 				  pixel of every keyboard row, dropping rows off the first fit, and returns where they
+* 				  cross the first and last keyboard rows: the four corners a Remap (remap.h) needs.
+* 				  The keys are then found in the rectified strip, and the corners are kept in the
+* 				  KeyCal with rectified set, so a stored calibration brings its remap with it.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __KEY_CAL_H__
+#define __KEY_CAL_H__
+
+#include "key_map.h"
+#include "pixel_lut.h"
+
+#define KEY_CAL_WHITE_KEYS 52
+#define KEY_CAL_BLACK_KEYS 36
+
+#define KEY_CAL_MAGIC 0x4C41434Bu		// "KCAL"
+#define KEY_CAL_VERSION 2
+
+// key_cal_find() results
+#define KEY_CAL_OK 0
+#define KEY_CAL_ERR_NO_KEYBOARD -1		// no band of light rows
+#define KEY_CAL_ERR_WHITE_KEYS -2		// not 52 white keys
+#define KEY_CAL_ERR_BLACK_KEYS -3		// not 36 black keys
+
+typedef struct {
+	short           x0, x1;			// columns below the black keys, x1 exclusive
+	short           top_x0, top_x1;	// columns between the black keys, the same for a black key
+	unsigned char   black;
+	unsigned char   reserved;
+} KeyCalKey;
+
+typedef struct {
+	unsigned int    magic;
+	unsigned short  version;
+	unsigned short  num_keys;
+	short           top, split;		// keyboard rows, black keys end at split
+	short           bottom;			// exclusive
+	short           left, right;	// keyboard columns, right exclusive
+	unsigned char   threshold;		// gray level between key and gap
+	unsigned char   rectified;		// keys are in the strip remapped from corners
+	short           corners[8];		// x, y top left, top right, bottom right, bottom left in the frame
+	KeyCalKey       keys[KEY_MAP_KEYS];
+	unsigned int    checksum;		// FNV-1a of everything above
+} KeyCal;
+
+// Finds the keys in a reference frame, returns KEY_CAL_OK or a KEY_CAL_ERR_ code.  On
+// success cal is sealed and ready to store.
+int key_cal_find(KeyCal *cal, const unsigned char *frame, int frame_stride, const PixelLut *lut);
+
+// Finds the corners of the keyboard in a reference frame, for remap_init(), returns KEY_CAL_OK
+// or KEY_CAL_ERR_NO_KEYBOARD
+int key_cal_find_outline(const unsigned char *frame, int frame_stride, const PixelLut *lut, short *corners);
+
+// Rebuilds map from a calibration, key k being the k-th key from the left
+void key_cal_apply(const KeyCal *cal, KeyMap *map);
+
+// Sets the magic number, version and checksum
+void key_cal_seal(KeyCal *cal);
+
+// Non-zero when cal is a sealed calibration of this version
+int key_cal_valid(const KeyCal *cal);
+
+#endif /* __KEY_CAL_H__ */
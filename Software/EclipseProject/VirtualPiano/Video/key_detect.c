@@ -0,0 +1,339 @@
+/*
+*********************************************************************************************************
+*
+*                                          KEY DETECTOR CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_detect.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "key_detect.h"
+
+// Calls the step hook, if any
+#define KEY_DETECT_STEP_DONE(det, step) \
+	do { if ((det)->step_fnct != NULL) (det)->step_fnct((det)->step_ctx, (step)); } while (0)
+
+/****************************************************************************************
+ * Subroutine to forget every frame seen, the tiles, background and detections
+****************************************************************************************/
+static void key_detect_forget(KeyDetector *det)
+{
+	tile_change_init(&det->tiles, TILE_SAD_THRESHOLD_DEFAULT, TILE_REFRESH_PERIOD_DEFAULT);
+	background_init(&det->background, BACKGROUND_SHIFT_DEFAULT, BACKGROUND_HOT_SHIFT_DEFAULT,
+					BACKGROUND_DELTA_DEFAULT);
+	pyramid_use_limits(&det->pyramid, NULL);
+
+	memset(det->key_mask, 0, sizeof(det->key_mask));
+	memset(det->lit_mask, 0, sizeof(det->lit_mask));
+	memset(det->key_counts, 0, sizeof(det->key_counts));
+	det->blobs.num_blobs = 0;
+}
+
+/****************************************************************************************
+ * Subroutine to rebuild everything that follows the key map
+****************************************************************************************/
+static void key_detect_use_map(KeyDetector *det)
+{
+	int k, tx, ty;
+
+	bit_mask_build_keys(&det->key_bits, &det->map);
+	key_map_build_labels(&det->map, det->labels);
+	key_detect_forget(det);
+
+	// Which keys a changed tile puts back in play
+	memset(det->tile_keys, 0, sizeof(det->tile_keys));
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		const KeyRegion *key = &det->map.keys[k];
+
+		if (key->x1 <= key->x0 || key->y1 <= key->y0) {
+			continue;
+		}
+
+		for (ty = key->y0 / TILE_SIZE; ty <= (key->y1 - 1) / TILE_SIZE; ty++) {
+			for (tx = key->x0 / TILE_SIZE; tx <= (key->x1 - 1) / TILE_SIZE; tx++) {
+				det->tile_keys[ty * TILE_COLS + tx][k >> 5] |= 1u << (k & 31);
+			}
+		}
+	}
+}
+
+/****************************************************************************************
+ * Subroutine to find the keys under the changed tiles and the box around them
+****************************************************************************************/
+static int key_detect_changed_keys(KeyDetector *det, unsigned int *keys, short *box)
+{
+	int t, w, k, any = 0;
+
+	memset(keys, 0, KEY_MAP_MASK_WORDS * sizeof(unsigned int));
+	for (t = 0; t < TILE_COUNT; t++) {
+		if (det->tiles.changed[t]) {
+			for (w = 0; w < KEY_MAP_MASK_WORDS; w++) {
+				keys[w] |= det->tile_keys[t][w];
+			}
+		}
+	}
+
+	box[0] = VIDEO_IN_FRAME_WIDTH;
+	box[1] = VIDEO_IN_FRAME_HEIGHT;
+	box[2] = 0;
+	box[3] = 0;
+	for (w = 0; w < KEY_MAP_MASK_WORDS; w++) {
+		unsigned int visit = keys[w];
+
+		while (visit != 0) {
+			const KeyRegion *key;
+
+			k = (w << 5) + BIT_MASK_CTZ(visit);
+			visit &= visit - 1;
+			key = &det->map.keys[k];
+			box[0] = key->x0 < box[0] ? key->x0 : box[0];
+			box[1] = key->y0 < box[1] ? key->y0 : box[1];
+			box[2] = key->x1 > box[2] ? key->x1 : box[2];
+			box[3] = key->y1 > box[3] ? key->y1 : box[3];
+			any = 1;
+		}
+	}
+
+	return any;
+}
+
+/****************************************************************************************
+ * Subroutine to label the blobs inside a box and keep the last frame's blobs clear of it
+****************************************************************************************/
+static void key_detect_blobs(KeyDetector *det, const short *box)
+{
+	BlobLabeller *blobs = &det->blobs;
+	const Pyramid *pyramid = &det->pyramid;
+	int x0 = box[0] > pyramid->x0 ? box[0] : pyramid->x0;
+	int y0 = box[1] > pyramid->y0 ? box[1] : pyramid->y0;
+	int x1 = box[2] < pyramid->x1 ? box[2] : pyramid->x1;
+	int y1 = box[3] < pyramid->y1 ? box[3] : pyramid->y1;
+	int num_still = 0;
+	int i, j;
+
+	for (i = 0; i < blobs->num_blobs; i++) {
+		const Blob *blob = &blobs->blobs[i];
+
+		if (blob->x1 <= box[0] || blob->x0 >= box[2] || blob->y1 <= box[1] || blob->y0 >= box[3]) {
+			det->still_blobs[num_still++] = *blob;
+		}
+	}
+
+	// Only where the pyramid found something
+	if (x1 > x0 && y1 > y0) {
+		blob_label(blobs, &det->bright_mask, x0, y0, x1, y1);
+	}
+	else {
+		blobs->num_blobs = 0;
+	}
+
+	// Back in order, largest first, the smallest go past BLOB_MAX_BLOBS
+	for (i = 0; i < num_still; i++) {
+		const Blob *still = &det->still_blobs[i];
+
+		if (blobs->num_blobs < BLOB_MAX_BLOBS) {
+			j = blobs->num_blobs++;
+		}
+		else if (blobs->blobs[BLOB_MAX_BLOBS - 1].area < still->area) {
+			j = BLOB_MAX_BLOBS - 1;
+		}
+		else {
+			blobs->blobs_dropped++;
+			continue;
+		}
+
+		for (; j > 0 && blobs->blobs[j - 1].area < still->area; j--) {
+			blobs->blobs[j] = blobs->blobs[j - 1];
+		}
+		blobs->blobs[j] = *still;
+	}
+}
+
+/****************************************************************************************
+ * Subroutine to set up the detector
+****************************************************************************************/
+void key_detect_init(KeyDetector *det)
+{
+	memset(det, 0, sizeof(*det));
+
+	pixel_lut_init(&det->lut, PIXEL_LUT_THRESHOLD_DEFAULT);
+	pyramid_init(&det->pyramid, &det->lut);
+	blob_init(&det->blobs, KEY_MAP_MIN_PIXELS_DEFAULT);
+	key_state_init(&det->state, KEY_STATE_ON_PIXELS_DEFAULT, KEY_STATE_OFF_PIXELS_DEFAULT,
+				   KEY_STATE_ON_FRAMES_DEFAULT, KEY_STATE_OFF_FRAMES_DEFAULT);
+	key_track_init(&det->tracker, KEY_TRACK_ACCEL_NOISE_DEFAULT, KEY_TRACK_MEASURE_NOISE_DEFAULT,
+				   KEY_TRACK_LOOKAHEAD_DEFAULT);
+}
+
+/****************************************************************************************
+ * Subroutine to find the keys in a reference frame
+****************************************************************************************/
+int key_detect_calibrate(KeyDetector *det, const unsigned char *frame)
+{
+	short corners[8];
+
+	if (key_cal_find_outline(frame, VIDEO_IN_ROW_STRIDE, &det->lut, corners) == KEY_CAL_OK &&
+		remap_init(&det->remap, corners, VIDEO_IN_ROW_STRIDE) == 0) {
+		remap_frame_rows(&det->remap, frame, det->strip, VIDEO_IN_ROW_STRIDE, 0, det->remap.height);
+
+		if (key_cal_find(&det->cal, det->strip, VIDEO_IN_ROW_STRIDE, &det->lut) == KEY_CAL_OK) {
+			det->cal.rectified = 1;
+			memcpy(det->cal.corners, corners, sizeof(det->cal.corners));
+			key_cal_seal(&det->cal);
+			return KEY_CAL_OK;
+		}
+	}
+
+	return key_cal_find(&det->cal, frame, VIDEO_IN_ROW_STRIDE, &det->lut);
+}
+
+/****************************************************************************************
+ * Subroutine to detect with the keys of a calibration
+****************************************************************************************/
+int key_detect_use_cal(KeyDetector *det, const KeyCal *cal)
+{
+	if (cal->rectified && remap_init(&det->remap, cal->corners, VIDEO_IN_ROW_STRIDE) != 0) {
+		return -1;
+	}
+
+	if (cal != &det->cal) {
+		memcpy(&det->cal, cal, sizeof(det->cal));
+	}
+	det->rectified = cal->rectified;
+	key_cal_apply(cal, &det->map);
+	key_detect_use_map(det);
+	return 0;
+}
+
+/****************************************************************************************
+ * Subroutine to detect with equal zones
+****************************************************************************************/
+void key_detect_use_uniform(KeyDetector *det, int x0, int y0, int x1, int y1)
+{
+	det->rectified = 0;
+	key_map_init_uniform(&det->map, x0, y0, x1, y1);
+	key_detect_use_map(det);
+}
+
+/****************************************************************************************
+ * Subroutine to detect with the keys of a frame with no calibration
+****************************************************************************************/
+void key_detect_use_default(KeyDetector *det)
+{
+	key_detect_use_uniform(det, 0, KEY_DETECT_KEYBOARD_TOP, VIDEO_IN_FRAME_WIDTH, VIDEO_IN_FRAME_HEIGHT);
+}
+
+/****************************************************************************************
+ * Subroutine to start over with the same keys
+****************************************************************************************/
+void key_detect_restart(KeyDetector *det, unsigned int frame, const Background *background)
+{
+	key_detect_forget(det);
+	memset(&det->bright_mask, 0, sizeof(det->bright_mask));
+	det->tiles.frame = frame;
+
+	// The level 1 samples do not depend on the limits, so a background learned elsewhere fits
+	if (background != NULL && background->updates > 0) {
+		memcpy(&det->background, background, sizeof(det->background));
+		pyramid_use_limits(&det->pyramid, det->background.limits);
+	}
+
+	key_state_init(&det->state, KEY_STATE_ON_PIXELS_DEFAULT, KEY_STATE_OFF_PIXELS_DEFAULT,
+				   KEY_STATE_ON_FRAMES_DEFAULT, KEY_STATE_OFF_FRAMES_DEFAULT);
+	key_track_init(&det->tracker, KEY_TRACK_ACCEL_NOISE_DEFAULT, KEY_TRACK_MEASURE_NOISE_DEFAULT,
+				   KEY_TRACK_LOOKAHEAD_DEFAULT);
+	det->hot_rows = 0;
+	det->frames = frame;
+}
+
+/****************************************************************************************
+ * Subroutine to learn the background alone
+****************************************************************************************/
+void key_detect_learn(KeyDetector *det, const unsigned char *frame)
+{
+	if (det->frames++ % KEY_DETECT_BACKGROUND_PERIOD != 0) {
+		return;
+	}
+
+	if (det->rectified) {
+		remap_frame(&det->remap, frame, det->strip, VIDEO_IN_ROW_STRIDE);
+		frame = det->strip;
+	}
+	pyramid_build(&det->pyramid, frame, VIDEO_IN_ROW_STRIDE,
+				  det->map.left, det->map.top, det->map.right, det->map.bottom);
+	background_update(&det->background, &det->pyramid);
+}
+
+/****************************************************************************************
+ * Subroutine to run one frame through the detector
+****************************************************************************************/
+int key_detect_frame(KeyDetector *det, const unsigned char *frame, KeyEventRing *ring)
+{
+	int changed, learn, num_events;
+
+	// Detect on the keyboard straightened out
+	if (det->rectified) {
+		remap_frame(&det->remap, frame, det->strip, VIDEO_IN_ROW_STRIDE);
+		frame = det->strip;
+	}
+	det->frame = frame;
+	KEY_DETECT_STEP_DONE(det, KEY_DETECT_STEP_REMAP);
+
+	// Quarter resolution pass when a tile changed or the background is due
+	changed = tile_change_detect(&det->tiles, frame, VIDEO_IN_ROW_STRIDE) > 0;
+	learn = det->frames % KEY_DETECT_BACKGROUND_PERIOD == 0;
+	KEY_DETECT_STEP_DONE(det, KEY_DETECT_STEP_TILES);
+
+	if (changed || learn) {
+		det->hot_rows = pyramid_build(&det->pyramid, frame, VIDEO_IN_ROW_STRIDE,
+									  det->map.left, det->map.top, det->map.right, det->map.bottom);
+	}
+	KEY_DETECT_STEP_DONE(det, KEY_DETECT_STEP_PYRAMID);
+
+	// Bright blobs over the keys under the changed tiles, every other key keeps its last ones
+	if (changed && det->hot_rows > 0) {
+		unsigned int keys[KEY_MAP_MASK_WORDS];
+		short box[4];
+
+		pyramid_refine_tiles(&det->pyramid, &det->bright_mask, frame, VIDEO_IN_ROW_STRIDE, &det->lut,
+							 det->tiles.changed);
+		if (key_detect_changed_keys(det, keys, box)) {
+			key_detect_blobs(det, box);
+			blob_keys(&det->blobs, det->labels, det->key_mask);
+			bit_mask_score_key_set(&det->key_bits, &det->bright_mask, keys, det->key_counts, det->lit_mask);
+		}
+	}
+	else if (changed) {
+		// Nothing lit anywhere, clears whatever the mask still holds
+		pyramid_refine(&det->pyramid, &det->bright_mask, frame, VIDEO_IN_ROW_STRIDE, &det->lut);
+		memset(det->key_mask, 0, sizeof(det->key_mask));
+		memset(det->lit_mask, 0, sizeof(det->lit_mask));
+		memset(det->key_counts, 0, sizeof(det->key_counts));
+		det->blobs.num_blobs = 0;
+	}
+	KEY_DETECT_STEP_DONE(det, KEY_DETECT_STEP_BLOBS);
+
+	// Learn this frame, later frames are tested against it
+	if (learn) {
+		// Words packed against the table are stale once the limits take over
+		if (det->pyramid.limits == NULL) {
+			tile_change_invalidate(&det->tiles);
+		}
+		background_update(&det->background, &det->pyramid);
+		pyramid_use_limits(&det->pyramid, det->background.limits);
+	}
+	KEY_DETECT_STEP_DONE(det, KEY_DETECT_STEP_BACKGROUND);
+
+	num_events = key_state_update(&det->state, det->key_mask, det->key_counts, det->frames++, ring);
+	KEY_DETECT_STEP_DONE(det, KEY_DETECT_STEP_KEY_STATE);
+
+	key_track_update(&det->tracker, &det->blobs, det->labels);
+	KEY_DETECT_STEP_DONE(det, KEY_DETECT_STEP_TRACK);
+
+	return num_events;
+}
@@ -0,0 +1,128 @@
+/*
+*********************************************************************************************************
+*
+*                                      KEY DETECTOR HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_detect.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The per-frame work of key detection, from a captured frame to debounced key events,
+* 				  and the calibration it runs from, held in one KeyDetector so that KeyDetectTask and
+* 				  the host replay run the same code on the same state.
+*
+* 				  A frame goes through the remap when the calibration was found through the
+* 				  keyboard's outline, then the tile change test, the quarter resolution pyramid when a
+* 				  tile changed or the background is due, the bright pixel blobs and key scores, the
+* 				  background, the key states and the tracker.  The step hook, when set, is called
+* 				  after each step so a host tool can time them; the board leaves it NULL.
+*
+* 				  Only the keys under a changed tile are looked at again: the mask is repacked under
+* 				  those tiles, blobs are labelled over those keys alone and joined to the last
+* 				  frame's blobs clear of them, and only those keys are scored.  A finger moving over
+* 				  a still keyboard costs the few keys around it, not all 88.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __KEY_DETECT_H__
+#define __KEY_DETECT_H__
+
+#include "video.h"
+#include "pixel_lut.h"
+#include "key_map.h"
+#include "tile_change.h"
+#include "bit_mask.h"
+#include "blob.h"
+#include "pyramid.h"
+#include "background.h"
+#include "key_cal.h"
+#include "key_state.h"
+#include "key_track.h"
+#include "remap.h"
+
+// Frames between background updates, detection itself runs every frame
+#define KEY_DETECT_BACKGROUND_PERIOD 4
+
+// First row of the keyboard in a frame with no calibration, the rows above show the camera's edge
+#define KEY_DETECT_KEYBOARD_TOP 10
+
+typedef enum {
+	KEY_DETECT_STEP_REMAP,
+	KEY_DETECT_STEP_TILES,
+	KEY_DETECT_STEP_PYRAMID,
+	KEY_DETECT_STEP_BLOBS,
+	KEY_DETECT_STEP_BACKGROUND,
+	KEY_DETECT_STEP_KEY_STATE,
+	KEY_DETECT_STEP_TRACK,
+	KEY_DETECT_STEPS
+} KeyDetectStep;
+
+typedef struct {
+	KeyMap          map;
+	KeyCal          cal;
+	PixelLut        lut;
+	TileChange      tiles;
+	BitMask         bright_mask;
+	KeyBitMasks     key_bits;
+	BlobLabeller    blobs;
+	Pyramid         pyramid;
+	Background      background;
+	KeyState        state;
+	KeyTracker      tracker;
+	Remap           remap;
+	int             rectified;		// frames are detected in the strip remap gathers
+
+	unsigned char   labels[VIDEO_IN_FRAME_WIDTH * VIDEO_IN_FRAME_HEIGHT];
+	unsigned char   strip[VIDEO_IN_FRAME_HEIGHT * VIDEO_IN_ROW_STRIDE];
+
+	unsigned int    tile_keys[TILE_COUNT][KEY_MAP_MASK_WORDS];	// keys whose box meets each tile
+	Blob            still_blobs[BLOB_MAX_BLOBS];				// blobs kept across a labelling
+
+	// Per frame state, each key's kept while no tile under it changes
+	unsigned int    key_mask[KEY_MAP_MASK_WORDS];	// keys under a blob's centroid
+	unsigned int    lit_mask[KEY_MAP_MASK_WORDS];	// keys with a bright pixel
+	unsigned short  key_counts[KEY_MAP_KEYS];		// bright pixels per key
+	int             hot_rows;
+	unsigned int    frames;
+	const unsigned char *frame;		// last frame detected on, the strip when rectified
+
+	// Step hook, called after each step of key_detect_frame() when not NULL
+	void          (*step_fnct)(void *ctx, KeyDetectStep step);
+	void           *step_ctx;
+} KeyDetector;
+
+// Sets up everything but the keys, which come from key_detect_use_cal() or key_detect_use_uniform()
+void key_detect_init(KeyDetector *det);
+
+// Finds the keys in a reference frame into det->cal, through the keyboard's outline and rectified
+// strip first, then in the frame as it is; returns KEY_CAL_OK with det->cal sealed, or the
+// KEY_CAL_ERR_ code of the straight attempt.  det->remap is rebuilt on the way, so this is for a
+// detector on equal zones, and det->cal is only put to use by key_detect_use_cal().
+int key_detect_calibrate(KeyDetector *det, const unsigned char *frame);
+
+// Detects with the keys of a calibration, returns 0 or -1 if its outline gives no remap
+int key_detect_use_cal(KeyDetector *det, const KeyCal *cal);
+
+// Detects with the columns x0..x1 split into equal zones over rows y0..y1
+void key_detect_use_uniform(KeyDetector *det, int x0, int y0, int x1, int y1);
+
+// Detects with the frame's width split into equal zones below KEY_DETECT_KEYBOARD_TOP, the keys
+// of a frame with no calibration
+void key_detect_use_default(KeyDetector *det);
+
+// Starts over with the same keys at frame, as a detector fresh from key_detect_use_cal() but for the
+// background, which is taken from background when not NULL, and the tile refreshes, which keep to
+// the frame numbers.  A host tool splitting a recording between detectors starts each with this.
+void key_detect_restart(KeyDetector *det, unsigned int frame, const Background *background);
+
+// Runs only the steps the background learns from, on the frames it is due; the background then
+// follows the frames as key_detect_frame() would have it, for key_detect_restart()
+void key_detect_learn(KeyDetector *det, const unsigned char *frame);
+
+// Runs one frame through every step, key transitions go to ring, returns how many
+int key_detect_frame(KeyDetector *det, const unsigned char *frame, KeyEventRing *ring);
+
+#endif /* __KEY_DETECT_H__ */
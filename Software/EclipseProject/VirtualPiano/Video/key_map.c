@@ -0,0 +1,369 @@
+/*
+*********************************************************************************************************
+*
+*                                            KEY MAP CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_map.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "video_kernel.h"
+#include "key_map.h"
+
+// Clamps a coordinate to 0..limit
+static int clamp(int value, int limit)
+{
+	return value < 0 ? 0 : value > limit ? limit : value;
+}
+
+// Recomputes the area, the bounds and the per-row span index
+static void update_map(KeyMap *map)
+{
+	int k, s, y;
+
+	map->area = 0;
+	map->left = VIDEO_IN_FRAME_WIDTH;
+	map->top = VIDEO_IN_FRAME_HEIGHT;
+	map->right = 0;
+	map->bottom = 0;
+
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		const KeyRegion *region = &map->keys[k];
+
+		if (region->min_pixels == 0) {
+			continue;
+		}
+
+		if (region->num_spans == 0) {
+			map->area += (region->x1 - region->x0) * (region->y1 - region->y0);
+		}
+
+		for (s = 0; s < region->num_spans; s++) {
+			const KeySpan *span = &map->spans[region->first_span + s];
+
+			map->area += span->x1 - span->x0;
+		}
+
+		map->left = region->x0 < map->left ? region->x0 : map->left;
+		map->top = region->y0 < map->top ? region->y0 : map->top;
+		map->right = region->x1 > map->right ? region->x1 : map->right;
+		map->bottom = region->y1 > map->bottom ? region->y1 : map->bottom;
+	}
+
+	if (map->right <= map->left || map->bottom <= map->top) {
+		map->left = map->right = 0;
+		map->top = map->bottom = 0;
+	}
+
+	// Counting sort of the spans by row
+	memset(map->row_first, 0, sizeof(map->row_first));
+
+	for (s = 0; s < map->num_spans; s++) {
+		map->row_first[map->spans[s].y + 1]++;
+	}
+
+	for (y = 0; y < VIDEO_IN_FRAME_HEIGHT; y++) {
+		map->row_first[y + 1] += map->row_first[y];
+	}
+
+	for (s = 0; s < map->num_spans; s++) {
+		// row_first[y] is used as the fill position, then restored below
+		map->span_order[map->row_first[map->spans[s].y]++] = (unsigned short)s;
+	}
+
+	for (y = VIDEO_IN_FRAME_HEIGHT; y > 0; y--) {
+		map->row_first[y] = map->row_first[y - 1];
+	}
+	map->row_first[0] = 0;
+}
+
+/****************************************************************************************
+ * Clear a key map
+****************************************************************************************/
+void key_map_init(KeyMap *map)
+{
+	memset(map, 0, sizeof(*map));
+	map->threshold = VIDEO_THRESHOLD_DEFAULT;
+}
+
+/****************************************************************************************
+ * Split a rectangle into 88 equal keys
+****************************************************************************************/
+void key_map_init_uniform(KeyMap *map, int x0, int y0, int x1, int y1)
+{
+	int k, width = x1 - x0;
+
+	key_map_init(map);
+
+	// Key k gets the columns with (x - x0) * 88 / width == k
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		int left = x0 + (k * width + KEY_MAP_KEYS - 1) / KEY_MAP_KEYS;
+		int right = x0 + ((k + 1) * width + KEY_MAP_KEYS - 1) / KEY_MAP_KEYS;
+
+		key_map_set_rect(map, k, left, y0, right, y1);
+	}
+}
+
+/****************************************************************************************
+ * Set a rectangular key
+****************************************************************************************/
+int key_map_set_rect(KeyMap *map, int key, int x0, int y0, int x1, int y1)
+{
+	KeyRegion *region;
+
+	if (key < 0 || key >= KEY_MAP_KEYS) {
+		return -1;
+	}
+
+	region = &map->keys[key];
+	region->x0 = (short)clamp(x0, VIDEO_IN_FRAME_WIDTH);
+	region->y0 = (short)clamp(y0, VIDEO_IN_FRAME_HEIGHT);
+	region->x1 = (short)clamp(x1, VIDEO_IN_FRAME_WIDTH);
+	region->y1 = (short)clamp(y1, VIDEO_IN_FRAME_HEIGHT);
+	region->first_span = 0;
+	region->num_spans = 0;
+	region->min_pixels = KEY_MAP_MIN_PIXELS_DEFAULT;
+
+	if (region->x1 <= region->x0 || region->y1 <= region->y0) {
+		region->x1 = region->x0;
+		region->y1 = region->y0;
+		region->min_pixels = 0;
+	}
+
+	update_map(map);
+	return 0;
+}
+
+/****************************************************************************************
+ * Set a polygon key, rasterized at pixel centres with the even-odd rule
+****************************************************************************************/
+int key_map_set_polygon(KeyMap *map, int key, const short *points, int num_points)
+{
+	KeyRegion *region;
+	int min_y, max_y, min_x, max_x;
+	int first = map->num_spans;
+	int i, y;
+
+	if (key < 0 || key >= KEY_MAP_KEYS || num_points < 3 || num_points > KEY_MAP_MAX_POINTS) {
+		return -1;
+	}
+
+	min_y = max_y = points[1];
+	for (i = 1; i < num_points; i++) {
+		min_y = points[2 * i + 1] < min_y ? points[2 * i + 1] : min_y;
+		max_y = points[2 * i + 1] > max_y ? points[2 * i + 1] : max_y;
+	}
+	min_y = clamp(min_y, VIDEO_IN_FRAME_HEIGHT);
+	max_y = clamp(max_y, VIDEO_IN_FRAME_HEIGHT);
+	min_x = VIDEO_IN_FRAME_WIDTH;
+	max_x = 0;
+
+	for (y = min_y; y < max_y; y++) {
+		float centre = y + 0.5f;
+		float crossings[KEY_MAP_MAX_POINTS];
+		int num_crossings = 0;
+
+		// Where the polygon edges cross this row's centre line
+		for (i = 0; i < num_points; i++) {
+			int j = (i + 1) % num_points;
+			float ax = points[2 * i], ay = points[2 * i + 1];
+			float bx = points[2 * j], by = points[2 * j + 1];
+
+			if ((ay <= centre && by > centre) || (by <= centre && ay > centre)) {
+				float x = ax + (centre - ay) * (bx - ax) / (by - ay);
+				int c = num_crossings++;
+
+				// Insertion sort, there are only a handful
+				while (c > 0 && crossings[c - 1] > x) {
+					crossings[c] = crossings[c - 1];
+					c--;
+				}
+				crossings[c] = x;
+			}
+		}
+
+		// Pixels whose centres lie between each pair of crossings
+		for (i = 0; i + 1 < num_crossings; i += 2) {
+			int x0 = clamp((int)(crossings[i] + 0.5f), VIDEO_IN_FRAME_WIDTH);
+			int x1 = clamp((int)(crossings[i + 1] + 0.5f), VIDEO_IN_FRAME_WIDTH);
+
+			if (x1 <= x0) {
+				continue;
+			}
+
+			if (map->num_spans >= KEY_MAP_MAX_SPANS) {
+				map->num_spans = first;
+				return -1;
+			}
+
+			map->spans[map->num_spans].y = (short)y;
+			map->spans[map->num_spans].x0 = (short)x0;
+			map->spans[map->num_spans].x1 = (short)x1;
+			map->spans[map->num_spans].key = (short)key;
+			map->num_spans++;
+
+			min_x = x0 < min_x ? x0 : min_x;
+			max_x = x1 > max_x ? x1 : max_x;
+		}
+	}
+
+	region = &map->keys[key];
+	region->first_span = (unsigned short)first;
+	region->num_spans = (unsigned short)(map->num_spans - first);
+	region->min_pixels = region->num_spans ? KEY_MAP_MIN_PIXELS_DEFAULT : 0;
+	region->x0 = (short)(region->num_spans ? min_x : 0);
+	region->x1 = (short)(region->num_spans ? max_x : 0);
+	region->y0 = (short)(region->num_spans ? map->spans[first].y : 0);
+	region->y1 = (short)(region->num_spans ? map->spans[map->num_spans - 1].y + 1 : 0);
+
+	update_map(map);
+	return 0;
+}
+
+/****************************************************************************************
+ * Add up the bright pixels per key over a band of rows
+****************************************************************************************/
+void key_map_count_rows(const KeyMap *map, const unsigned char *frame, int frame_stride,
+						int y0, int y1, int *counts)
+{
+	unsigned char flags[VIDEO_IN_FRAME_WIDTH];
+	const unsigned char *row_flags = flags - map->left;
+	int k, x, y, i;
+
+	y0 = y0 < map->top ? map->top : y0;
+	y1 = y1 > map->bottom ? map->bottom : y1;
+
+	for (y = y0; y < y1; y++) {
+
+		// One pass over the keyboard's width of this row
+		video_bright_flags(frame + y * frame_stride + map->left, map->right - map->left,
+						   map->threshold, flags);
+
+		// Rectangular keys on this row
+		for (k = 0; k < KEY_MAP_KEYS; k++) {
+			const KeyRegion *region = &map->keys[k];
+
+			if (region->num_spans == 0 && region->min_pixels != 0 && y >= region->y0 && y < region->y1) {
+				for (x = region->x0; x < region->x1; x++) {
+					counts[k] += row_flags[x];
+				}
+			}
+		}
+
+		// Polygon keys on this row, skipping spans a key has since been rebuilt without
+		for (i = map->row_first[y]; i < map->row_first[y + 1]; i++) {
+			int s = map->span_order[i];
+			const KeySpan *span = &map->spans[s];
+			const KeyRegion *region = &map->keys[span->key];
+
+			if ((unsigned int)(s - region->first_span) >= region->num_spans) {
+				continue;
+			}
+
+			for (x = span->x0; x < span->x1; x++) {
+				counts[span->key] += row_flags[x];
+			}
+		}
+	}
+}
+
+/****************************************************************************************
+ * Count bright pixels per key and build the pressed key mask
+****************************************************************************************/
+void key_map_detect(const KeyMap *map, const unsigned char *frame, int frame_stride,
+					unsigned short *key_counts, unsigned int *mask)
+{
+	int counts[KEY_MAP_KEYS];
+	int k;
+
+	memset(counts, 0, sizeof(counts));
+	key_map_count_rows(map, frame, frame_stride, map->top, map->bottom, counts);
+	key_map_counts_to_mask(map, counts, mask);
+
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		key_counts[k] = (unsigned short)counts[k];
+	}
+}
+
+/****************************************************************************************
+ * Build the pixel to key label image
+****************************************************************************************/
+void key_map_build_labels(const KeyMap *map, unsigned char *labels)
+{
+	int k, s, x, y;
+
+	memset(labels, KEY_MAP_NO_KEY, VIDEO_IN_FRAME_WIDTH * VIDEO_IN_FRAME_HEIGHT);
+
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		const KeyRegion *region = &map->keys[k];
+
+		if (region->min_pixels == 0) {
+			continue;
+		}
+
+		if (region->num_spans == 0) {
+			for (y = region->y0; y < region->y1; y++) {
+				memset(labels + y * VIDEO_IN_FRAME_WIDTH + region->x0, k, region->x1 - region->x0);
+			}
+		}
+
+		for (s = 0; s < region->num_spans; s++) {
+			const KeySpan *span = &map->spans[region->first_span + s];
+
+			for (x = span->x0; x < span->x1; x++) {
+				labels[span->y * VIDEO_IN_FRAME_WIDTH + x] = (unsigned char)k;
+			}
+		}
+	}
+}
+
+/****************************************************************************************
+ * Pressed key mask from per-key counts
+****************************************************************************************/
+void key_map_counts_to_mask(const KeyMap *map, const int *key_counts, unsigned int *mask)
+{
+	int k;
+
+	memset(mask, 0, KEY_MAP_MASK_WORDS * sizeof(unsigned int));
+
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		if (map->keys[k].min_pixels != 0 && key_counts[k] >= map->keys[k].min_pixels) {
+			mask[k >> 5] |= 1u << (k & 31);
+		}
+	}
+}
+
+/****************************************************************************************
+ * Find the key under a pixel
+****************************************************************************************/
+int key_map_key_at(const KeyMap *map, int x, int y)
+{
+	int k, s;
+
+	for (k = KEY_MAP_KEYS - 1; k >= 0; k--) {
+		const KeyRegion *region = &map->keys[k];
+
+		if (region->min_pixels == 0 || x < region->x0 || x >= region->x1 || y < region->y0 || y >= region->y1) {
+			continue;
+		}
+
+		if (region->num_spans == 0) {
+			return k;
+		}
+
+		for (s = 0; s < region->num_spans; s++) {
+			const KeySpan *span = &map->spans[region->first_span + s];
+
+			if (span->y == y && x >= span->x0 && x < span->x1) {
+				return k;
+			}
+		}
+	}
+
+	return -1;
+}
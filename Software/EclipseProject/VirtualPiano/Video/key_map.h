@@ -0,0 +1,107 @@
+/*
+*********************************************************************************************************
+*
+*                                         KEY MAP HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_map.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Where each of the 88 keys sits in the video-in frame.  A key is either a rectangle or a
+* 				  polygon; polygons are rasterized into row spans when the map is built, so detection
+* 				  only ever walks spans and never tests pixels against edges.  The map is built once
+* 				  at calibration and then read by the detector every frame.  The detector visits only
+* 				  the rows the keyboard covers, flags the bright pixels of each row in one vector pass
+* 				  over the keyboard's width, then adds up the flags under each key on that row, so
+* 				  the cost follows the keyboard area rather than the whole frame.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __KEY_MAP_H__
+#define __KEY_MAP_H__
+
+#include "video.h"
+
+#define KEY_MAP_KEYS 88
+#define KEY_MAP_MASK_WORDS ((KEY_MAP_KEYS + 31) / 32)
+
+// Room for the spans of all polygon keys
+#define KEY_MAP_MAX_SPANS (KEY_MAP_KEYS * 128)
+
+// Vertices in one key polygon
+#define KEY_MAP_MAX_POINTS 16
+
+// Bright pixels inside a key that count as pressed
+#define KEY_MAP_MIN_PIXELS_DEFAULT 8
+
+// One row of a polygon key, x1 exclusive
+typedef struct {
+	short           y;
+	short           x0;
+	short           x1;
+	short           key;
+} KeySpan;
+
+typedef struct {
+	short           x0, y0;			// bounding box, x1 and y1 exclusive
+	short           x1, y1;
+	unsigned short  first_span;
+	unsigned short  num_spans;		// 0 when the key is the whole bounding box
+	unsigned short  min_pixels;		// 0 disables the key
+} KeyRegion;
+
+typedef struct {
+	KeyRegion       keys[KEY_MAP_KEYS];
+	KeySpan         spans[KEY_MAP_MAX_SPANS];
+	int             num_spans;
+	int             threshold;		// r + g + b above this is a bright pixel
+
+	// Derived whenever a key changes
+	unsigned int    area;			// pixels inside keys
+	short           left, top;		// bounds of all enabled keys, right and bottom exclusive
+	short           right, bottom;
+	unsigned short  row_first[VIDEO_IN_FRAME_HEIGHT + 1];	// row y's spans are span_order[row_first[y]..row_first[y + 1]-1]
+	unsigned short  span_order[KEY_MAP_MAX_SPANS];
+} KeyMap;
+
+// Clears the map, every key disabled
+void key_map_init(KeyMap *map);
+
+// Splits the rectangle x0..x1-1, y0..y1-1 into 88 equal width keys
+void key_map_init_uniform(KeyMap *map, int x0, int y0, int x1, int y1);
+
+// Makes a key the rectangle x0..x1-1, y0..y1-1, returns 0 on success
+int key_map_set_rect(KeyMap *map, int key, int x0, int y0, int x1, int y1);
+
+// Makes a key the polygon through points (x, y pairs), returns 0 on success or -1
+// if the span table is full.  Rebuilding a key leaves its old spans in the table
+// unused, so start from key_map_init when recalibrating.
+int key_map_set_polygon(KeyMap *map, int key, const short *points, int num_points);
+
+// Counts the bright pixels in every key and sets bit key in mask for each pressed key
+void key_map_detect(const KeyMap *map, const unsigned char *frame, int frame_stride,
+					unsigned short *key_counts, unsigned int *mask);
+
+// Adds the bright pixels of every key on rows y0 to y1 - 1 into counts, so bands of the frame
+// can be counted apart (on separate threads) and their counts summed
+void key_map_count_rows(const KeyMap *map, const unsigned char *frame, int frame_stride,
+						int y0, int y1, int *counts);
+
+
+// Label written for pixels outside every key
+#define KEY_MAP_NO_KEY 0xFF
+
+// Writes the key of every pixel to labels[y * VIDEO_IN_FRAME_WIDTH + x], KEY_MAP_NO_KEY outside
+// the keys.  Where keys overlap the higher key number wins.
+void key_map_build_labels(const KeyMap *map, unsigned char *labels);
+
+// Sets the pressed bit of every key whose count reaches its min_pixels
+void key_map_counts_to_mask(const KeyMap *map, const int *key_counts, unsigned int *mask);
+
+// Key covering pixel (x, y), or -1.  Where keys overlap the higher key number wins.
+int key_map_key_at(const KeyMap *map, int x, int y);
+
+#endif /* __KEY_MAP_H__ */
@@ -0,0 +1,129 @@
+/*
+*********************************************************************************************************
+*
+*                                           KEY PREVIEW CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_preview.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "video_kernel.h"
+#include "key_preview.h"
+
+/****************************************************************************************
+ * Subroutine to set up the preview
+****************************************************************************************/
+void key_preview_init(KeyPreview *preview)
+{
+	memset(preview, 0, sizeof(*preview));
+	memset(preview->changed, 1, sizeof(preview->changed));
+}
+
+/****************************************************************************************
+ * Subroutine to clear a screen and draw the released keys
+****************************************************************************************/
+void key_preview_clear(unsigned char *screen, const KeyDetector *det)
+{
+	int k;
+
+	VGA_box((volatile unsigned int *)screen, 0, 0, 639, 479, KEY_PREVIEW_BACKGROUND);
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		key_preview_draw_key(screen, det, k, 0, NULL);
+	}
+}
+
+/****************************************************************************************
+ * Subroutine to draw one key of the strip, a polygon key by the columns of its top row,
+ * which keeps calibrated white keys clear of the black keys between them
+****************************************************************************************/
+void key_preview_draw_key(unsigned char *screen, const KeyDetector *det, int key, int pressed,
+						  DirtyRects *dirty)
+{
+	const KeyRegion *region = &det->map.keys[key];
+	int x0 = KEY_PREVIEW_X + region->x0;
+	int x1 = KEY_PREVIEW_X + region->x1 - 1;
+
+	if (region->min_pixels == 0) {
+		return;
+	}
+
+	if (region->num_spans > 0) {
+		x0 = KEY_PREVIEW_X + det->map.spans[region->first_span].x0;
+		x1 = KEY_PREVIEW_X + det->map.spans[region->first_span].x1 - 1;
+	}
+
+	// Leave a one pixel gap to the next key where there is room
+	if (x1 > x0) {
+		x1--;
+	}
+
+	VGA_box((volatile unsigned int *)screen, x0, KEY_PREVIEW_STRIP_TOP, x1, KEY_PREVIEW_STRIP_BOTTOM,
+			pressed ? KEY_PREVIEW_PRESSED : KEY_PREVIEW_RELEASED);
+
+	if (dirty != NULL) {
+		dirty_rect_add(dirty, x0, KEY_PREVIEW_STRIP_TOP, x1 + 1, KEY_PREVIEW_STRIP_BOTTOM + 1);
+	}
+}
+
+/****************************************************************************************
+ * Subroutine to gather the tiles a frame changed
+****************************************************************************************/
+void key_preview_frame(KeyPreview *preview, const KeyDetector *det)
+{
+	int t;
+
+	for (t = 0; t < TILE_COUNT; t++) {
+		preview->changed[t] |= det->tiles.changed[t];
+	}
+}
+
+/****************************************************************************************
+ * Subroutine to draw the changed tiles and keys
+****************************************************************************************/
+void key_preview_draw(KeyPreview *preview, unsigned char *screen, const KeyDetector *det, DirtyRects *dirty)
+{
+	unsigned char *out = screen + (KEY_PREVIEW_Y << 10) + KEY_PREVIEW_X;
+	int top = det->rectified ? 0 : KEY_DETECT_KEYBOARD_TOP;
+	int tx, ty, k;
+
+	// Threshold changed tiles into the preview, setting pixels over the lightness threshold to
+	// RED; a raw frame from the keyboard top down, the rectified strip is keyboard from row 0
+	for (ty = 0; ty < TILE_ROWS; ty++) {
+		int first_row = ty * TILE_SIZE < top ? top : ty * TILE_SIZE;
+
+		for (tx = 0; tx < TILE_COLS; tx++) {
+			if (preview->changed[ty * TILE_COLS + tx] && first_row < (ty + 1) * TILE_SIZE) {
+				video_threshold_rows_lut(det->frame + tx * TILE_SIZE, VIDEO_IN_ROW_STRIDE,
+										 out + tx * TILE_SIZE, VGA_Y, TILE_SIZE, first_row, (ty + 1) * TILE_SIZE,
+										 &det->lut, VIDEO_MARKER_RED, NULL);
+				dirty_rect_add(dirty, KEY_PREVIEW_X + tx * TILE_SIZE, KEY_PREVIEW_Y + first_row,
+							   KEY_PREVIEW_X + (tx + 1) * TILE_SIZE, KEY_PREVIEW_Y + (ty + 1) * TILE_SIZE);
+			}
+		}
+	}
+	memset(preview->changed, 0, sizeof(preview->changed));
+
+	// Redraw the keys that went up or down, or all of them on new key regions
+	if (preview->strip_stale) {
+		VGA_box((volatile unsigned int *)screen, KEY_PREVIEW_X, KEY_PREVIEW_STRIP_TOP,
+				KEY_PREVIEW_X + VIDEO_IN_FRAME_WIDTH - 1, KEY_PREVIEW_STRIP_BOTTOM, KEY_PREVIEW_BACKGROUND);
+		dirty_rect_add(dirty, KEY_PREVIEW_X, KEY_PREVIEW_STRIP_TOP,
+					   KEY_PREVIEW_X + VIDEO_IN_FRAME_WIDTH, KEY_PREVIEW_STRIP_BOTTOM + 1);
+		memset(preview->drawn, 0, sizeof(preview->drawn));
+		for (k = 0; k < KEY_MAP_KEYS; k++) {
+			key_preview_draw_key(screen, det, k, 0, NULL);
+		}
+		preview->strip_stale = 0;
+	}
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		if (((det->state.down[k >> 5] ^ preview->drawn[k >> 5]) >> (k & 31)) & 1) {
+			key_preview_draw_key(screen, det, k, (det->state.down[k >> 5] >> (k & 31)) & 1, dirty);
+		}
+	}
+	memcpy(preview->drawn, det->state.down, sizeof(preview->drawn));
+}
@@ -0,0 +1,65 @@
+/*
+*********************************************************************************************************
+*
+*                                       KEY PREVIEW HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_preview.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Draws a KeyDetector's view into a VGA buffer: the frame it detected on thresholded
+* 				  into the bottom right quadrant, and above it a strip of one box per key, pressed
+* 				  keys in green.  Only the tiles that changed since the last preview and the keys
+* 				  that went up or down are drawn, each added to the caller's dirty rectangles, so
+* 				  KeyDetectTask and the host replay draw the same screen from the same detector.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __KEY_PREVIEW_H__
+#define __KEY_PREVIEW_H__
+
+#include "key_detect.h"
+#include "dirty_rect.h"
+
+// Frames between previews, detection itself runs every frame
+#define KEY_PREVIEW_PERIOD 4
+
+// Preview of the thresholded frame in the bottom right quadrant of the screen
+#define KEY_PREVIEW_X 320
+#define KEY_PREVIEW_Y 240
+
+// Key strip just above the preview
+#define KEY_PREVIEW_STRIP_TOP 226
+#define KEY_PREVIEW_STRIP_BOTTOM 237
+#define KEY_PREVIEW_PRESSED 0x1C
+#define KEY_PREVIEW_RELEASED 0xFF
+
+// Screen behind the preview and strip
+#define KEY_PREVIEW_BACKGROUND 0x03
+
+typedef struct {
+	unsigned char   changed[TILE_COUNT];			// tiles changed since the last preview
+	unsigned int    drawn[KEY_MAP_MASK_WORDS];		// keys drawn pressed
+	int             strip_stale;					// the key regions changed, redraw the whole strip
+} KeyPreview;
+
+// Starts with every tile to draw
+void key_preview_init(KeyPreview *preview);
+
+// Clears a whole screen and draws every key released
+void key_preview_clear(unsigned char *screen, const KeyDetector *det);
+
+// Draws one key of the strip under its columns of the preview, adding its box to dirty if not NULL
+void key_preview_draw_key(unsigned char *screen, const KeyDetector *det, int key, int pressed,
+						  DirtyRects *dirty);
+
+// Gathers the tiles the detector's last frame changed, to call after every key_detect_frame()
+void key_preview_frame(KeyPreview *preview, const KeyDetector *det);
+
+// Draws the gathered tiles of det->frame and the keys that went up or down into screen
+void key_preview_draw(KeyPreview *preview, unsigned char *screen, const KeyDetector *det, DirtyRects *dirty);
+
+#endif /* __KEY_PREVIEW_H__ */
@@ -0,0 +1,144 @@
+/*
+*********************************************************************************************************
+*
+*                                           KEY STATE CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_state.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "bit_mask.h"
+#include "key_state.h"
+
+/****************************************************************************************
+ * Subroutine to reset every key to up
+****************************************************************************************/
+void key_state_init(KeyState *state, int on_pixels, int off_pixels, int on_frames, int off_frames)
+{
+	memset(state, 0, sizeof(*state));
+	state->on_pixels = (unsigned short)on_pixels;
+	state->off_pixels = (unsigned short)(off_pixels < on_pixels ? off_pixels : on_pixels);
+	state->on_frames = (unsigned char)(on_frames > 1 ? on_frames : 1);
+	state->off_frames = (unsigned char)(off_frames > 1 ? off_frames : 1);
+}
+
+/****************************************************************************************
+ * Subroutine to step every key by one frame and queue the transitions
+****************************************************************************************/
+int key_state_update(KeyState *state, const unsigned int *candidates, const unsigned short *key_counts,
+					 unsigned int frame, KeyEventRing *ring)
+{
+	int num_events = 0;
+	int k, w, limit;
+
+	// Hysteresis: a key that is down is held by the lower threshold
+	memset(state->raw, 0, sizeof(state->raw));
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		unsigned int bit = 1u << (k & 31);
+		int down = (state->down[k >> 5] & bit) != 0;
+
+		if (down ? key_counts[k] >= state->off_pixels
+				 : (candidates[k >> 5] & bit) != 0 && key_counts[k] >= state->on_pixels) {
+			state->raw[k >> 5] |= bit;
+		}
+	}
+
+	// Visit only the keys that disagree now or did last frame
+	for (w = 0; w < KEY_MAP_MASK_WORDS; w++) {
+		unsigned int differ = state->raw[w] ^ state->down[w];
+		unsigned int visit = differ | state->pending[w];
+
+		while (visit != 0) {
+			int bit = BIT_MASK_CTZ(visit);
+			unsigned int flag = 1u << bit;
+
+			k = (w << 5) + bit;
+			visit &= visit - 1;
+
+			if (!(differ & flag)) {
+				// Back in agreement before it counted
+				state->run[k] = 0;
+				state->pending[w] &= ~flag;
+				state->chatter++;
+				continue;
+			}
+
+			limit = (state->down[w] & flag) ? state->off_frames : state->on_frames;
+			if (++state->run[k] < limit) {
+				state->pending[w] |= flag;
+				continue;
+			}
+
+			// A full ring leaves the key where it was, due again next frame
+			if (ring != NULL) {
+				KeyEvent event;
+
+				event.frame = frame;
+				event.key = (unsigned char)k;
+				event.down = (state->down[w] & flag) == 0;
+				if (key_event_push(ring, &event) != 0) {
+					state->run[k] = (unsigned char)(limit - 1);
+					state->pending[w] |= flag;
+					continue;
+				}
+			}
+
+			state->run[k] = 0;
+			state->pending[w] &= ~flag;
+			state->down[w] ^= flag;
+			state->events++;
+			num_events++;
+		}
+	}
+
+	state->frames++;
+	return num_events;
+}
+
+/****************************************************************************************
+ * Subroutines for the event ring
+****************************************************************************************/
+void key_event_init(KeyEventRing *ring)
+{
+	ring->head = 0;
+	ring->tail = 0;
+	ring->overflows = 0;
+}
+
+int key_event_push(KeyEventRing *ring, const KeyEvent *event)
+{
+	unsigned int head = ring->head;
+
+	if (head - ring->tail >= KEY_EVENT_RING_SIZE) {
+		ring->overflows++;
+		return -1;
+	}
+
+	ring->events[head & KEY_EVENT_RING_MASK] = *event;
+
+	// Publish the event before the consumer can see the new head
+	KEY_EVENT_BARRIER();
+	ring->head = head + 1;
+	return 0;
+}
+
+int key_event_pop(KeyEventRing *ring, KeyEvent *event)
+{
+	unsigned int tail = ring->tail;
+
+	if (tail == ring->head) {
+		return -1;
+	}
+
+	// Read the event before the producer can see the slot free
+	KEY_EVENT_BARRIER();
+	*event = ring->events[tail & KEY_EVENT_RING_MASK];
+	KEY_EVENT_BARRIER();
+	ring->tail = tail + 1;
+	return 0;
+}
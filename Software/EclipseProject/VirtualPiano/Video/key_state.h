@@ -0,0 +1,100 @@
+/*
+*********************************************************************************************************
+*
+*                                        KEY STATE HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_state.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Turns noisy per-frame key detections into clean note events.  A key that is up goes
+* 				  down in the raw state when a blob is centred on it and it holds on_pixels bright
+* 				  pixels; once down it stays down while it holds off_pixels, so a count wavering around
+* 				  one threshold does not toggle it.  The debounced state follows the raw state only
+* 				  after it has disagreed for on_frames frames in a row (off_frames to come up), and
+* 				  only those transitions are emitted.
+*
+* 				  Both states are packed bitsets.  Each frame the two are XORed a word at a time, so
+* 				  the keys visited are just the ones that disagree now or did last frame.
+*
+* 				  Events go into a single-producer/single-consumer ring, as the audio ring does: the
+* 				  detector only advances head and the scheduler only advances tail, so neither locks.
+* 				  A key only changes state once its event is in the ring; while the ring is full it
+* 				  stays pending and pushes again next frame, so a release is late but never lost.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __KEY_STATE_H__
+#define __KEY_STATE_H__
+
+#include "key_map.h"
+
+// Hysteresis and debounce defaults
+#define KEY_STATE_ON_PIXELS_DEFAULT KEY_MAP_MIN_PIXELS_DEFAULT
+#define KEY_STATE_OFF_PIXELS_DEFAULT (KEY_MAP_MIN_PIXELS_DEFAULT / 2)
+#define KEY_STATE_ON_FRAMES_DEFAULT 2
+#define KEY_STATE_OFF_FRAMES_DEFAULT 3
+
+// Ring capacity in events, must be a power of two
+#define KEY_EVENT_RING_SIZE 64
+#define KEY_EVENT_RING_MASK (KEY_EVENT_RING_SIZE - 1)
+
+// Orders the event stores before the index store that publishes them
+#if defined(__ARMCC_VERSION)
+#define KEY_EVENT_BARRIER() __dmb(0xF)
+#else
+#define KEY_EVENT_BARRIER() __sync_synchronize()
+#endif
+
+typedef struct {
+	unsigned int    frame;			// frame the transition was confirmed in
+	unsigned char   key;			// 0 to KEY_MAP_KEYS - 1
+	unsigned char   down;
+} KeyEvent;
+
+typedef struct {
+	KeyEvent        events[KEY_EVENT_RING_SIZE];
+	volatile unsigned int head;		// events pushed, written by the producer only
+	volatile unsigned int tail;		// events popped, written by the consumer only
+	unsigned int    overflows;		// pushes refused by a full ring
+} KeyEventRing;
+
+typedef struct {
+	unsigned short  on_pixels;		// bright pixels to go down
+	unsigned short  off_pixels;		// fewest to stay down
+	unsigned char   on_frames;		// frames the raw state must hold before an event
+	unsigned char   off_frames;
+
+	unsigned int    down[KEY_MAP_MASK_WORDS];		// debounced state
+	unsigned int    raw[KEY_MAP_MASK_WORDS];		// hysteresis state this frame
+	unsigned int    pending[KEY_MAP_MASK_WORDS];	// keys whose raw state disagreed last frame
+	unsigned char   run[KEY_MAP_KEYS];				// frames in a row it has disagreed
+
+	// Statistics
+	unsigned int    frames;
+	unsigned int    events;
+	unsigned int    chatter;		// disagreements that ended before making an event
+} KeyState;
+
+// All keys up, with the given thresholds and frame counts (0 frames means 1)
+void key_state_init(KeyState *state, int on_pixels, int off_pixels, int on_frames, int off_frames);
+
+// Steps every key by one frame.  candidates has the bit of each key a blob is centred on,
+// key_counts the bright pixels in each key.  Transitions are pushed to ring stamped with
+// frame, a key whose push fails keeps its state until a later frame; returns how many.
+int key_state_update(KeyState *state, const unsigned int *candidates, const unsigned short *key_counts,
+					 unsigned int frame, KeyEventRing *ring);
+
+// Empties the ring
+void key_event_init(KeyEventRing *ring);
+
+// Producer side: queues an event, returns -1 if the ring is full
+int key_event_push(KeyEventRing *ring, const KeyEvent *event);
+
+// Consumer side: takes the oldest event, returns -1 if the ring is empty
+int key_event_pop(KeyEventRing *ring, KeyEvent *event);
+
+#endif /* __KEY_STATE_H__ */
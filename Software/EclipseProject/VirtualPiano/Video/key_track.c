@@ -0,0 +1,194 @@
+/*
+*********************************************************************************************************
+*
+*                                            KEY TRACKER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_track.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "bit_mask.h"
+#include "key_track.h"
+
+// Velocity variance of a new track, (pixels / frame)^2
+#define KEY_TRACK_START_VEL_VAR 16.0f
+
+// Starts an axis at a measured position, at rest
+static void axis_start(KeyTrackAxis *axis, float pos, float measure_noise)
+{
+	axis->pos = pos;
+	axis->vel = 0.0f;
+	axis->p00 = measure_noise;
+	axis->p01 = 0.0f;
+	axis->p11 = KEY_TRACK_START_VEL_VAR;
+}
+
+// One frame forward: pos += vel, P = F P F' + Q with Q from white acceleration noise
+static void axis_predict(KeyTrackAxis *axis, float accel_noise)
+{
+	axis->pos += axis->vel;
+	axis->p00 += 2.0f * axis->p01 + axis->p11 + 0.25f * accel_noise;
+	axis->p01 += axis->p11 + 0.5f * accel_noise;
+	axis->p11 += accel_noise;
+}
+
+// Measurement update with a position
+static void axis_correct(KeyTrackAxis *axis, float measured, float measure_noise)
+{
+	float s = axis->p00 + measure_noise;
+	float k0 = axis->p00 / s;
+	float k1 = axis->p01 / s;
+	float innovation = measured - axis->pos;
+
+	axis->pos += k0 * innovation;
+	axis->vel += k1 * innovation;
+	axis->p11 -= k1 * axis->p01;
+	axis->p00 -= k0 * axis->p00;
+	axis->p01 -= k0 * axis->p01;
+}
+
+// Sets the bit of the key under (x, y), if any
+static void predict_key(unsigned int *predicted, const unsigned char *labels, float x, float y)
+{
+	int key;
+
+	if (x < 0.0f || y < 0.0f || x >= VIDEO_IN_FRAME_WIDTH || y >= VIDEO_IN_FRAME_HEIGHT) {
+		return;
+	}
+
+	key = labels[(int)y * VIDEO_IN_FRAME_WIDTH + (int)x];
+	if (key != KEY_MAP_NO_KEY) {
+		predicted[key >> 5] |= 1u << (key & 31);
+	}
+}
+
+/****************************************************************************************
+ * Subroutine to drop every track
+****************************************************************************************/
+void key_track_init(KeyTracker *tracker, float accel_noise, float measure_noise, int lookahead)
+{
+	memset(tracker, 0, sizeof(*tracker));
+	tracker->accel_noise = accel_noise;
+	tracker->measure_noise = measure_noise;
+	tracker->lookahead = lookahead < 0 ? 0 : lookahead;
+}
+
+/****************************************************************************************
+ * Subroutine to step the tracks one frame and predict the keys under them
+****************************************************************************************/
+int key_track_update(KeyTracker *tracker, const BlobLabeller *labeller, const unsigned char *labels)
+{
+	unsigned char paired_track[KEY_TRACK_MAX];
+	unsigned char paired_blob[BLOB_MAX_BLOBS];
+	float gate = KEY_TRACK_GATE * KEY_TRACK_GATE;
+	int num_predicted = 0;
+	int t, b, i, w;
+
+	memset(paired_track, 0, sizeof(paired_track));
+	memset(paired_blob, 0, sizeof(paired_blob));
+
+	for (t = 0; t < KEY_TRACK_MAX; t++) {
+		if (tracker->tracks[t].active) {
+			axis_predict(&tracker->tracks[t].x, tracker->accel_noise);
+			axis_predict(&tracker->tracks[t].y, tracker->accel_noise);
+		}
+	}
+
+	// Pair the nearest track and blob left, until none is within the gate
+	for (;;) {
+		float best = gate;
+		int best_track = -1, best_blob = -1;
+
+		for (t = 0; t < KEY_TRACK_MAX; t++) {
+			const KeyTrack *track = &tracker->tracks[t];
+
+			if (!track->active || paired_track[t]) {
+				continue;
+			}
+
+			for (b = 0; b < labeller->num_blobs; b++) {
+				float dx = labeller->blobs[b].cx - track->x.pos;
+				float dy = labeller->blobs[b].cy - track->y.pos;
+
+				if (!paired_blob[b] && dx * dx + dy * dy < best) {
+					best = dx * dx + dy * dy;
+					best_track = t;
+					best_blob = b;
+				}
+			}
+		}
+
+		if (best_track < 0) {
+			break;
+		}
+
+		paired_track[best_track] = paired_blob[best_blob] = 1;
+		axis_correct(&tracker->tracks[best_track].x, labeller->blobs[best_blob].cx, tracker->measure_noise);
+		axis_correct(&tracker->tracks[best_track].y, labeller->blobs[best_blob].cy, tracker->measure_noise);
+		if (tracker->tracks[best_track].hits < 0xFFFF) {
+			tracker->tracks[best_track].hits++;
+		}
+		tracker->tracks[best_track].misses = 0;
+	}
+
+	// Age the tracks left unpaired
+	for (t = 0; t < KEY_TRACK_MAX; t++) {
+		KeyTrack *track = &tracker->tracks[t];
+
+		if (track->active && !paired_track[t] && ++track->misses >= KEY_TRACK_MISSES) {
+			track->active = 0;
+			tracker->dropped++;
+		}
+	}
+
+	// Blobs left over start tracks, largest first, while there is room
+	for (b = 0, t = 0; b < labeller->num_blobs; b++) {
+		if (paired_blob[b]) {
+			continue;
+		}
+
+		while (t < KEY_TRACK_MAX && tracker->tracks[t].active) {
+			t++;
+		}
+		if (t == KEY_TRACK_MAX) {
+			break;
+		}
+
+		axis_start(&tracker->tracks[t].x, labeller->blobs[b].cx, tracker->measure_noise);
+		axis_start(&tracker->tracks[t].y, labeller->blobs[b].cy, tracker->measure_noise);
+		tracker->tracks[t].id = tracker->next_id++;
+		tracker->tracks[t].hits = 1;
+		tracker->tracks[t].misses = 0;
+		tracker->tracks[t].active = 1;
+		tracker->started++;
+	}
+
+	// Keys along the path of every confirmed, settling track still in view
+	memset(tracker->predicted, 0, sizeof(tracker->predicted));
+	for (t = 0; t < KEY_TRACK_MAX; t++) {
+		const KeyTrack *track = &tracker->tracks[t];
+
+		if (!track->active || track->misses > 0 || track->hits < KEY_TRACK_CONFIRM ||
+			track->x.vel * track->x.vel + track->y.vel * track->y.vel > KEY_TRACK_SETTLE_SPEED * KEY_TRACK_SETTLE_SPEED) {
+			continue;
+		}
+
+		tracker->settled++;
+
+		for (i = 0; i <= tracker->lookahead; i++) {
+			predict_key(tracker->predicted, labels, track->x.pos + i * track->x.vel, track->y.pos + i * track->y.vel);
+		}
+	}
+
+	for (w = 0; w < KEY_MAP_MASK_WORDS; w++) {
+		num_predicted += bit_mask_popcount(tracker->predicted[w]);
+	}
+
+	tracker->frames++;
+	return num_predicted;
+}
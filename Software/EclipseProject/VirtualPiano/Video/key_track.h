@@ -0,0 +1,88 @@
+/*
+*********************************************************************************************************
+*
+*                                        KEY TRACKER HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : key_track.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Follows the bright blobs (fingertips) from frame to frame to guess which keys are about
+* 				  to be pressed, so their notes can be rendered before the press is confirmed.  Each
+* 				  track is a constant-velocity Kalman filter, run as two independent position and
+* 				  velocity filters, one per axis, with the frame as the time step.  Every frame the
+* 				  tracks are predicted forward, each is paired with the nearest blob within the gate,
+* 				  nearest pairs first, and the pairs update their filters.  Unpaired blobs start new
+* 				  tracks; a track unpaired for KEY_TRACK_MISSES frames in a row is dropped.
+*
+* 				  A finger slows down to press, gliding over the keys on its way.  So only a track
+* 				  paired in KEY_TRACK_CONFIRM frames and slower than KEY_TRACK_SETTLE_SPEED predicts,
+* 				  the keys under its path over the next lookahead frames, the key it is over now
+* 				  included, since debouncing holds a press back a frame or two after the finger stops.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __KEY_TRACK_H__
+#define __KEY_TRACK_H__
+
+#include "blob.h"
+
+// Fingertips followed at once
+#define KEY_TRACK_MAX 10
+
+// Furthest a blob may be from a track's prediction to be paired with it, pixels
+#define KEY_TRACK_GATE 16.0f
+
+// Frames a track may go unpaired, and frames it must be paired in before it predicts
+#define KEY_TRACK_MISSES 3
+#define KEY_TRACK_CONFIRM 2
+
+// Fastest a track may move and still predict, pixels / frame
+#define KEY_TRACK_SETTLE_SPEED 1.5f
+
+// Filter defaults: acceleration noise (pixels / frame^2)^2, centroid noise pixels^2, frames ahead
+#define KEY_TRACK_ACCEL_NOISE_DEFAULT 1.0f
+#define KEY_TRACK_MEASURE_NOISE_DEFAULT 2.0f
+#define KEY_TRACK_LOOKAHEAD_DEFAULT 1
+
+// Position and velocity along one axis, with their covariance
+typedef struct {
+	float           pos, vel;
+	float           p00, p01, p11;
+} KeyTrackAxis;
+
+typedef struct {
+	KeyTrackAxis    x, y;
+	unsigned int    id;
+	unsigned short  hits;			// frames paired
+	unsigned char   misses;			// frames unpaired in a row
+	unsigned char   active;
+} KeyTrack;
+
+typedef struct {
+	KeyTrack        tracks[KEY_TRACK_MAX];
+	float           accel_noise;
+	float           measure_noise;
+	int             lookahead;
+	unsigned int    next_id;
+
+	unsigned int    predicted[KEY_MAP_MASK_WORDS];	// keys under a confirmed track's path
+
+	// Statistics since key_track_init
+	unsigned int    frames;
+	unsigned int    settled;		// track frames that predicted
+	unsigned int    started;
+	unsigned int    dropped;
+} KeyTracker;
+
+// No tracks, with the given noise and lookahead in frames
+void key_track_init(KeyTracker *tracker, float accel_noise, float measure_noise, int lookahead);
+
+// Steps every track by one frame against the labeller's blobs and sets predicted from a
+// key_map_build_labels() table, returns the number of keys predicted
+int key_track_update(KeyTracker *tracker, const BlobLabeller *labeller, const unsigned char *labels);
+
+#endif /* __KEY_TRACK_H__ */
@@ -0,0 +1,86 @@
+/*
+*********************************************************************************************************
+*
+*                                         PIXEL LOOKUP TABLE CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : pixel_lut.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The arithmetic below is kept step for step the same as image_proc.py, in double
+* 				  precision, so the bright flags agree with the Python reference on every pixel value
+* 				  and not just most of them.
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "pixel_lut.h"
+
+/****************************************************************************************
+ * Widen an RGB332 pixel by bit replication
+****************************************************************************************/
+void pixel_lut_rgb(unsigned char pixel, int *r, int *g, int *b)
+{
+	int r3 = (pixel >> 5) & 0x07;
+	int g3 = (pixel >> 2) & 0x07;
+	int b2 = pixel & 0x03;
+
+	*r = (r3 << 5) | (r3 << 2) | (r3 >> 1);
+	*g = (g3 << 5) | (g3 << 2) | (g3 >> 1);
+	*b = b2 * 0x55;
+}
+
+// rgb2hsl() lightness of an RGB332 pixel
+static double pixel_lightness(int pixel)
+{
+	int r8, g8, b8;
+	double r, g, b, cmax, cmin;
+
+	pixel_lut_rgb((unsigned char)pixel, &r8, &g8, &b8);
+
+	r = r8 / 255.0;
+	g = g8 / 255.0;
+	b = b8 / 255.0;
+
+	cmax = r > g ? (r > b ? r : b) : (g > b ? g : b);
+	cmin = r < g ? (r < b ? r : b) : (g < b ? g : b);
+
+	return (cmax + cmin) / 2;
+}
+
+/****************************************************************************************
+ * Build the table
+****************************************************************************************/
+void pixel_lut_init(PixelLut *lut, double threshold)
+{
+	int pixel;
+
+	for (pixel = 0; pixel < PIXEL_LUT_SIZE; pixel++) {
+		int r, g, b;
+
+		pixel_lut_rgb((unsigned char)pixel, &r, &g, &b);
+
+		lut->lightness[pixel] = (unsigned char)(pixel_lightness(pixel) * 255.0 + 0.5);
+		lut->gray[pixel] = (unsigned char)(int)(PIXEL_LUT_GRAY_R * r + PIXEL_LUT_GRAY_G * g + PIXEL_LUT_GRAY_B * b);
+	}
+
+	pixel_lut_set_threshold(lut, threshold);
+}
+
+/****************************************************************************************
+ * Rebuild the bright flags
+****************************************************************************************/
+void pixel_lut_set_threshold(PixelLut *lut, double threshold)
+{
+	int pixel;
+
+	lut->threshold = threshold;
+	memset(lut->bright_bits, 0, sizeof(lut->bright_bits));
+
+	for (pixel = 0; pixel < PIXEL_LUT_SIZE; pixel++) {
+		lut->bright[pixel] = pixel_lightness(pixel) > threshold;
+		lut->bright_bits[pixel >> 3] |= (unsigned char)(lut->bright[pixel] << (pixel & 7));
+	}
+}
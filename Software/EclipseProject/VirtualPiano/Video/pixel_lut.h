@@ -0,0 +1,58 @@
+/*
+*********************************************************************************************************
+*
+*                                       PIXEL LOOKUP TABLE HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : pixel_lut.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Video-in pixels are 8-bit RGB332, so every colour the decoder can produce fits in a 256
+* 				  entry table.  The table holds the HSL lightness and grayscale value of each colour,
+* 				  computed exactly as rgb2hsl() and rgb2gs() in ImageProcessing/image_proc.py do, and
+* 				  the bright flag highlight_bright_points() would give it.  Classifying a pixel is then
+* 				  a single byte load.  The 3 and 2 bit channels are widened to 8 bits by bit replication
+* 				  (7 -> 255, 3 -> 255), which is how the VGA DAC shows them.  Changing the threshold
+* 				  rebuilds only the bright flags.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __PIXEL_LUT_H__
+#define __PIXEL_LUT_H__
+
+#define PIXEL_LUT_SIZE 256
+
+// Lightness a pixel must exceed to be bright (image_proc.py threshold)
+#define PIXEL_LUT_THRESHOLD_DEFAULT 0.95
+
+// rgb2gs() luma weights, also used by video_grey()
+#define PIXEL_LUT_GRAY_R 0.2126
+#define PIXEL_LUT_GRAY_G 0.7152
+#define PIXEL_LUT_GRAY_B 0.0722
+
+typedef struct {
+	unsigned char   lightness[PIXEL_LUT_SIZE];	// HSL lightness scaled to 0 to 255
+	unsigned char   gray[PIXEL_LUT_SIZE];		// rgb2gs()
+	unsigned char   bright[PIXEL_LUT_SIZE];		// 1 when lightness is above threshold
+	unsigned char   bright_bits[PIXEL_LUT_SIZE / 8];	// bright as a bitset, for table lookups in vector code
+	double          threshold;
+} PixelLut;
+
+// Classify a pixel
+#define PIXEL_LUT_BRIGHT(lut, pixel) ((lut)->bright[(unsigned char)(pixel)])
+#define PIXEL_LUT_GRAY(lut, pixel) ((lut)->gray[(unsigned char)(pixel)])
+#define PIXEL_LUT_LIGHTNESS(lut, pixel) ((lut)->lightness[(unsigned char)(pixel)])
+
+// Widens an RGB332 pixel to 8-bit channels
+void pixel_lut_rgb(unsigned char pixel, int *r, int *g, int *b);
+
+// Builds the whole table
+void pixel_lut_init(PixelLut *lut, double threshold);
+
+// Rebuilds the bright flags for a new lightness threshold
+void pixel_lut_set_threshold(PixelLut *lut, double threshold);
+
+#endif /* __PIXEL_LUT_H__ */
@@ -0,0 +1,246 @@
+/*
+*********************************************************************************************************
+*
+*                                              PYRAMID CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : pyramid.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "video_kernel.h"
+#include "pyramid.h"
+
+/****************************************************************************************
+ * Subroutine to take the hot threshold from a lookup table
+****************************************************************************************/
+void pyramid_init(Pyramid *pyramid, const PixelLut *lut)
+{
+	int least = 18;
+	int p;
+
+	memset(pyramid, 0, sizeof(*pyramid));
+
+	// Dimmest colour the table calls bright, 18 (nothing hot) if there is none
+	for (p = 0; p < PIXEL_LUT_SIZE; p++) {
+		int sum = ((p >> 5) & 0x07) + ((p >> 2) & 0x07) + (p & 0x03);
+
+		if (PIXEL_LUT_BRIGHT(lut, p) && sum < least) {
+			least = sum;
+		}
+	}
+
+	pyramid->threshold = least - 1;
+}
+
+/****************************************************************************************
+ * Subroutine to switch the hot test to per-pixel limits
+****************************************************************************************/
+void pyramid_use_limits(Pyramid *pyramid, const unsigned char *limits)
+{
+	pyramid->limits = limits;
+}
+
+/****************************************************************************************
+ * Subroutine to reduce a window of a frame and find its hot pixels
+****************************************************************************************/
+int pyramid_build(Pyramid *pyramid, const unsigned char *frame, int frame_stride, int x0, int y0, int x1, int y1)
+{
+	int cx0 = x0 >> 1, cx1 = (x1 + 1) >> 1;
+	int cy0 = y0 >> 1, cy1 = (y1 + 1) >> 1;
+	int cy;
+
+	memset(pyramid->hot, 0, sizeof(pyramid->hot));
+	pyramid->num_hot_rows = 0;
+	pyramid->cx0 = (short)cx0;
+	pyramid->cy0 = (short)cy0;
+	pyramid->cx1 = (short)(cx1 > cx0 ? cx1 : cx0);
+	pyramid->cy1 = (short)cy1;
+	pyramid->x0 = (short)x1;
+	pyramid->y0 = (short)y1;
+	pyramid->x1 = (short)x0;
+	pyramid->y1 = (short)y0;
+	pyramid->frames++;
+
+	if (cx1 <= cx0) {
+		pyramid->idle_frames++;
+		return 0;
+	}
+
+	for (cy = cy0; cy < cy1; cy++) {
+		const unsigned char *row = frame + 2 * cy * frame_stride + 2 * cx0;
+		unsigned char *level1 = pyramid->level1 + cy * PYRAMID_WIDTH;
+		const unsigned char *limits = pyramid->limits;
+		int first = cx0, last = cx1 - 1;
+		int largest = video_brightness_2x2(row, row + frame_stride, cx1 - cx0, level1 + cx0);
+
+		// Only a row with a hot pixel is searched
+		if (pyramid->limits == NULL) {
+			if (largest <= pyramid->threshold) {
+				continue;
+			}
+
+			while (level1[first] <= pyramid->threshold) {
+				first++;
+			}
+			while (level1[last] <= pyramid->threshold) {
+				last--;
+			}
+		}
+		else {
+			limits += cy * PYRAMID_WIDTH;
+			if (!video_any_above(level1 + cx0, limits + cx0, cx1 - cx0)) {
+				continue;
+			}
+
+			while (level1[first] <= limits[first]) {
+				first++;
+			}
+			while (level1[last] <= limits[last]) {
+				last--;
+			}
+		}
+
+		pyramid->hot[cy].w0 = (unsigned char)((2 * first) >> 5);
+		pyramid->hot[cy].w1 = (unsigned char)(((2 * last + 1) >> 5) + 1);
+		pyramid->num_hot_rows++;
+
+		// Hot bounds, clipped to the window
+		if (2 * first < pyramid->x0) {
+			pyramid->x0 = (short)(2 * first > x0 ? 2 * first : x0);
+		}
+		if (2 * last + 2 > pyramid->x1) {
+			pyramid->x1 = (short)(2 * last + 2 < x1 ? 2 * last + 2 : x1);
+		}
+		if (pyramid->num_hot_rows == 1) {
+			pyramid->y0 = (short)(2 * cy > y0 ? 2 * cy : y0);
+		}
+		pyramid->y1 = (short)(2 * cy + 2 < y1 ? 2 * cy + 2 : y1);
+	}
+
+	if (pyramid->num_hot_rows == 0) {
+		pyramid->idle_frames++;
+	}
+
+	return pyramid->num_hot_rows;
+}
+
+// Packs pixels x0..x0+count-1 of row y lit against the limits of their blocks, count a multiple of 32
+static void limit_bits(const unsigned char *row, const unsigned char *limits, int x0, int count, unsigned int *bits)
+{
+	int x, i;
+
+	for (x = x0; x < x0 + count; x += 32) {
+		unsigned int word = 0;
+
+		for (i = 0; i < 32; i++) {
+			int pixel = row[x + i];
+			int sum = ((pixel >> 5) & 0x07) + ((pixel >> 2) & 0x07) + (pixel & 0x03);
+
+			word |= (unsigned int)(sum > limits[(x + i) >> 1]) << i;
+		}
+
+		*bits++ = word;
+	}
+}
+
+// Mask words of level 1 row cy under a changed tile, one bit per word
+static unsigned int changed_words(const unsigned char *changed, int cy)
+{
+	const unsigned char *tiles;
+	unsigned int words = 0;
+	int w;
+
+	if (changed == NULL) {
+		return ~0u;
+	}
+
+	tiles = changed + (2 * cy / TILE_SIZE) * TILE_COLS;
+	for (w = 0; w < BIT_MASK_ROW_WORDS; w++) {
+		if (tiles[2 * w] || tiles[2 * w + 1]) {
+			words |= 1u << w;
+		}
+	}
+
+	return words;
+}
+
+/****************************************************************************************
+ * Subroutine to pack the full resolution mask words under the hot pixels
+****************************************************************************************/
+void pyramid_refine(Pyramid *pyramid, BitMask *mask, const unsigned char *frame, int frame_stride, const PixelLut *lut)
+{
+	pyramid_refine_tiles(pyramid, mask, frame, frame_stride, lut, NULL);
+}
+
+/****************************************************************************************
+ * Subroutine to pack the mask words under the hot pixels of the changed tiles
+****************************************************************************************/
+void pyramid_refine_tiles(Pyramid *pyramid, BitMask *mask, const unsigned char *frame, int frame_stride,
+						  const PixelLut *lut, const unsigned char *changed)
+{
+	int cy, y, w, w1;
+
+	for (cy = 0; cy < PYRAMID_HEIGHT; cy++) {
+		PyramidSpan *packed = &pyramid->packed[cy];
+		const PyramidSpan *hot = &pyramid->hot[cy];
+		unsigned int fresh;
+		int kept = 0;
+
+		if (packed->w1 == 0 && hot->w1 == 0) {
+			continue;
+		}
+		fresh = changed_words(changed, cy);
+
+		// Clear what was packed under the changed tiles, the rest of the row keeps its words
+		for (w = packed->w0; w < packed->w1; w++) {
+			if (!(fresh & (1u << w))) {
+				kept = 1;
+				continue;
+			}
+			for (y = 2 * cy; y < 2 * cy + 2; y++) {
+				mask->bits[y * BIT_MASK_ROW_WORDS + w] = 0;
+			}
+		}
+
+		// Pack the hot words under the changed tiles, a run at a time
+		for (w = hot->w0; w < hot->w1; w = w1) {
+			for (; w < hot->w1 && !(fresh & (1u << w)); w++) {
+			}
+			for (w1 = w; w1 < hot->w1 && (fresh & (1u << w1)); w1++) {
+			}
+			if (w1 == w) {
+				break;
+			}
+
+			for (y = 2 * cy; y < 2 * cy + 2; y++) {
+				if (pyramid->limits != NULL) {
+					limit_bits(frame + y * frame_stride, pyramid->limits + cy * PYRAMID_WIDTH,
+							   w << 5, (w1 - w) << 5, &mask->bits[y * BIT_MASK_ROW_WORDS + w]);
+				}
+				else {
+					video_bright_bits_lut(frame + y * frame_stride + (w << 5), (w1 - w) << 5, lut,
+										  &mask->bits[y * BIT_MASK_ROW_WORDS + w]);
+				}
+			}
+			pyramid->words_packed += 2 * (w1 - w);
+		}
+
+		// Kept words may still hold bits, so they stay in the span to clear
+		if (!kept) {
+			*packed = *hot;
+		}
+		else if (hot->w1 != 0) {
+			if (hot->w0 < packed->w0) {
+				packed->w0 = hot->w0;
+			}
+			if (hot->w1 > packed->w1) {
+				packed->w1 = hot->w1;
+			}
+		}
+	}
+}
@@ -0,0 +1,88 @@
+/*
+*********************************************************************************************************
+*
+*                                           PYRAMID HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : pyramid.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Coarse-to-fine search for the bright pixels over the keyboard.  Level 1 of the pyramid
+* 				  is the frame reduced 2x2 to 160x120, each pixel the largest r + g + b of the four it
+* 				  covers, built 16 outputs per step by video_brightness_2x2().  A level 1 pixel above
+* 				  the threshold is hot: one of its four may be bright.  The threshold is one below the
+* 				  smallest r + g + b of any colour the PixelLut calls bright, so the coarse test never
+* 				  misses a bright pixel whatever the table's threshold.
+*
+* 				  pyramid_refine() then packs full resolution bits only into the mask words under hot
+* 				  pixels, two rows per level 1 row, after clearing the words it packed last time.
+* 				  Every other word of the mask stays 0, so inside the window the mask reads the same
+* 				  as after bit_mask_build() and blobs and key scores come out identical.  A frame with
+* 				  nothing lit costs the reduction alone, about a quarter of the full pass.
+*
+* 				  pyramid_refine_tiles() repacks only the words under the tiles tile_change_detect()
+* 				  marked, and leaves the words of still tiles as they were packed before.
+*
+* 				  With per-pixel limits from a Background in place of the threshold, a level 1 pixel
+* 				  is hot above its own limit and a full resolution pixel is lit above the limit of its
+* 				  block, so the two levels still agree and the lookup table is not used.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __PYRAMID_H__
+#define __PYRAMID_H__
+
+#include "bit_mask.h"
+#include "tile_change.h"
+
+#define PYRAMID_WIDTH (VIDEO_IN_FRAME_WIDTH / 2)
+#define PYRAMID_HEIGHT (VIDEO_IN_FRAME_HEIGHT / 2)
+
+// Mask words w0..w1-1 of one row pair, empty when w1 is 0
+typedef struct {
+	unsigned char   w0, w1;
+} PyramidSpan;
+
+typedef struct {
+	unsigned char   level1[PYRAMID_HEIGHT * PYRAMID_WIDTH];
+	int             threshold;		// level 1 pixels above this are hot
+	const unsigned char *limits;	// or above these, PYRAMID_WIDTH per row, when not NULL
+	short           cx0, cy0;		// level 1 window of the last build, cx1 and cy1 exclusive
+	short           cx1, cy1;
+
+	PyramidSpan     hot[PYRAMID_HEIGHT];		// words under the hot pixels of each level 1 row
+	PyramidSpan     packed[PYRAMID_HEIGHT];		// words pyramid_refine() may have left bits in
+	int             num_hot_rows;
+	short           x0, y0;			// bounds of the hot pixels within the window, full resolution,
+	short           x1, y1;			// x1 and y1 exclusive
+
+	// Statistics since pyramid_init
+	unsigned int    frames;
+	unsigned int    idle_frames;	// frames with no hot pixel
+	unsigned int    words_packed;
+} Pyramid;
+
+// Takes the hot threshold from lut, nothing packed yet
+void pyramid_init(Pyramid *pyramid, const PixelLut *lut);
+
+// Tests level 1 pixel (x, y) against limits[y * PYRAMID_WIDTH + x] from now on, or against the
+// threshold again when limits is NULL
+void pyramid_use_limits(Pyramid *pyramid, const unsigned char *limits);
+
+// Reduces columns x0..x1-1 and rows y0..y1-1 of a frame into level 1 and finds the hot pixels,
+// returns the number of level 1 rows holding one
+int pyramid_build(Pyramid *pyramid, const unsigned char *frame, int frame_stride, int x0, int y0, int x1, int y1);
+
+// Clears the words packed last time and packs the bright test of the words under the hot pixels,
+// taken from lut or from the limits
+void pyramid_refine(Pyramid *pyramid, BitMask *mask, const unsigned char *frame, int frame_stride, const PixelLut *lut);
+
+// pyramid_refine() over the words under the tiles marked in changed, TILE_COUNT flags by row,
+// all of them when changed is NULL; the other words keep what they were last packed with
+void pyramid_refine_tiles(Pyramid *pyramid, BitMask *mask, const unsigned char *frame, int frame_stride,
+						  const PixelLut *lut, const unsigned char *changed);
+
+#endif /* __PYRAMID_H__ */
@@ -0,0 +1,169 @@
+/*
+*********************************************************************************************************
+*
+*                                              REMAP CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : remap.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <math.h>
+#include "remap.h"
+
+// Length of the side from corner a to corner b
+static float side(const short *corners, int a, int b)
+{
+	float dx = (float)(corners[2 * b] - corners[2 * a]);
+	float dy = (float)(corners[2 * b + 1] - corners[2 * a + 1]);
+
+	return sqrtf(dx * dx + dy * dy);
+}
+
+// Strip length along a pair of opposite sides, the longer one rounded up
+static int strip_length(float a, float b, int max)
+{
+	int length = (int)ceilf(a > b ? a : b);
+
+	return length > max ? max : length;
+}
+
+// Homography taking the unit square's corners (0, 0), (1, 0), (1, 1), (0, 1) to the four corners
+static int square_to_quad(const short *corners, float *h)
+{
+	float x0 = corners[0], y0 = corners[1], x1 = corners[2], y1 = corners[3];
+	float x2 = corners[4], y2 = corners[5], x3 = corners[6], y3 = corners[7];
+	float sx = x0 - x1 + x2 - x3;
+	float sy = y0 - y1 + y2 - y3;
+	float g = 0.0f, k = 0.0f;
+
+	// A parallelogram is affine, otherwise solve for the projective terms
+	if (sx != 0.0f || sy != 0.0f) {
+		float dx1 = x1 - x2, dx2 = x3 - x2;
+		float dy1 = y1 - y2, dy2 = y3 - y2;
+		float det = dx1 * dy2 - dx2 * dy1;
+
+		if (det == 0.0f) {
+			return -1;
+		}
+		g = (sx * dy2 - dx2 * sy) / det;
+		k = (dx1 * sy - sx * dy1) / det;
+	}
+
+	h[0] = x1 - x0 + g * x1;
+	h[1] = x3 - x0 + k * x3;
+	h[2] = x0;
+	h[3] = y1 - y0 + g * y1;
+	h[4] = y3 - y0 + k * y3;
+	h[5] = y0;
+	h[6] = g;
+	h[7] = k;
+	h[8] = 1.0f;
+
+	// The denominator is linear, so positive at the corners means positive over the square: the
+	// corners are a convex quadrilateral and none is sent to infinity
+	if (1.0f + g <= 0.0f || 1.0f + k <= 0.0f || 1.0f + g + k <= 0.0f) {
+		return -1;
+	}
+
+	// Top left, top right and bottom left must turn clockwise on screen, y being down
+	if ((x1 - x0) * (y3 - y0) - (y1 - y0) * (x3 - x0) <= 0.0f) {
+		return -1;
+	}
+
+	return 0;
+}
+
+/****************************************************************************************
+ * Subroutine to build the rectified strip's table of frame offsets
+****************************************************************************************/
+int remap_init(Remap *remap, const short *corners, int frame_stride)
+{
+	float top = side(corners, 0, 1), right = side(corners, 1, 2);
+	float bottom = side(corners, 3, 2), left = side(corners, 0, 3);
+	unsigned int *offsets = remap->offsets;
+	int u, v;
+
+	remap->width = remap->height = 0;
+	remap->frames = 0;
+
+	if (top < REMAP_MIN_SIDE || right < REMAP_MIN_SIDE || bottom < REMAP_MIN_SIDE || left < REMAP_MIN_SIDE ||
+		square_to_quad(corners, remap->h) != 0) {
+		return -1;
+	}
+
+	remap->width = strip_length(top, bottom, REMAP_MAX_WIDTH);
+	remap->height = strip_length(left, right, REMAP_MAX_HEIGHT);
+
+	// Nearest frame pixel to every strip pixel's centre, clamped into the frame
+	for (v = 0; v < remap->height; v++) {
+		for (u = 0; u < remap->width; u++) {
+			float x, y;
+			int fx, fy;
+
+			remap_point(remap, u + 0.5f, v + 0.5f, &x, &y);
+			fx = (int)floorf(x);
+			fy = (int)floorf(y);
+			fx = fx < 0 ? 0 : fx >= VIDEO_IN_FRAME_WIDTH ? VIDEO_IN_FRAME_WIDTH - 1 : fx;
+			fy = fy < 0 ? 0 : fy >= VIDEO_IN_FRAME_HEIGHT ? VIDEO_IN_FRAME_HEIGHT - 1 : fy;
+			*offsets++ = (unsigned int)(fy * frame_stride + fx);
+		}
+	}
+
+	return 0;
+}
+
+/****************************************************************************************
+ * Subroutine to map a rectified position into the frame
+****************************************************************************************/
+void remap_point(const Remap *remap, float u, float v, float *x, float *y)
+{
+	const float *h = remap->h;
+	float s = u / remap->width;
+	float t = v / remap->height;
+	float w = h[6] * s + h[7] * t + h[8];
+
+	*x = (h[0] * s + h[1] * t + h[2]) / w;
+	*y = (h[3] * s + h[4] * t + h[5]) / w;
+}
+
+/****************************************************************************************
+ * Subroutine to gather a band of the rectified strip's rows from a frame
+****************************************************************************************/
+void remap_frame_rows(const Remap *remap, const unsigned char *frame, unsigned char *out, int out_stride,
+					  int v0, int v1)
+{
+	const unsigned int *offsets;
+	int u, v;
+
+	v0 = v0 < 0 ? 0 : v0;
+	v1 = v1 > remap->height ? remap->height : v1;
+	offsets = remap->offsets + v0 * remap->width;
+
+	for (v = v0; v < v1; v++) {
+		unsigned char *row = out + v * out_stride;
+
+		for (u = 0; u + 4 <= remap->width; u += 4) {
+			row[u] = frame[offsets[0]];
+			row[u + 1] = frame[offsets[1]];
+			row[u + 2] = frame[offsets[2]];
+			row[u + 3] = frame[offsets[3]];
+			offsets += 4;
+		}
+		for (; u < remap->width; u++) {
+			row[u] = frame[*offsets++];
+		}
+	}
+}
+
+/****************************************************************************************
+ * Subroutine to gather the rectified strip from a frame
+****************************************************************************************/
+void remap_frame(Remap *remap, const unsigned char *frame, unsigned char *out, int out_stride)
+{
+	remap_frame_rows(remap, frame, out, out_stride, 0, remap->height);
+	remap->frames++;
+}
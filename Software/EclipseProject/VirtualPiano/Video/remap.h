@@ -0,0 +1,65 @@
+/*
+*********************************************************************************************************
+*
+*                                          REMAP HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : remap.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Perspective correction of the keyboard.  The camera looks down at the keyboard from
+* 				  in front, so the keyboard is a trapezoid in the frame and key boundaries are slanted.
+* 				  A homography maps the rectified keyboard, a width x height rectangle, onto the
+* 				  keyboard's four corners in the frame, and remap_init() evaluates it once at the
+* 				  centre of every rectified pixel into a table of frame offsets (nearest pixel).
+* 				  remap_frame() is then one table lookup per rectified pixel, so the detector works
+* 				  on a strip whose keys are upright rectangles and its cost per frame is bounded by
+* 				  the rectified area, whatever the camera angle.
+*
+* 				  The strip is written into the top rows of a frame with the video-in row layout, so
+* 				  every later stage reads it like a captured frame; rows below it are never written.
+* 				  Its width and height are the longer of the keyboard's opposite sides in the frame,
+* 				  so no frame column or row is skipped (the one pixel gaps between white keys
+* 				  survive), clamped to REMAP_MAX_WIDTH x REMAP_MAX_HEIGHT.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __REMAP_H__
+#define __REMAP_H__
+
+#include "video.h"
+
+// Largest rectified strip, and the smallest side accepted
+#define REMAP_MAX_WIDTH VIDEO_IN_FRAME_WIDTH
+#define REMAP_MAX_HEIGHT (VIDEO_IN_FRAME_HEIGHT / 2)
+#define REMAP_MIN_SIDE 8
+
+typedef struct {
+	float           h[9];			// unit square to frame pixels, row major, h[8] = 1
+	int             width, height;	// rectified strip
+	unsigned int    offsets[REMAP_MAX_WIDTH * REMAP_MAX_HEIGHT];	// frame offset of each strip pixel, row by row
+
+	// Statistics since remap_init
+	unsigned int    frames;
+} Remap;
+
+// Builds the table for a keyboard with corners x, y top left, top right, bottom right and bottom
+// left in frame pixels (edges, not centres), returns 0 or -1 if the corners are not a convex
+// quadrilateral of at least REMAP_MIN_SIDE pixels a side
+int remap_init(Remap *remap, const short *corners, int frame_stride);
+
+// Frame position of rectified position u, v (0 to width, 0 to height)
+void remap_point(const Remap *remap, float u, float v, float *x, float *y);
+
+// Writes the rectified strip into rows 0 to height - 1 of out
+void remap_frame(Remap *remap, const unsigned char *frame, unsigned char *out, int out_stride);
+
+// Writes rows v0 to v1 - 1 of the strip only, without counting a frame, so bands of the strip can
+// be gathered apart
+void remap_frame_rows(const Remap *remap, const unsigned char *frame, unsigned char *out, int out_stride,
+					  int v0, int v1);
+
+#endif /* __REMAP_H__ */
@@ -0,0 +1,74 @@
+/*
+*********************************************************************************************************
+*
+*                                       TILE CHANGE DETECTION CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : tile_change.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "video_kernel.h"
+#include "tile_change.h"
+
+/****************************************************************************************
+ * Reset the tile state
+****************************************************************************************/
+void tile_change_init(TileChange *tc, unsigned int sad_threshold, unsigned int refresh_period)
+{
+	memset(tc->reference, 0, sizeof(tc->reference));
+	memset(tc->changed, 0, sizeof(tc->changed));
+
+	tc->sad_threshold = sad_threshold;
+	tc->refresh_period = refresh_period ? refresh_period : 1;
+	tc->frame = 0;
+	tc->tiles_changed = 0;
+	tc->tiles_processed = 0;
+	tc->tiles_seen = 0;
+}
+
+/****************************************************************************************
+ * Force a full refresh
+****************************************************************************************/
+void tile_change_invalidate(TileChange *tc)
+{
+	tc->frame = 0;
+}
+
+/****************************************************************************************
+ * Find the changed tiles
+****************************************************************************************/
+int tile_change_detect(TileChange *tc, const unsigned char *frame, int frame_stride)
+{
+	int refresh = tc->frame++ % tc->refresh_period == 0;
+	int tx, ty, y;
+
+	tc->tiles_changed = 0;
+
+	for (ty = 0; ty < TILE_ROWS; ty++) {
+		for (tx = 0; tx < TILE_COLS; tx++) {
+			const unsigned char *src = frame + ty * TILE_SIZE * frame_stride + tx * TILE_SIZE;
+			unsigned char *ref = tc->reference + ty * TILE_SIZE * VIDEO_IN_FRAME_WIDTH + tx * TILE_SIZE;
+			int changed = refresh ||
+				video_block_sad(src, frame_stride, ref, VIDEO_IN_FRAME_WIDTH, TILE_SIZE) > tc->sad_threshold;
+
+			tc->changed[ty * TILE_COLS + tx] = (unsigned char)changed;
+
+			if (changed) {
+				for (y = 0; y < TILE_SIZE; y++) {
+					memcpy(ref + y * VIDEO_IN_FRAME_WIDTH, src + y * frame_stride, TILE_SIZE);
+				}
+				tc->tiles_changed++;
+			}
+		}
+	}
+
+	tc->tiles_processed += tc->tiles_changed;
+	tc->tiles_seen += TILE_COUNT;
+
+	return (int)tc->tiles_changed;
+}
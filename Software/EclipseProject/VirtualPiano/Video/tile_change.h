@@ -0,0 +1,58 @@
+/*
+*********************************************************************************************************
+*
+*                                     TILE CHANGE DETECTION HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : tile_change.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Splits the video-in frame into 16x16 tiles and finds the ones that changed, so only
+* 				  those are processed again.  Each tile is compared with the copy kept the last time
+* 				  it was processed, not with the previous frame, so slow drift still adds up to a
+* 				  change.  Every refresh_period frames all tiles are treated as changed.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __TILE_CHANGE_H__
+#define __TILE_CHANGE_H__
+
+#include "video.h"
+
+#define TILE_SIZE 16
+#define TILE_COLS (VIDEO_IN_FRAME_WIDTH / TILE_SIZE)
+#define TILE_ROWS (VIDEO_IN_FRAME_HEIGHT / TILE_SIZE)
+#define TILE_COUNT (TILE_COLS * TILE_ROWS)
+
+// Default tile SAD that counts as a change, a handful of pixels changing colour
+#define TILE_SAD_THRESHOLD_DEFAULT 128
+
+// Default frames between full refreshes
+#define TILE_REFRESH_PERIOD_DEFAULT 30
+
+typedef struct {
+	unsigned char   reference[VIDEO_IN_FRAME_HEIGHT * VIDEO_IN_FRAME_WIDTH];	// tile contents when last processed
+	unsigned char   changed[TILE_COUNT];
+	unsigned int    sad_threshold;
+	unsigned int    refresh_period;
+	unsigned int    frame;
+
+	// Statistics
+	unsigned int    tiles_changed;					// in the last frame
+	unsigned int    tiles_processed;				// since init
+	unsigned int    tiles_seen;
+} TileChange;
+
+// Forgets every tile, the first frame is a full refresh
+void tile_change_init(TileChange *tc, unsigned int sad_threshold, unsigned int refresh_period);
+
+// Makes the next frame a full refresh
+void tile_change_invalidate(TileChange *tc);
+
+// Marks the tiles of frame that changed, stores them as the new reference and returns how many
+int tile_change_detect(TileChange *tc, const unsigned char *frame, int frame_stride);
+
+#endif /* __TILE_CHANGE_H__ */
@@ -0,0 +1,57 @@
+/*
+*********************************************************************************************************
+*
+*                                        VGA DOUBLE BUFFER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : vga_buffer.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include "vga_buffer.h"
+
+/****************************************************************************************
+ * Subroutine to set up the front and back buffers
+****************************************************************************************/
+void vga_buffer_init(VgaBuffer *vga, void *base,
+					 unsigned char *pixels0, unsigned int address0,
+					 unsigned char *pixels1, unsigned int address1)
+{
+	vga->base = base;
+	vga->pixels[0] = pixels0;
+	vga->pixels[1] = pixels1;
+	vga->address[0] = address0;
+	vga->address[1] = address1;
+	vga->back = 0;
+	vga->swaps = 0;
+	vga->swap_busy = 0;
+}
+
+/****************************************************************************************
+ * Subroutine to request a buffer swap at the next vertical retrace
+****************************************************************************************/
+void vga_buffer_swap(VgaBuffer *vga)
+{
+	// The controller swaps whatever Backbuffer holds, so load it every time
+	alt_write_word((char *)vga->base + VGA_BUFFER_BACK_OFFSET, vga->address[vga->back]);
+	alt_write_word((char *)vga->base + VGA_BUFFER_FRONT_OFFSET, 1);
+
+	vga->back ^= 1;
+	vga->swaps++;
+}
+
+/****************************************************************************************
+ * Subroutine to check for a swap still waiting on the retrace
+****************************************************************************************/
+int vga_buffer_swap_pending(VgaBuffer *vga)
+{
+	if (alt_read_word((char *)vga->base + VGA_BUFFER_STATUS_OFFSET) & VGA_BUFFER_STATUS_SWAP) {
+		vga->swap_busy++;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,71 @@
+/*
+*********************************************************************************************************
+*
+*                                     VGA DOUBLE BUFFER HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : vga_buffer.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Front and back pixel buffers for the Altera University IP "Pixel Buffer DMA Controller".
+* 				  Drawing goes straight into the back buffer, then a swap is requested by writing the
+* 				  controller's Buffer register.  The controller swaps its Buffer and Backbuffer registers
+* 				  at the next vertical retrace and holds the S bit of Status until it has, so the buffer
+* 				  on screen is never written and nothing is copied.  The old front buffer may only be
+* 				  drawn into once the swap is done; vga_buffer_swap_pending() says when.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __VGA_BUFFER_H__
+#define __VGA_BUFFER_H__
+
+#include <hps.h>
+#include <socal.h>
+#include <address_map_arm_brl4.h>
+
+#define FPGA_TO_HPS_LW_ADDR(base)  ((void *) (((char *)  (ALT_LWFPGASLVS_ADDR))+ (base)))
+
+// Pixel Buffer DMA Controller, as the HPS sees it through the lightweight bridge
+#define VGA_BUFFER_CTRL_BASE FPGA_TO_HPS_LW_ADDR(PIXEL_BUF_CTRL_BASE)
+
+// Controller registers
+#define VGA_BUFFER_FRONT_OFFSET 0x00		// writing it requests a swap
+#define VGA_BUFFER_BACK_OFFSET 0x04
+#define VGA_BUFFER_RESOLUTION_OFFSET 0x08
+#define VGA_BUFFER_STATUS_OFFSET 0x0c
+#define VGA_BUFFER_STATUS_SWAP 0x01			// S: swap requested, not yet done
+
+// One 640x480 screen at a row stride of VGA_Y bytes, buffers 512 KB apart in the FPGA SDRAM
+#define VGA_BUFFER_SIZE (1024 * 480)
+#define VGA_BUFFER_0_ADDR SDRAM_BASE
+#define VGA_BUFFER_1_ADDR (VGA_BUFFER_0_ADDR + 0x00080000)
+
+typedef struct {
+	void           *base;			// controller registers
+	unsigned char  *pixels[2];		// the buffers as the CPU sees them
+	unsigned int    address[2];		// and as the controller's DMA sees them
+	int             back;			// buffer being drawn
+
+	// Statistics
+	unsigned int    swaps;
+	unsigned int    swap_busy;		// polls that found a swap still pending
+} VgaBuffer;
+
+// Sets up two buffers, drawing starts in buffer 0 and the screen is unchanged until the first swap
+void vga_buffer_init(VgaBuffer *vga, void *base,
+					 unsigned char *pixels0, unsigned int address0,
+					 unsigned char *pixels1, unsigned int address1);
+
+// The buffer to draw in, as a VGA_* pixel pointer
+#define VGA_BUFFER_BACK(vga) ((volatile unsigned int *)(vga)->pixels[(vga)->back])
+
+// Shows the back buffer from the next retrace and makes the current front buffer the back buffer
+void vga_buffer_swap(VgaBuffer *vga);
+
+// Non-zero while the last swap has not happened; the back buffer is still on screen until then
+int vga_buffer_swap_pending(VgaBuffer *vga);
+
+#endif /* __VGA_BUFFER_H__ */
@@ -24,6 +24,7 @@
 *********************************************************************************************************
 */
 
+#include <string.h>
 #include "../Video/video.h"
 
 /****************************************************************************************
@@ -55,11 +56,11 @@ int  VGA_read_pixel(volatile unsigned int * vga_pixel_ptr, int x, int y){
 
 void VGA_box(volatile unsigned int * vga_pixel_ptr, int x1, int y1, int x2, int y2, short pixel_color)
 {
-	// Buffer Pixel Pointer
-	char *pixel_ptr ;
+	// Buffer Row Pointer
+	char *row_ptr ;
 
-	// Row and Column indexes
-	int row, col;
+	// Row index
+	int row;
 
 	/* check and fix box coordinates to be valid */
 	if (x1 > (VIDEO_IN_WIDTH - 1)) {
@@ -93,16 +94,101 @@ void VGA_box(volatile unsigned int * vga_pixel_ptr, int x1, int y1, int x2, int
 		SWAP(y1, y2);
 	}
 
-	// Cycle through indexes
-	for (row = y1; row <= y2; row++)
-		for (col = x1; col <= x2; ++col)
-		{
-			// Set address of current index
-			pixel_ptr = (char *)vga_pixel_ptr + (row<<10) + col ;
+	// Fill one span per row
+	row_ptr = (char *)vga_pixel_ptr + (y1<<10) + x1 ;
+	for (row = y1; row <= y2; row++) {
+		memset(row_ptr, (unsigned char)pixel_color, x2 - x1 + 1);
+		row_ptr += VGA_Y;
+	}
+}
+
+/****************************************************************************************
+ * Clip a line to the VGA monitor (Cohen-Sutherland), returns 0 if none of it is visible
+****************************************************************************************/
+#define CLIP_LEFT 0x01
+#define CLIP_RIGHT 0x02
+#define CLIP_TOP 0x04
+#define CLIP_BOTTOM 0x08
+
+static int VGA_clip_code(int x, int y)
+{
+	int code = 0;
+
+	if (x < 0) {
+		code |= CLIP_LEFT;
+	}
+	else if (x > VIDEO_IN_WIDTH - 1) {
+		code |= CLIP_RIGHT;
+	}
+	if (y < 0) {
+		code |= CLIP_TOP;
+	}
+	else if (y > VIDEO_IN_HEIGHT - 1) {
+		code |= CLIP_BOTTOM;
+	}
+
+	return code;
+}
+
+// num / den rounded to the nearest integer, for either sign
+static int VGA_round_div(int num, int den)
+{
+	int twice;
+
+	if (den < 0) {
+		num = -num;
+		den = -den;
+	}
+
+	twice = 2 * num + den;
+	return twice >= 0 ? twice / (2 * den) : -((2 * den - 1 - twice) / (2 * den));
+}
+
+static int VGA_clip_line(int *x1, int *y1, int *x2, int *y2)
+{
+	int code1 = VGA_clip_code(*x1, *y1);
+	int code2 = VGA_clip_code(*x2, *y2);
 
-			// Set Pixel Color
-			*(char *)pixel_ptr = pixel_color;
+	while (code1 | code2) {
+		int code, x, y;
+
+		// Both ends beyond the same edge
+		if (code1 & code2) {
+			return 0;
+		}
+
+		// Move the outside end onto the edge it crosses, rounding to the nearest pixel
+		code = code1 ? code1 : code2;
+		if (code & CLIP_TOP) {
+			x = *x1 + VGA_round_div((*x2 - *x1) * (0 - *y1), *y2 - *y1);
+			y = 0;
+		}
+		else if (code & CLIP_BOTTOM) {
+			x = *x1 + VGA_round_div((*x2 - *x1) * (VIDEO_IN_HEIGHT - 1 - *y1), *y2 - *y1);
+			y = VIDEO_IN_HEIGHT - 1;
+		}
+		else if (code & CLIP_LEFT) {
+			y = *y1 + VGA_round_div((*y2 - *y1) * (0 - *x1), *x2 - *x1);
+			x = 0;
+		}
+		else {
+			y = *y1 + VGA_round_div((*y2 - *y1) * (VIDEO_IN_WIDTH - 1 - *x1), *x2 - *x1);
+			x = VIDEO_IN_WIDTH - 1;
 		}
+
+		if (code == code1) {
+			*x1 = x;
+			*y1 = y;
+			code1 = VGA_clip_code(x, y);
+		}
+		else {
+			*x2 = x;
+			*y2 = y;
+			code2 = VGA_clip_code(x, y);
+		}
+	}
+
+	return 1;
 }
 
 // =============================================
@@ -121,30 +207,9 @@ void VGA_line(volatile unsigned int * vga_pixel_ptr, int x1, int y1, int x2, int
     signed int x,y;
 	char *pixel_ptr ;
 
-	/* Check and Fix line coordinates to be valid */
-	if (x1 > (VIDEO_IN_WIDTH - 1)) {
-		x1 = (VIDEO_IN_WIDTH - 1);
-	}
-	if (y1 > (VIDEO_IN_HEIGHT - 1)) {
-		y1 = (VIDEO_IN_HEIGHT - 1);
-	}
-	if (x2 > (VIDEO_IN_WIDTH - 1)) {
-		x2 = (VIDEO_IN_WIDTH - 1);
-	}
-	if (y2 > (VIDEO_IN_HEIGHT - 1)) {
-		y2 = (VIDEO_IN_HEIGHT - 1);
-	}
-	if (x1 < 0) {
-		x1 = 0;
-	}
-	if (y1 < 0) {
-		y1 = 0;
-	}
-	if (x2 < 0) {
-		x2 = 0;
-	}
-	if (y2 < 0) {
-		y2 = 0;
+	/* Clip the line to the screen, keeping its slope */
+	if (!VGA_clip_line(&x1, &y1, &x2, &y2)) {
+		return;
 	}
 
 	// Get current x and y
@@ -43,6 +43,11 @@
 #define VGA_Y 1024
 #define VGA_AREA (VGA_Y * VIDEO_IN_HEIGHT) + VIDEO_IN_WIDTH
 
+// Video-In Frame (RGB332, rows 512 bytes apart)
+#define VIDEO_IN_FRAME_WIDTH 320
+#define VIDEO_IN_FRAME_HEIGHT 240
+#define VIDEO_IN_ROW_STRIDE 512
+
 // VGA Macro
 #define VGA_PIXEL(x,y,color) do{\
 	char  *pixel_ptr ;\
@@ -0,0 +1,942 @@
+/*
+*********************************************************************************************************
+*
+*                                          VIDEO KERNEL CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : video_kernel.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include "video_kernel.h"
+
+#if defined(VIDEO_KERNEL_NEON)
+#include <arm_neon.h>
+#elif defined(VIDEO_KERNEL_SSE2)
+#include <emmintrin.h>
+#endif
+
+// r + g + b of an RGB332 pixel
+#define BRIGHTNESS(pixel) ((((pixel) >> 5) & 0x07) + (((pixel) >> 2) & 0x07) + ((pixel) & 0x03))
+
+// The PixelLut luma weights for the 3, 3 and 2 bit channels, times 255 / 7, 255 / 7 and 255 / 3 in Q8
+#define GREY_Q8(weight, max) ((int)((weight) * 255.0 / (max) * 256.0 + 0.5))
+#define GREY_R GREY_Q8(PIXEL_LUT_GRAY_R, 7)
+#define GREY_G GREY_Q8(PIXEL_LUT_GRAY_G, 7)
+#define GREY_B GREY_Q8(PIXEL_LUT_GRAY_B, 3)
+
+// An 8-bit strength as a grey RGB332 pixel
+#define GREY_PIXEL(value) (((value) & 0xE0) | (((value) >> 3) & 0x1C) | ((value) >> 6))
+
+// Sums past 17 cannot occur, clamping keeps the signed SSE2 compare valid
+static int clamp_threshold(int threshold)
+{
+	if (threshold < 0) {
+		return 0;
+	}
+	if (threshold > 127) {
+		return 127;
+	}
+	return threshold;
+}
+
+// Thresholds pixels first to width - 1 of one row
+static void threshold_span(const unsigned char *src, unsigned char *dst, int first, int width,
+						   int threshold, unsigned char marker, unsigned short *column_counts)
+{
+	int x;
+
+	for (x = first; x < width; x++) {
+		int pixel = src[x];
+		int r = (pixel >> 5) & 0x07;
+		int g = (pixel >> 2) & 0x07;
+		int b = pixel & 0x03;
+
+		if (r + g + b > threshold) {
+			dst[x] = marker;
+			column_counts[x]++;
+		}
+		else {
+			dst[x] = (unsigned char)pixel;
+		}
+	}
+}
+
+/****************************************************************************************
+ * Threshold a block of rows, one pixel at a time
+****************************************************************************************/
+void video_threshold_rows_scalar(const unsigned char *frame, int frame_stride,
+								 unsigned char *out, int out_stride,
+								 int width, int first_row, int last_row,
+								 int threshold, unsigned char marker,
+								 unsigned short *column_counts)
+{
+	int y;
+
+	threshold = clamp_threshold(threshold);
+
+	for (y = first_row; y < last_row; y++) {
+		threshold_span(frame + y * frame_stride, out + y * out_stride, 0, width,
+					   threshold, marker, column_counts);
+	}
+}
+
+/****************************************************************************************
+ * Threshold a block of rows, VIDEO_KERNEL_LANES pixels at a time
+****************************************************************************************/
+void video_threshold_rows(const unsigned char *frame, int frame_stride,
+						  unsigned char *out, int out_stride,
+						  int width, int first_row, int last_row,
+						  int threshold, unsigned char marker,
+						  unsigned short *column_counts)
+{
+	int y, x;
+	int vector_width = width & ~(VIDEO_KERNEL_LANES - 1);
+
+	threshold = clamp_threshold(threshold);
+
+#if defined(VIDEO_KERNEL_NEON)
+	{
+		const uint8x16_t mask3 = vdupq_n_u8(0x03);
+		const uint8x16_t mask7 = vdupq_n_u8(0x07);
+		const uint8x16_t limit = vdupq_n_u8((uint8_t)threshold);
+		const uint8x16_t red = vdupq_n_u8(marker);
+
+		for (y = first_row; y < last_row; y++) {
+			const unsigned char *src = frame + y * frame_stride;
+			unsigned char *dst = out + y * out_stride;
+
+			for (x = 0; x < vector_width; x += VIDEO_KERNEL_LANES) {
+				uint8x16_t pixel = vld1q_u8(src + x);
+				uint8x16_t sum = vaddq_u8(vaddq_u8(vshrq_n_u8(pixel, 5),
+												   vandq_u8(vshrq_n_u8(pixel, 2), mask7)),
+										  vandq_u8(pixel, mask3));
+				uint8x16_t bright = vcgtq_u8(sum, limit);
+				uint8x16_t ones = vshrq_n_u8(bright, 7);
+
+				vst1q_u8(dst + x, vbslq_u8(bright, red, pixel));
+				vst1q_u16(column_counts + x, vaddw_u8(vld1q_u16(column_counts + x), vget_low_u8(ones)));
+				vst1q_u16(column_counts + x + 8, vaddw_u8(vld1q_u16(column_counts + x + 8), vget_high_u8(ones)));
+			}
+
+			threshold_span(src, dst, vector_width, width, threshold, marker, column_counts);
+		}
+	}
+#elif defined(VIDEO_KERNEL_SSE2)
+	{
+		const __m128i mask3 = _mm_set1_epi8(0x03);
+		const __m128i mask7 = _mm_set1_epi8(0x07);
+		const __m128i one = _mm_set1_epi8(0x01);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i limit = _mm_set1_epi8((char)threshold);
+		const __m128i red = _mm_set1_epi8((char)marker);
+
+		for (y = first_row; y < last_row; y++) {
+			const unsigned char *src = frame + y * frame_stride;
+			unsigned char *dst = out + y * out_stride;
+
+			for (x = 0; x < vector_width; x += VIDEO_KERNEL_LANES) {
+				__m128i pixel = _mm_loadu_si128((const __m128i *)(src + x));
+				// No 8-bit shifts in SSE2: shift 16-bit lanes and mask off the neighbour's bits
+				__m128i sum = _mm_add_epi8(_mm_add_epi8(_mm_and_si128(_mm_srli_epi16(pixel, 5), mask7),
+														_mm_and_si128(_mm_srli_epi16(pixel, 2), mask7)),
+										   _mm_and_si128(pixel, mask3));
+				__m128i bright = _mm_cmpgt_epi8(sum, limit);
+				__m128i ones = _mm_and_si128(bright, one);
+				__m128i *counts = (__m128i *)(column_counts + x);
+
+				_mm_storeu_si128((__m128i *)(dst + x),
+								 _mm_or_si128(_mm_and_si128(bright, red), _mm_andnot_si128(bright, pixel)));
+				_mm_storeu_si128(counts, _mm_add_epi16(_mm_loadu_si128(counts), _mm_unpacklo_epi8(ones, zero)));
+				_mm_storeu_si128(counts + 1, _mm_add_epi16(_mm_loadu_si128(counts + 1), _mm_unpackhi_epi8(ones, zero)));
+			}
+
+			threshold_span(src, dst, vector_width, width, threshold, marker, column_counts);
+		}
+	}
+#else
+	(void)x;
+	(void)vector_width;
+
+	for (y = first_row; y < last_row; y++) {
+		threshold_span(frame + y * frame_stride, out + y * out_stride, 0, width,
+					   threshold, marker, column_counts);
+	}
+#endif
+}
+
+/****************************************************************************************
+ * Flag bright pixels in a row, one pixel at a time
+****************************************************************************************/
+void video_bright_flags_scalar(const unsigned char *row, int count, int threshold, unsigned char *flags)
+{
+	int x;
+
+	threshold = clamp_threshold(threshold);
+
+	for (x = 0; x < count; x++) {
+		int pixel = row[x];
+
+		flags[x] = ((pixel >> 5) & 0x07) + ((pixel >> 2) & 0x07) + (pixel & 0x03) > threshold;
+	}
+}
+
+/****************************************************************************************
+ * Flag bright pixels in a row, VIDEO_KERNEL_LANES pixels at a time
+****************************************************************************************/
+void video_bright_flags(const unsigned char *row, int count, int threshold, unsigned char *flags)
+{
+	int x = 0;
+
+	threshold = clamp_threshold(threshold);
+
+#if defined(VIDEO_KERNEL_NEON)
+	{
+		const uint8x16_t mask3 = vdupq_n_u8(0x03);
+		const uint8x16_t mask7 = vdupq_n_u8(0x07);
+		const uint8x16_t limit = vdupq_n_u8((uint8_t)threshold);
+
+		for (; x + VIDEO_KERNEL_LANES <= count; x += VIDEO_KERNEL_LANES) {
+			uint8x16_t pixel = vld1q_u8(row + x);
+			uint8x16_t sum = vaddq_u8(vaddq_u8(vshrq_n_u8(pixel, 5),
+											   vandq_u8(vshrq_n_u8(pixel, 2), mask7)),
+									  vandq_u8(pixel, mask3));
+
+			vst1q_u8(flags + x, vshrq_n_u8(vcgtq_u8(sum, limit), 7));
+		}
+	}
+#elif defined(VIDEO_KERNEL_SSE2)
+	{
+		const __m128i mask3 = _mm_set1_epi8(0x03);
+		const __m128i mask7 = _mm_set1_epi8(0x07);
+		const __m128i one = _mm_set1_epi8(0x01);
+		const __m128i limit = _mm_set1_epi8((char)threshold);
+
+		for (; x + VIDEO_KERNEL_LANES <= count; x += VIDEO_KERNEL_LANES) {
+			__m128i pixel = _mm_loadu_si128((const __m128i *)(row + x));
+			__m128i sum = _mm_add_epi8(_mm_add_epi8(_mm_and_si128(_mm_srli_epi16(pixel, 5), mask7),
+													_mm_and_si128(_mm_srli_epi16(pixel, 2), mask7)),
+									   _mm_and_si128(pixel, mask3));
+
+			_mm_storeu_si128((__m128i *)(flags + x), _mm_and_si128(_mm_cmpgt_epi8(sum, limit), one));
+		}
+	}
+#endif
+
+	video_bright_flags_scalar(row + x, count - x, threshold, flags + x);
+}
+
+/****************************************************************************************
+ * Brightness of a row, one pixel at a time
+****************************************************************************************/
+void video_brightness_scalar(const unsigned char *row, int count, unsigned char *sums)
+{
+	int x;
+
+	for (x = 0; x < count; x++) {
+		int pixel = row[x];
+
+		sums[x] = (unsigned char)(((pixel >> 5) & 0x07) + ((pixel >> 2) & 0x07) + (pixel & 0x03));
+	}
+}
+
+/****************************************************************************************
+ * Brightness of a row, VIDEO_KERNEL_LANES pixels at a time
+****************************************************************************************/
+void video_brightness(const unsigned char *row, int count, unsigned char *sums)
+{
+	int x = 0;
+
+#if defined(VIDEO_KERNEL_NEON)
+	{
+		const uint8x16_t mask3 = vdupq_n_u8(0x03);
+		const uint8x16_t mask7 = vdupq_n_u8(0x07);
+
+		for (; x + VIDEO_KERNEL_LANES <= count; x += VIDEO_KERNEL_LANES) {
+			uint8x16_t pixel = vld1q_u8(row + x);
+
+			vst1q_u8(sums + x, vaddq_u8(vaddq_u8(vshrq_n_u8(pixel, 5),
+												 vandq_u8(vshrq_n_u8(pixel, 2), mask7)),
+										vandq_u8(pixel, mask3)));
+		}
+	}
+#elif defined(VIDEO_KERNEL_SSE2)
+	{
+		const __m128i mask3 = _mm_set1_epi8(0x03);
+		const __m128i mask7 = _mm_set1_epi8(0x07);
+
+		for (; x + VIDEO_KERNEL_LANES <= count; x += VIDEO_KERNEL_LANES) {
+			__m128i pixel = _mm_loadu_si128((const __m128i *)(row + x));
+
+			_mm_storeu_si128((__m128i *)(sums + x),
+							 _mm_add_epi8(_mm_add_epi8(_mm_and_si128(_mm_srli_epi16(pixel, 5), mask7),
+													   _mm_and_si128(_mm_srli_epi16(pixel, 2), mask7)),
+										  _mm_and_si128(pixel, mask3)));
+		}
+	}
+#endif
+
+	video_brightness_scalar(row + x, count - x, sums + x);
+}
+
+/****************************************************************************************
+ * Reduce two rows 2x2 to their brightest pixel, one output at a time
+****************************************************************************************/
+unsigned char video_brightness_2x2_scalar(const unsigned char *row0, const unsigned char *row1, int count, unsigned char *out)
+{
+	int largest = 0;
+	int x;
+
+	for (x = 0; x < count; x++) {
+		int a = BRIGHTNESS(row0[2 * x]), b = BRIGHTNESS(row0[2 * x + 1]);
+		int c = BRIGHTNESS(row1[2 * x]), d = BRIGHTNESS(row1[2 * x + 1]);
+		int value;
+
+		a = a > b ? a : b;
+		c = c > d ? c : d;
+		value = a > c ? a : c;
+
+		out[x] = (unsigned char)value;
+		largest = value > largest ? value : largest;
+	}
+
+	return (unsigned char)largest;
+}
+
+/****************************************************************************************
+ * Reduce two rows 2x2 to their brightest pixel, VIDEO_KERNEL_LANES outputs at a time
+****************************************************************************************/
+unsigned char video_brightness_2x2(const unsigned char *row0, const unsigned char *row1, int count, unsigned char *out)
+{
+	unsigned char largest = 0;
+	int x = 0;
+
+#if defined(VIDEO_KERNEL_NEON)
+	if (count >= VIDEO_KERNEL_LANES) {
+		const uint8x16_t mask3 = vdupq_n_u8(0x03);
+		const uint8x16_t mask7 = vdupq_n_u8(0x07);
+		uint8x16_t total = vdupq_n_u8(0);
+		uint8x8_t half;
+
+		for (; x + VIDEO_KERNEL_LANES <= count; x += VIDEO_KERNEL_LANES) {
+			// Even and odd pixels come out of the loads in separate registers
+			uint8x16x2_t top = vld2q_u8(row0 + 2 * x);
+			uint8x16x2_t bottom = vld2q_u8(row1 + 2 * x);
+			uint8x16_t value = vdupq_n_u8(0);
+			uint8x16_t pixels[4] = { top.val[0], top.val[1], bottom.val[0], bottom.val[1] };
+			int i;
+
+			for (i = 0; i < 4; i++) {
+				value = vmaxq_u8(value, vaddq_u8(vaddq_u8(vshrq_n_u8(pixels[i], 5),
+														  vandq_u8(vshrq_n_u8(pixels[i], 2), mask7)),
+												 vandq_u8(pixels[i], mask3)));
+			}
+
+			vst1q_u8(out + x, value);
+			total = vmaxq_u8(total, value);
+		}
+
+		half = vmax_u8(vget_low_u8(total), vget_high_u8(total));
+		half = vpmax_u8(half, half);
+		half = vpmax_u8(half, half);
+		half = vpmax_u8(half, half);
+		largest = vget_lane_u8(half, 0);
+	}
+#elif defined(VIDEO_KERNEL_SSE2)
+	if (count >= VIDEO_KERNEL_LANES) {
+		const __m128i mask3 = _mm_set1_epi8(0x03);
+		const __m128i mask7 = _mm_set1_epi8(0x07);
+		const __m128i low_byte = _mm_set1_epi16(0x00FF);
+		__m128i total = _mm_setzero_si128();
+
+		for (; x + VIDEO_KERNEL_LANES <= count; x += VIDEO_KERNEL_LANES) {
+			__m128i pixels[4] = {
+				_mm_loadu_si128((const __m128i *)(row0 + 2 * x)),
+				_mm_loadu_si128((const __m128i *)(row0 + 2 * x + VIDEO_KERNEL_LANES)),
+				_mm_loadu_si128((const __m128i *)(row1 + 2 * x)),
+				_mm_loadu_si128((const __m128i *)(row1 + 2 * x + VIDEO_KERNEL_LANES))
+			};
+			__m128i sums[4], left, right;
+			int i;
+
+			for (i = 0; i < 4; i++) {
+				sums[i] = _mm_add_epi8(_mm_add_epi8(_mm_and_si128(_mm_srli_epi16(pixels[i], 5), mask7),
+													_mm_and_si128(_mm_srli_epi16(pixels[i], 2), mask7)),
+									   _mm_and_si128(pixels[i], mask3));
+			}
+
+			// Down, then across the pixel pairs held in each 16-bit lane
+			left = _mm_max_epu8(sums[0], sums[2]);
+			right = _mm_max_epu8(sums[1], sums[3]);
+			left = _mm_max_epi16(_mm_and_si128(left, low_byte), _mm_srli_epi16(left, 8));
+			right = _mm_max_epi16(_mm_and_si128(right, low_byte), _mm_srli_epi16(right, 8));
+			left = _mm_packus_epi16(left, right);
+
+			_mm_storeu_si128((__m128i *)(out + x), left);
+			total = _mm_max_epu8(total, left);
+		}
+
+		total = _mm_max_epu8(total, _mm_srli_si128(total, 8));
+		total = _mm_max_epu8(total, _mm_srli_si128(total, 4));
+		total = _mm_max_epu8(total, _mm_srli_si128(total, 2));
+		total = _mm_max_epu8(total, _mm_srli_si128(total, 1));
+		largest = (unsigned char)_mm_cvtsi128_si32(total);
+	}
+#endif
+
+	if (x < count) {
+		unsigned char tail = video_brightness_2x2_scalar(row0 + 2 * x, row1 + 2 * x, count - x, out + x);
+
+		largest = tail > largest ? tail : largest;
+	}
+
+	return largest;
+}
+
+/****************************************************************************************
+ * Compare values with their limits, one at a time
+****************************************************************************************/
+int video_any_above_scalar(const unsigned char *values, const unsigned char *limits, int count)
+{
+	int x;
+
+	for (x = 0; x < count; x++) {
+		if (values[x] > limits[x]) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/****************************************************************************************
+ * Compare values with their limits, VIDEO_KERNEL_LANES at a time
+****************************************************************************************/
+int video_any_above(const unsigned char *values, const unsigned char *limits, int count)
+{
+	int x = 0;
+
+#if defined(VIDEO_KERNEL_NEON)
+	{
+		uint8x16_t above = vdupq_n_u8(0);
+		uint8x8_t half;
+
+		for (; x + VIDEO_KERNEL_LANES <= count; x += VIDEO_KERNEL_LANES) {
+			above = vorrq_u8(above, vqsubq_u8(vld1q_u8(values + x), vld1q_u8(limits + x)));
+		}
+
+		half = vorr_u8(vget_low_u8(above), vget_high_u8(above));
+		if (vget_lane_u32(vreinterpret_u32_u8(half), 0) | vget_lane_u32(vreinterpret_u32_u8(half), 1)) {
+			return 1;
+		}
+	}
+#elif defined(VIDEO_KERNEL_SSE2)
+	{
+		__m128i above = _mm_setzero_si128();
+
+		for (; x + VIDEO_KERNEL_LANES <= count; x += VIDEO_KERNEL_LANES) {
+			above = _mm_or_si128(above, _mm_subs_epu8(_mm_loadu_si128((const __m128i *)(values + x)),
+													  _mm_loadu_si128((const __m128i *)(limits + x))));
+		}
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(above, _mm_setzero_si128())) != 0xFFFF) {
+			return 1;
+		}
+	}
+#endif
+
+	return video_any_above_scalar(values + x, limits + x, count - x);
+}
+
+/****************************************************************************************
+ * Update running means, one at a time
+****************************************************************************************/
+void video_ema_q8_scalar(unsigned short *means, const unsigned char *samples, int count,
+						 int shift, int hot_shift, int delta, unsigned char *limits)
+{
+	int x;
+
+	for (x = 0; x < count; x++) {
+		int mean = means[x];
+		int diff = (samples[x] << 8) - mean;
+
+		// Arithmetic shifts, as the vector units do: a falling mean reaches the sample
+		mean += diff > delta ? diff >> hot_shift : diff >> shift;
+		means[x] = (unsigned short)mean;
+		limits[x] = (unsigned char)((mean + delta) >> 8);
+	}
+}
+
+/****************************************************************************************
+ * Update running means, 8 at a time
+****************************************************************************************/
+void video_ema_q8(unsigned short *means, const unsigned char *samples, int count,
+				  int shift, int hot_shift, int delta, unsigned char *limits)
+{
+	int x = 0;
+
+#if defined(VIDEO_KERNEL_NEON)
+	{
+		const int16x8_t fast = vdupq_n_s16((int16_t)-shift);
+		const int16x8_t slow = vdupq_n_s16((int16_t)-hot_shift);
+		const int16x8_t margin = vdupq_n_s16((int16_t)delta);
+
+		for (; x + 8 <= count; x += 8) {
+			int16x8_t mean = vreinterpretq_s16_u16(vld1q_u16(means + x));
+			int16x8_t diff = vsubq_s16(vreinterpretq_s16_u16(vshll_n_u8(vld1_u8(samples + x), 8)), mean);
+			uint16x8_t hot = vcgtq_s16(diff, margin);
+
+			mean = vaddq_s16(mean, vbslq_s16(hot, vshlq_s16(diff, slow), vshlq_s16(diff, fast)));
+			vst1q_u16(means + x, vreinterpretq_u16_s16(mean));
+			vst1_u8(limits + x, vqshrun_n_s16(vaddq_s16(mean, margin), 8));
+		}
+	}
+#elif defined(VIDEO_KERNEL_SSE2)
+	{
+		const __m128i fast = _mm_cvtsi32_si128(shift);
+		const __m128i slow = _mm_cvtsi32_si128(hot_shift);
+		const __m128i margin = _mm_set1_epi16((short)delta);
+		const __m128i zero = _mm_setzero_si128();
+
+		for (; x + 8 <= count; x += 8) {
+			__m128i mean = _mm_loadu_si128((const __m128i *)(means + x));
+			__m128i sample = _mm_unpacklo_epi8(zero, _mm_loadl_epi64((const __m128i *)(samples + x)));
+			__m128i diff = _mm_sub_epi16(sample, mean);
+			__m128i hot = _mm_cmpgt_epi16(diff, margin);
+
+			mean = _mm_add_epi16(mean, _mm_or_si128(_mm_and_si128(hot, _mm_sra_epi16(diff, slow)),
+													_mm_andnot_si128(hot, _mm_sra_epi16(diff, fast))));
+			_mm_storeu_si128((__m128i *)(means + x), mean);
+			_mm_storel_epi64((__m128i *)(limits + x),
+							 _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(mean, margin), 8), zero));
+		}
+	}
+#endif
+
+	video_ema_q8_scalar(means + x, samples + x, count - x, shift, hot_shift, delta, limits + x);
+}
+
+/****************************************************************************************
+ * SAD of a 16 pixel wide block, one pixel at a time
+****************************************************************************************/
+unsigned int video_block_sad_scalar(const unsigned char *a, int a_stride, const unsigned char *b, int b_stride, int rows)
+{
+	unsigned int sad = 0;
+	int x, y;
+
+	for (y = 0; y < rows; y++) {
+		for (x = 0; x < VIDEO_KERNEL_LANES; x++) {
+			int d = a[y * a_stride + x] - b[y * b_stride + x];
+
+			sad += d < 0 ? -d : d;
+		}
+	}
+
+	return sad;
+}
+
+/****************************************************************************************
+ * SAD of a 16 pixel wide block, a row per step
+****************************************************************************************/
+unsigned int video_block_sad(const unsigned char *a, int a_stride, const unsigned char *b, int b_stride, int rows)
+{
+#if defined(VIDEO_KERNEL_NEON)
+	// 16-bit lane totals hold 128 rows of 2 * 255
+	uint16x8_t total = vdupq_n_u16(0);
+	uint64x2_t wide;
+	int y;
+
+	for (y = 0; y < rows; y++) {
+		total = vpadalq_u8(total, vabdq_u8(vld1q_u8(a + y * a_stride), vld1q_u8(b + y * b_stride)));
+	}
+
+	wide = vpaddlq_u32(vpaddlq_u16(total));
+	return (unsigned int)(vgetq_lane_u64(wide, 0) + vgetq_lane_u64(wide, 1));
+#elif defined(VIDEO_KERNEL_SSE2)
+	__m128i total = _mm_setzero_si128();
+	int y;
+
+	for (y = 0; y < rows; y++) {
+		total = _mm_add_epi64(total, _mm_sad_epu8(_mm_loadu_si128((const __m128i *)(a + y * a_stride)),
+												  _mm_loadu_si128((const __m128i *)(b + y * b_stride))));
+	}
+
+	return (unsigned int)(_mm_cvtsi128_si32(total) + _mm_cvtsi128_si32(_mm_srli_si128(total, 8)));
+#else
+	return video_block_sad_scalar(a, a_stride, b, b_stride, rows);
+#endif
+}
+
+#if defined(VIDEO_KERNEL_NEON)
+// Bright mask (0xFF or 0x00) of 8 pixels from the lookup table's bitset
+static uint8x8_t lut_bright8(uint8x8x4_t bits, uint8x8_t pixel)
+{
+	uint8x8_t byte = vtbl4_u8(bits, vshr_n_u8(pixel, 3));
+	uint8x8_t bit = vshl_u8(vdup_n_u8(1), vreinterpret_s8_u8(vand_u8(pixel, vdup_n_u8(0x07))));
+
+	return vtst_u8(byte, bit);
+}
+
+static uint8x8x4_t lut_bits(const PixelLut *lut)
+{
+	uint8x8x4_t bits;
+
+	bits.val[0] = vld1_u8(lut->bright_bits);
+	bits.val[1] = vld1_u8(lut->bright_bits + 8);
+	bits.val[2] = vld1_u8(lut->bright_bits + 16);
+	bits.val[3] = vld1_u8(lut->bright_bits + 24);
+	return bits;
+}
+#endif
+
+/****************************************************************************************
+ * Flag bright pixels in a row using a lookup table
+****************************************************************************************/
+void video_bright_flags_lut(const unsigned char *row, int count, const PixelLut *lut, unsigned char *flags)
+{
+	int x = 0;
+
+#if defined(VIDEO_KERNEL_NEON)
+	{
+		const uint8x8x4_t bits = lut_bits(lut);
+
+		for (; x + VIDEO_KERNEL_LANES <= count; x += VIDEO_KERNEL_LANES) {
+			uint8x16_t pixel = vld1q_u8(row + x);
+			uint8x16_t bright = vcombine_u8(lut_bright8(bits, vget_low_u8(pixel)),
+											lut_bright8(bits, vget_high_u8(pixel)));
+
+			vst1q_u8(flags + x, vshrq_n_u8(bright, 7));
+		}
+	}
+#endif
+
+	for (; x < count; x++) {
+		flags[x] = PIXEL_LUT_BRIGHT(lut, row[x]);
+	}
+}
+
+/****************************************************************************************
+ * Threshold a block of rows using a lookup table
+****************************************************************************************/
+void video_threshold_rows_lut(const unsigned char *frame, int frame_stride,
+							  unsigned char *out, int out_stride,
+							  int width, int first_row, int last_row,
+							  const PixelLut *lut, unsigned char marker,
+							  unsigned short *column_counts)
+{
+	int x, y;
+
+#if defined(VIDEO_KERNEL_NEON)
+	const uint8x8x4_t bits = lut_bits(lut);
+	const uint8x16_t red = vdupq_n_u8(marker);
+	int vector_width = width & ~(VIDEO_KERNEL_LANES - 1);
+#else
+	int vector_width = 0;
+#endif
+
+	for (y = first_row; y < last_row; y++) {
+		const unsigned char *src = frame + y * frame_stride;
+		unsigned char *dst = out + y * out_stride;
+
+#if defined(VIDEO_KERNEL_NEON)
+		for (x = 0; x < vector_width; x += VIDEO_KERNEL_LANES) {
+			uint8x16_t pixel = vld1q_u8(src + x);
+			uint8x16_t bright = vcombine_u8(lut_bright8(bits, vget_low_u8(pixel)),
+											lut_bright8(bits, vget_high_u8(pixel)));
+			uint8x16_t ones = vshrq_n_u8(bright, 7);
+
+			vst1q_u8(dst + x, vbslq_u8(bright, red, pixel));
+			if (column_counts != NULL) {
+				vst1q_u16(column_counts + x, vaddw_u8(vld1q_u16(column_counts + x), vget_low_u8(ones)));
+				vst1q_u16(column_counts + x + 8, vaddw_u8(vld1q_u16(column_counts + x + 8), vget_high_u8(ones)));
+			}
+		}
+#endif
+
+		for (x = vector_width; x < width; x++) {
+			unsigned char pixel = src[x];
+
+			if (PIXEL_LUT_BRIGHT(lut, pixel)) {
+				dst[x] = marker;
+				if (column_counts != NULL) {
+					column_counts[x]++;
+				}
+			}
+			else {
+				dst[x] = pixel;
+			}
+		}
+	}
+}
+
+/****************************************************************************************
+ * Pack the bright pixels of a row into bits using a lookup table
+****************************************************************************************/
+void video_bright_bits_lut(const unsigned char *row, int count, const PixelLut *lut, unsigned int *bits)
+{
+	int x = 0, i;
+
+#if defined(VIDEO_KERNEL_NEON)
+	{
+		static const unsigned char weights[VIDEO_KERNEL_LANES] = { 1, 2, 4, 8, 16, 32, 64, 128,
+																   1, 2, 4, 8, 16, 32, 64, 128 };
+		const uint8x8x4_t table = lut_bits(lut);
+		const uint8x16_t weight = vld1q_u8(weights);
+
+		for (; x + 2 * VIDEO_KERNEL_LANES <= count; x += 2 * VIDEO_KERNEL_LANES) {
+			unsigned int word = 0;
+
+			for (i = 0; i < 2 * VIDEO_KERNEL_LANES; i += VIDEO_KERNEL_LANES) {
+				uint8x16_t pixel = vld1q_u8(row + x + i);
+				uint8x16_t bright = vcombine_u8(lut_bright8(table, vget_low_u8(pixel)),
+												lut_bright8(table, vget_high_u8(pixel)));
+				uint8x16_t weighted = vandq_u8(bright, weight);
+				uint64x1_t low = vpaddl_u32(vpaddl_u16(vpaddl_u8(vget_low_u8(weighted))));
+				uint64x1_t high = vpaddl_u32(vpaddl_u16(vpaddl_u8(vget_high_u8(weighted))));
+
+				word |= ((unsigned int)vget_lane_u64(low, 0) | ((unsigned int)vget_lane_u64(high, 0) << 8)) << i;
+			}
+
+			bits[x >> 5] = word;
+		}
+	}
+#elif defined(VIDEO_KERNEL_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		unsigned char flags[2 * VIDEO_KERNEL_LANES];
+
+		// Byte flags first, so the table loads don't wait on each other, then movemask packs them
+		for (; x + 2 * VIDEO_KERNEL_LANES <= count; x += 2 * VIDEO_KERNEL_LANES) {
+			__m128i low, high;
+
+			for (i = 0; i < 2 * VIDEO_KERNEL_LANES; i++) {
+				flags[i] = PIXEL_LUT_BRIGHT(lut, row[x + i]);
+			}
+
+			low = _mm_cmpgt_epi8(_mm_loadu_si128((const __m128i *)flags), zero);
+			high = _mm_cmpgt_epi8(_mm_loadu_si128((const __m128i *)(flags + VIDEO_KERNEL_LANES)), zero);
+			bits[x >> 5] = (unsigned int)_mm_movemask_epi8(low) | ((unsigned int)_mm_movemask_epi8(high) << 16);
+		}
+	}
+#endif
+
+	for (; x < count; x += 32) {
+		unsigned int word = 0;
+		int end = count - x < 32 ? count - x : 32;
+
+		for (i = 0; i < end; i++) {
+			word |= (unsigned int)PIXEL_LUT_BRIGHT(lut, row[x + i]) << i;
+		}
+
+		bits[x >> 5] = word;
+	}
+}
+
+/****************************************************************************************
+ * Convert a row to grey, one pixel at a time
+****************************************************************************************/
+void video_grey_scalar(const unsigned char *row, int count, unsigned char *grey)
+{
+	int x;
+
+	for (x = 0; x < count; x++) {
+		int pixel = row[x];
+
+		grey[x] = (unsigned char)((GREY_R * ((pixel >> 5) & 0x07) + GREY_G * ((pixel >> 2) & 0x07) +
+								   GREY_B * (pixel & 0x03)) >> 8);
+	}
+}
+
+/****************************************************************************************
+ * Convert a row to grey, VIDEO_KERNEL_LANES pixels at a time
+****************************************************************************************/
+void video_grey(const unsigned char *row, int count, unsigned char *grey)
+{
+	int x = 0;
+
+#if defined(VIDEO_KERNEL_NEON)
+	{
+		const uint8x16_t mask3 = vdupq_n_u8(0x07);
+		const uint8x16_t mask2 = vdupq_n_u8(0x03);
+
+		for (; x + VIDEO_KERNEL_LANES <= count; x += VIDEO_KERNEL_LANES) {
+			uint8x16_t pixel = vld1q_u8(row + x);
+			uint8x16_t r = vshrq_n_u8(pixel, 5);
+			uint8x16_t g = vandq_u8(vshrq_n_u8(pixel, 2), mask3);
+			uint8x16_t b = vandq_u8(pixel, mask2);
+			uint16x8_t lo = vmulq_n_u16(vmovl_u8(vget_low_u8(r)), GREY_R);
+			uint16x8_t hi = vmulq_n_u16(vmovl_u8(vget_high_u8(r)), GREY_R);
+
+			lo = vmlaq_n_u16(lo, vmovl_u8(vget_low_u8(g)), GREY_G);
+			hi = vmlaq_n_u16(hi, vmovl_u8(vget_high_u8(g)), GREY_G);
+			lo = vmlaq_n_u16(lo, vmovl_u8(vget_low_u8(b)), GREY_B);
+			hi = vmlaq_n_u16(hi, vmovl_u8(vget_high_u8(b)), GREY_B);
+			vst1q_u8(grey + x, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+		}
+	}
+#elif defined(VIDEO_KERNEL_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i mask3 = _mm_set1_epi16(0x07);
+		const __m128i mask2 = _mm_set1_epi16(0x03);
+		const __m128i weight_r = _mm_set1_epi16(GREY_R);
+		const __m128i weight_g = _mm_set1_epi16(GREY_G);
+		const __m128i weight_b = _mm_set1_epi16(GREY_B);
+		__m128i half[2];
+		int h;
+
+		for (; x + VIDEO_KERNEL_LANES <= count; x += VIDEO_KERNEL_LANES) {
+			__m128i pixels = _mm_loadu_si128((const __m128i *)(row + x));
+
+			// The sum is at most 65284, so it fits unsigned 16-bit lanes
+			for (h = 0; h < 2; h++) {
+				__m128i pixel = h ? _mm_unpackhi_epi8(pixels, zero) : _mm_unpacklo_epi8(pixels, zero);
+				__m128i sum = _mm_mullo_epi16(_mm_srli_epi16(pixel, 5), weight_r);
+
+				sum = _mm_add_epi16(sum, _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(pixel, 2), mask3), weight_g));
+				sum = _mm_add_epi16(sum, _mm_mullo_epi16(_mm_and_si128(pixel, mask2), weight_b));
+				half[h] = _mm_srli_epi16(sum, 8);
+			}
+			_mm_storeu_si128((__m128i *)(grey + x), _mm_packus_epi16(half[0], half[1]));
+		}
+	}
+#endif
+
+	video_grey_scalar(row + x, count - x, grey + x);
+}
+
+// Sobel strength at columns first to last - 1, which all have both neighbours
+static void sobel_span(const unsigned char *above, const unsigned char *row, const unsigned char *below,
+					   int first, int last, unsigned char *out)
+{
+	int x;
+
+	for (x = first; x < last; x++) {
+		int gx = (above[x + 1] + 2 * row[x + 1] + below[x + 1]) - (above[x - 1] + 2 * row[x - 1] + below[x - 1]);
+		int gy = (below[x - 1] + 2 * below[x] + below[x + 1]) - (above[x - 1] + 2 * above[x] + above[x + 1]);
+		int value = (gx < 0 ? -gx : gx) + (gy < 0 ? -gy : gy);
+
+		if (value > 255) {
+			value = 255;
+		}
+		out[x] = (unsigned char)GREY_PIXEL(value);
+	}
+}
+
+/****************************************************************************************
+ * Sobel edges of a grey row, one pixel at a time
+****************************************************************************************/
+void video_sobel_scalar(const unsigned char *above, const unsigned char *row, const unsigned char *below,
+						int count, unsigned char *out)
+{
+	if (count <= 0) {
+		return;
+	}
+
+	out[0] = out[count - 1] = 0;
+	sobel_span(above, row, below, 1, count - 1, out);
+}
+
+/****************************************************************************************
+ * Sobel edges of a grey row, VIDEO_KERNEL_LANES pixels at a time
+****************************************************************************************/
+void video_sobel(const unsigned char *above, const unsigned char *row, const unsigned char *below,
+				 int count, unsigned char *out)
+{
+	int x = 1;
+
+	if (count <= 0) {
+		return;
+	}
+
+	out[0] = out[count - 1] = 0;
+
+#if defined(VIDEO_KERNEL_NEON)
+	{
+		const uint8x16_t mask_g = vdupq_n_u8(0x1C);
+
+		for (; x + VIDEO_KERNEL_LANES < count; x += VIDEO_KERNEL_LANES) {
+			uint8x16_t a0 = vld1q_u8(above + x - 1), a1 = vld1q_u8(above + x), a2 = vld1q_u8(above + x + 1);
+			uint8x16_t r0 = vld1q_u8(row + x - 1), r2 = vld1q_u8(row + x + 1);
+			uint8x16_t b0 = vld1q_u8(below + x - 1), b1 = vld1q_u8(below + x), b2 = vld1q_u8(below + x + 1);
+			uint8x8_t half[2];
+			uint8x16_t value;
+			int h;
+
+			for (h = 0; h < 2; h++) {
+				uint8x8_t ta0 = h ? vget_high_u8(a0) : vget_low_u8(a0);
+				uint8x8_t ta1 = h ? vget_high_u8(a1) : vget_low_u8(a1);
+				uint8x8_t ta2 = h ? vget_high_u8(a2) : vget_low_u8(a2);
+				uint8x8_t tr0 = h ? vget_high_u8(r0) : vget_low_u8(r0);
+				uint8x8_t tr2 = h ? vget_high_u8(r2) : vget_low_u8(r2);
+				uint8x8_t tb0 = h ? vget_high_u8(b0) : vget_low_u8(b0);
+				uint8x8_t tb1 = h ? vget_high_u8(b1) : vget_low_u8(b1);
+				uint8x8_t tb2 = h ? vget_high_u8(b2) : vget_low_u8(b2);
+				uint16x8_t right = vaddq_u16(vaddl_u8(ta2, tb2), vshll_n_u8(tr2, 1));
+				uint16x8_t left = vaddq_u16(vaddl_u8(ta0, tb0), vshll_n_u8(tr0, 1));
+				uint16x8_t bottom = vaddq_u16(vaddl_u8(tb0, tb2), vshll_n_u8(tb1, 1));
+				uint16x8_t top = vaddq_u16(vaddl_u8(ta0, ta2), vshll_n_u8(ta1, 1));
+				int16x8_t gx = vabsq_s16(vreinterpretq_s16_u16(vsubq_u16(right, left)));
+				int16x8_t gy = vabsq_s16(vreinterpretq_s16_u16(vsubq_u16(bottom, top)));
+
+				half[h] = vqmovn_u16(vreinterpretq_u16_s16(vaddq_s16(gx, gy)));
+			}
+
+			value = vcombine_u8(half[0], half[1]);
+			value = vorrq_u8(vorrq_u8(vandq_u8(value, vdupq_n_u8(0xE0)), vandq_u8(vshrq_n_u8(value, 3), mask_g)),
+							 vshrq_n_u8(value, 6));
+			vst1q_u8(out + x, value);
+		}
+	}
+#elif defined(VIDEO_KERNEL_SSE2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i mask_r = _mm_set1_epi8((char)0xE0);
+		const __m128i mask_g = _mm_set1_epi8(0x1C);
+		const __m128i mask_b = _mm_set1_epi8(0x03);
+
+		for (; x + VIDEO_KERNEL_LANES < count; x += VIDEO_KERNEL_LANES) {
+			const unsigned char *rows[3] = { above + x, row + x, below + x };
+			__m128i left[3], centre[3], right[3], half[2], value;
+			int h, i;
+
+			for (i = 0; i < 3; i++) {
+				left[i] = _mm_loadu_si128((const __m128i *)(rows[i] - 1));
+				centre[i] = _mm_loadu_si128((const __m128i *)rows[i]);
+				right[i] = _mm_loadu_si128((const __m128i *)(rows[i] + 1));
+			}
+
+			for (h = 0; h < 2; h++) {
+				__m128i w[3][3], gx, gy;
+
+				for (i = 0; i < 3; i++) {
+					w[i][0] = h ? _mm_unpackhi_epi8(left[i], zero) : _mm_unpacklo_epi8(left[i], zero);
+					w[i][1] = h ? _mm_unpackhi_epi8(centre[i], zero) : _mm_unpacklo_epi8(centre[i], zero);
+					w[i][2] = h ? _mm_unpackhi_epi8(right[i], zero) : _mm_unpacklo_epi8(right[i], zero);
+				}
+
+				gx = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(w[0][2], w[2][2]), _mm_slli_epi16(w[1][2], 1)),
+								   _mm_add_epi16(_mm_add_epi16(w[0][0], w[2][0]), _mm_slli_epi16(w[1][0], 1)));
+				gy = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(w[2][0], w[2][2]), _mm_slli_epi16(w[2][1], 1)),
+								   _mm_add_epi16(_mm_add_epi16(w[0][0], w[0][2]), _mm_slli_epi16(w[0][1], 1)));
+
+				// |v| is max(v, -v), there is no abs before SSSE3
+				half[h] = _mm_add_epi16(_mm_max_epi16(gx, _mm_sub_epi16(zero, gx)),
+										_mm_max_epi16(gy, _mm_sub_epi16(zero, gy)));
+			}
+
+			// packus saturates at 255, then the strength goes into the grey pixel's fields
+			value = _mm_packus_epi16(half[0], half[1]);
+			value = _mm_or_si128(_mm_or_si128(_mm_and_si128(value, mask_r),
+											  _mm_and_si128(_mm_srli_epi16(value, 3), mask_g)),
+								 _mm_and_si128(_mm_srli_epi16(value, 6), mask_b));
+			_mm_storeu_si128((__m128i *)(out + x), value);
+		}
+	}
+#endif
+
+	sobel_span(above, row, below, x, count - 1, out);
+}
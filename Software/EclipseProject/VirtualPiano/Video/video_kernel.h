@@ -0,0 +1,131 @@
+/*
+*********************************************************************************************************
+*
+*                                       VIDEO KERNEL HEADER CODE
+*
+*                                            CYCLONE V SOC
+*
+* Filename      : video_kernel.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Whole-frame pixel kernels for the RGB332 video-in buffer.  Kernels walk the frame a row
+* 				  at a time so reads and writes stay sequential, and use NEON on the HPS (SSE2 on a
+* 				  host build) to handle 16 pixels per step.  Each kernel has a plain C version with
+* 				  identical output, used for row tails and when no vector unit is available.
+* 				  The _lut kernels classify pixels with a PixelLut instead of r + g + b; on NEON the
+* 				  table's bitset is looked up with vtbl, elsewhere each pixel is one byte load.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __VIDEO_KERNEL_H__
+#define __VIDEO_KERNEL_H__
+
+#include "pixel_lut.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define VIDEO_KERNEL_NEON 1
+#elif defined(__SSE2__)
+#define VIDEO_KERNEL_SSE2 1
+#endif
+
+// Pixels handled per vector step
+#define VIDEO_KERNEL_LANES 16
+
+// Brightness test: r + g + b (0 to 17 for RGB332) above this marks a pixel
+#define VIDEO_THRESHOLD_DEFAULT 16
+
+// Marker written over bright pixels (pure red)
+#define VIDEO_MARKER_RED 0xE0
+
+// Thresholds rows first_row to last_row - 1 of an RGB332 frame.  Row y is read from
+// frame + y * frame_stride and written to out + y * out_stride, with bright pixels replaced
+// by marker.  column_counts[x] is incremented once per bright pixel in column x.
+void video_threshold_rows(const unsigned char *frame, int frame_stride,
+						  unsigned char *out, int out_stride,
+						  int width, int first_row, int last_row,
+						  int threshold, unsigned char marker,
+						  unsigned short *column_counts);
+
+// Portable version of video_threshold_rows
+void video_threshold_rows_scalar(const unsigned char *frame, int frame_stride,
+								 unsigned char *out, int out_stride,
+								 int width, int first_row, int last_row,
+								 int threshold, unsigned char marker,
+								 unsigned short *column_counts);
+
+// Sets flags[x] to 1 where r + g + b of row[x] is above threshold, 0 elsewhere
+void video_bright_flags(const unsigned char *row, int count, int threshold, unsigned char *flags);
+
+// Portable version of video_bright_flags
+void video_bright_flags_scalar(const unsigned char *row, int count, int threshold, unsigned char *flags);
+
+// Sets sums[x] to r + g + b of row[x]
+void video_brightness(const unsigned char *row, int count, unsigned char *sums);
+
+// Portable version of video_brightness
+void video_brightness_scalar(const unsigned char *row, int count, unsigned char *sums);
+
+// Reduces two rows 2x2: out[x] is the largest r + g + b of row0[2x], row0[2x + 1], row1[2x] and
+// row1[2x + 1], for count outputs.  Returns the largest value written, 0 when count is 0.
+unsigned char video_brightness_2x2(const unsigned char *row0, const unsigned char *row1, int count, unsigned char *out);
+
+// Portable version of video_brightness_2x2
+unsigned char video_brightness_2x2_scalar(const unsigned char *row0, const unsigned char *row1, int count, unsigned char *out);
+
+// Non-zero when any values[x] is above limits[x], for count values
+int video_any_above(const unsigned char *values, const unsigned char *limits, int count);
+
+// Portable version of video_any_above
+int video_any_above_scalar(const unsigned char *values, const unsigned char *limits, int count);
+
+// Moves count Q8 running means towards samples (r + g + b, 0 to 17) by a shifted exponential moving
+// average: mean += ((sample << 8) - mean) >> shift, or >> hot_shift where sample << 8 is above
+// mean + delta.  Then sets limits[x] to (mean + delta) >> 8, the largest sample not above it.
+void video_ema_q8(unsigned short *means, const unsigned char *samples, int count,
+				  int shift, int hot_shift, int delta, unsigned char *limits);
+
+// Portable version of video_ema_q8
+void video_ema_q8_scalar(unsigned short *means, const unsigned char *samples, int count,
+						 int shift, int hot_shift, int delta, unsigned char *limits);
+
+// Sum of absolute differences between two blocks 16 pixels wide and up to 128 rows tall
+unsigned int video_block_sad(const unsigned char *a, int a_stride, const unsigned char *b, int b_stride, int rows);
+
+// Portable version of video_block_sad
+unsigned int video_block_sad_scalar(const unsigned char *a, int a_stride, const unsigned char *b, int b_stride, int rows);
+
+// video_bright_flags with the bright test taken from a pixel lookup table
+void video_bright_flags_lut(const unsigned char *row, int count, const PixelLut *lut, unsigned char *flags);
+
+// video_threshold_rows with the bright test taken from a pixel lookup table, column_counts may be
+// NULL when only the marked picture is wanted
+void video_threshold_rows_lut(const unsigned char *frame, int frame_stride,
+							  unsigned char *out, int out_stride,
+							  int width, int first_row, int last_row,
+							  const PixelLut *lut, unsigned char marker,
+							  unsigned short *column_counts);
+
+// Packs the bright test of count pixels into (count + 31) / 32 words, pixel x in bit x & 31 of
+// bits[x >> 5].  Bits past count are cleared.
+void video_bright_bits_lut(const unsigned char *row, int count, const PixelLut *lut, unsigned int *bits);
+
+// Sets grey[x] to the luma of RGB332 row[x], 0 to 255: (1983 r + 6670 g + 1571 b) >> 8, which is
+// the PixelLut gray weights with each channel scaled up to 8 bits, within 1 of PIXEL_LUT_GRAY()
+void video_grey(const unsigned char *row, int count, unsigned char *grey);
+
+// Portable version of video_grey
+void video_grey_scalar(const unsigned char *row, int count, unsigned char *grey);
+
+// 3x3 Sobel over three grey rows: out[x] is min(|gx| + |gy|, 255) at column x of row, as a grey
+// RGB332 pixel (the strength's top three bits in r and g, top two in b).  out[0] and
+// out[count - 1] have no neighbours and are set to 0.
+void video_sobel(const unsigned char *above, const unsigned char *row, const unsigned char *below,
+				 int count, unsigned char *out);
+
+// Portable version of video_sobel
+void video_sobel_scalar(const unsigned char *above, const unsigned char *row, const unsigned char *below,
+						int count, unsigned char *out);
+
+#endif /* __VIDEO_KERNEL_H__ */
@@ -0,0 +1,64 @@
+from PIL import Image
+import sys
+
+# Video-in buffer layout on the board
+FRAME_WIDTH = 320
+FRAME_HEIGHT = 240
+ROW_STRIDE = 512
+
+
+def rgb2rgb332(pixel):
+	"""
+	Convert RGB format pixel to the 8-bit RGB332 format
+	of the video-in decoder
+	"""
+	r = pixel[0]
+	g = pixel[1]
+	b = pixel[2]
+
+	return (r >> 5) << 5 | (g >> 5) << 2 | (b >> 6)
+
+def make_frame(file_name):
+	"""
+	Scale an image to the video-in resolution and lay it out as a
+	raw video-in buffer dump (rows 512 bytes apart) for the host
+	harnesses in Software/Simulation
+	"""
+	img = Image.open(file_name).convert('RGB').resize((FRAME_WIDTH, FRAME_HEIGHT))
+	pix = img.load()
+
+	frame = bytearray(FRAME_HEIGHT * ROW_STRIDE)
+
+	for y in range(FRAME_HEIGHT):
+		for x in range(FRAME_WIDTH):
+			frame[y * ROW_STRIDE + x] = rgb2rgb332(pix[x, y])
+
+	return frame
+
+if __name__ == "__main__":
+	# python make_frames.py img_1_on.jpg img_1_off.jpg ...
+	# writes img_1_on.frame, img_1_off.frame, ...
+	#
+	# python make_frames.py -o session.frames [-n 10] img_1_off.jpg img_1_on.jpg ...
+	# writes one session, each image held for 10 frames, for Simulation/replay
+	args = sys.argv[1:]
+	session = None
+	hold = 1
+
+	while len(args) >= 2 and args[0] in ('-o', '-n'):
+		if args[0] == '-o':
+			session = args[1]
+		else:
+			hold = int(args[1])
+		args = args[2:]
+
+	if session is not None:
+		with open(session, 'wb') as f:
+			for file_name in args:
+				frame = make_frame(file_name)
+				for i in range(hold):
+					f.write(frame)
+	else:
+		for file_name in args:
+			with open(file_name.rsplit('.', 1)[0] + '.frame', 'wb') as f:
+				f.write(make_frame(file_name))
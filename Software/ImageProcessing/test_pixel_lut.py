@@ -0,0 +1,32 @@
+from image_proc import rgb2hsl, rgb2gs
+import sys
+
+def compareLut(file_name):
+	"""
+	Check the RGB332 lookup table printed by Simulation/pixel_lut_dump
+	against rgb2hsl() and rgb2gs(), entry by entry
+	"""
+	with open(file_name) as f:
+		lines = f.read().split()
+
+	threshold = float(lines[0].split(',')[1])
+
+	assert len(lines) == 2 + 256
+
+	for line in lines[2:]:
+		pixel, r, g, b, lightness, gray, bright = [int(v) for v in line.split(',')]
+
+		# The C table widens RGB332 by bit replication
+		r3, g3, b2 = (pixel >> 5) & 7, (pixel >> 2) & 7, pixel & 3
+		assert (r, g, b) == ((r3 << 5) | (r3 << 2) | (r3 >> 1), (g3 << 5) | (g3 << 2) | (g3 >> 1), b2 * 0x55)
+
+		l = rgb2hsl((r, g, b))[2]
+
+		assert bright == (1 if l > threshold else 0)
+		assert gray == rgb2gs((r, g, b))
+		assert lightness == int(l * 255.0 + 0.5)
+
+if __name__ == "__main__":
+	# ../Simulation/pixel_lut_dump 0.95 > pixel_lut.csv
+	# python test_pixel_lut.py pixel_lut.csv
+	compareLut(sys.argv[1] if len(sys.argv) > 1 else 'pixel_lut.csv')
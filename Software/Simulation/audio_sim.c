@@ -0,0 +1,292 @@
+/*
+*********************************************************************************************************
+*
+*                                      AUDIO CORE SIMULATION
+*
+*                                            LINUX HOST
+*
+* Filename      : audio_sim.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Register behaviour follows the Altera University Program Audio core documentation:
+* 				  writes to a full output FIFO are dropped (counted as overruns), and a sample period
+* 				  in which an output FIFO is empty plays silence (counted as an underrun once data has
+* 				  started flowing).
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "../EclipseProject/VirtualPiano/Audio/audio.h"
+#include "../EclipseProject/VirtualPiano/Audio/audio_cfg.h"
+#include <bsp_int.h>
+#include "host_mmio.h"
+#include "audio_sim.h"
+
+/*
+ *********************************************************************************************************
+ *                                    FIFO helpers
+ *********************************************************************************************************
+ */
+static int fifo_push(AudioSimFifo *fifo, uint32_t word)
+{
+	if (fifo->count == AUDIO_SIM_FIFO_DEPTH) {
+		return 0;
+	}
+
+	fifo->data[(fifo->head + fifo->count) % AUDIO_SIM_FIFO_DEPTH] = word;
+	fifo->count++;
+	return 1;
+}
+
+static int fifo_pop(AudioSimFifo *fifo, uint32_t *word)
+{
+	if (fifo->count == 0) {
+		return 0;
+	}
+
+	*word = fifo->data[fifo->head];
+	fifo->head = (fifo->head + 1) % AUDIO_SIM_FIFO_DEPTH;
+	fifo->count--;
+	return 1;
+}
+
+static void fifo_clear(AudioSimFifo *fifo)
+{
+	fifo->head = 0;
+	fifo->count = 0;
+}
+
+/*
+ *********************************************************************************************************
+ *                                    audio_sim_control()
+ *
+ * Description : Returns the control register with the RI and WI status bits computed from the FIFOs
+ *
+ *********************************************************************************************************
+ */
+static uint32_t audio_sim_control(AudioSim *sim)
+{
+	uint32_t control = sim->control & ~(AUDIO_CONTROL_RI_MASK | AUDIO_CONTROL_WI_MASK);
+	int write_space = AUDIO_SIM_FIFO_DEPTH - (sim->out_left.count > sim->out_right.count ? sim->out_left.count : sim->out_right.count);
+	int read_avail = sim->in_left.count < sim->in_right.count ? sim->in_left.count : sim->in_right.count;
+
+	if ((control & AUDIO_CONTROL_RE_MASK) && read_avail >= AUDIO_SIM_IRQ_THRESHOLD) {
+		control |= AUDIO_CONTROL_RI_MASK;
+	}
+	if ((control & AUDIO_CONTROL_WE_MASK) && write_space >= AUDIO_SIM_IRQ_THRESHOLD) {
+		control |= AUDIO_CONTROL_WI_MASK;
+	}
+
+	return control;
+}
+
+static void audio_sim_check_irq(AudioSim *sim)
+{
+	if (sim->irq_id >= 0 && (audio_sim_control(sim) & (AUDIO_CONTROL_RI_MASK | AUDIO_CONTROL_WI_MASK))) {
+		host_int_raise((CPU_INT32U)sim->irq_id);
+	}
+}
+
+static uint32_t audio_sim_fifospace(AudioSim *sim)
+{
+	return ((uint32_t)(AUDIO_SIM_FIFO_DEPTH - sim->out_left.count) << AUDIO_FIFOSPACE_WSLC_BIT_OFFSET)
+		 | ((uint32_t)(AUDIO_SIM_FIFO_DEPTH - sim->out_right.count) << AUDIO_FIFOSPACE_WSRC_BIT_OFFSET)
+		 | ((uint32_t)sim->in_left.count << AUDIO_FIFOSPACE_RALC_BIT_OFFSET)
+		 | ((uint32_t)sim->in_right.count << AUDIO_FIFOSPACE_RARC_BIT_OFFSET);
+}
+
+/*
+ *********************************************************************************************************
+ *                                    Register accessors
+ *********************************************************************************************************
+ */
+static uint32_t audio_sim_read(void *ctx, uint32_t offset, int width)
+{
+	AudioSim *sim = (AudioSim *)ctx;
+	uint32_t word = 0;
+
+	sim->accesses++;
+	audio_sim_advance_ns(sim, sim->ns_per_access);
+
+	switch (offset) {
+	case AUDIO_CONTROL_OFFSET:
+		word = audio_sim_control(sim);
+		break;
+	case AUDIO_FIFOSPACE_OFFSET:
+		word = audio_sim_fifospace(sim);
+		break;
+	case AUDIO_LEFTDATA_OFFSET:
+		fifo_pop(&sim->in_left, &word);
+		break;
+	case AUDIO_RIGHTDATA_OFFSET:
+		fifo_pop(&sim->in_right, &word);
+		break;
+	}
+
+	(void)width;
+	return word;
+}
+
+static void audio_sim_write(void *ctx, uint32_t offset, uint32_t data, int width)
+{
+	AudioSim *sim = (AudioSim *)ctx;
+
+	sim->accesses++;
+	audio_sim_advance_ns(sim, sim->ns_per_access);
+
+	switch (offset) {
+	case AUDIO_CONTROL_OFFSET:
+		// Byte writes only reach the low control byte
+		if (width == 1) {
+			data = (sim->control & ~0xFFu) | (data & 0xFFu);
+		}
+		sim->control = data & (AUDIO_CONTROL_RE_MASK | AUDIO_CONTROL_WE_MASK | AUDIO_CONTROL_CR_MASK | AUDIO_CONTROL_CW_MASK);
+		if (sim->control & AUDIO_CONTROL_CR_MASK) {
+			fifo_clear(&sim->in_left);
+			fifo_clear(&sim->in_right);
+		}
+		if (sim->control & AUDIO_CONTROL_CW_MASK) {
+			fifo_clear(&sim->out_left);
+			fifo_clear(&sim->out_right);
+			sim->streaming = 0;
+		}
+		audio_sim_check_irq(sim);
+		break;
+	case AUDIO_LEFTDATA_OFFSET:
+		if (!fifo_push(&sim->out_left, data)) {
+			sim->overruns++;
+		}
+		sim->streaming = 1;
+		break;
+	case AUDIO_RIGHTDATA_OFFSET:
+		if (!fifo_push(&sim->out_right, data)) {
+			sim->overruns++;
+		}
+		sim->streaming = 1;
+		break;
+	}
+}
+
+static uint32_t audiocfg_sim_read(void *ctx, uint32_t offset, int width)
+{
+	(void)ctx;
+	(void)offset;
+	(void)width;
+
+	// Status register reads as idle so configuration never waits
+	return 0;
+}
+
+static void audiocfg_sim_write(void *ctx, uint32_t offset, uint32_t data, int width)
+{
+	AudioSim *sim = (AudioSim *)ctx;
+
+	(void)width;
+
+	if (offset == AUDIOCFG_ADDRESS - AUDIOCFG_BASE) {
+		sim->cfg_address = (uint8_t)data & 0x0F;
+	}
+	else if (offset == AUDIOCFG_DATA - AUDIOCFG_BASE) {
+		sim->codec_regs[sim->cfg_address] = (uint16_t)data;
+	}
+}
+
+/*
+ *********************************************************************************************************
+ *                                    audio_sim_init()
+ *
+ * Description : Resets all registers, FIFOs and counters and maps the Audio and Audio Config cores
+ *
+ *********************************************************************************************************
+ */
+void audio_sim_init(AudioSim *sim)
+{
+	memset(sim, 0, sizeof(*sim));
+	sim->sample_rate = AUDIO_SIM_SAMPLE_RATE;
+	sim->irq_id = -1;
+
+	host_mmio_map((uintptr_t)AUDIO_BASE, AUDIO_SIM_SPAN, audio_sim_read, audio_sim_write, sim);
+	host_mmio_map((uintptr_t)AUDIOCFG_BASE, AUDIOCFG_SIM_SPAN, audiocfg_sim_read, audiocfg_sim_write, sim);
+}
+
+int audio_sim_record(AudioSim *sim, const char *file_name)
+{
+	if (wav_writer_open(&sim->recorder, file_name, sim->sample_rate, 2) != 0) {
+		return -1;
+	}
+
+	sim->recording = 1;
+	return 0;
+}
+
+/*
+ *********************************************************************************************************
+ *                                    audio_sim_clock()
+ *
+ * Description : Plays num_frames sample periods.  Each period pops one word from both output FIFOs
+ * 				 and pushes a silent word into both input FIFOs, then raises irq_id if an interrupt
+ * 				 condition holds.
+ *
+ *********************************************************************************************************
+ */
+void audio_sim_clock(AudioSim *sim, uint32_t num_frames)
+{
+	uint32_t n;
+
+	for (n = 0; n < num_frames; n++) {
+		uint32_t left = 0, right = 0;
+		int have_left = fifo_pop(&sim->out_left, &left);
+		int have_right = fifo_pop(&sim->out_right, &right);
+
+		if (have_left && have_right) {
+			sim->frames_played++;
+		}
+		else if (sim->streaming) {
+			sim->underruns++;
+		}
+
+		fifo_push(&sim->in_left, 0);
+		fifo_push(&sim->in_right, 0);
+
+		if (sim->recording && sim->streaming) {
+			int16_t frame[2];
+			frame[0] = (int16_t)((int32_t)left >> sim->data_shift);
+			frame[1] = (int16_t)((int32_t)right >> sim->data_shift);
+			wav_writer_write(&sim->recorder, frame, 1);
+		}
+
+		sim->frames_clocked++;
+		audio_sim_check_irq(sim);
+	}
+}
+
+void audio_sim_advance_ns(AudioSim *sim, uint64_t ns)
+{
+	uint64_t frames_before = sim->time_ns * sim->sample_rate / 1000000000ull;
+	uint64_t frames_after;
+
+	sim->time_ns += ns;
+	frames_after = sim->time_ns * sim->sample_rate / 1000000000ull;
+
+	if (frames_after > frames_before) {
+		audio_sim_clock(sim, (uint32_t)(frames_after - frames_before));
+	}
+}
+
+void audio_sim_report(AudioSim *sim, FILE *out)
+{
+	fprintf(out, "Audio core: %llu frames clocked, %lu played, %lu underruns, %lu overruns, %lu register accesses\n",
+			(unsigned long long)sim->frames_clocked, sim->frames_played, sim->underruns, sim->overruns, sim->accesses);
+}
+
+void audio_sim_close(AudioSim *sim)
+{
+	if (sim->recording) {
+		wav_writer_close(&sim->recorder);
+		sim->recording = 0;
+	}
+
+	host_mmio_unmap_all();
+}
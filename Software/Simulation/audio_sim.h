@@ -0,0 +1,97 @@
+/*
+*********************************************************************************************************
+*
+*                                      AUDIO CORE SIMULATION
+*
+*                                            LINUX HOST
+*
+* Filename      : audio_sim.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Software model of the Altera University IP "Audio" core as used by Audio/audio.c.
+* 				  The control, fifospace, leftdata and rightdata registers are mapped at AUDIO_BASE
+* 				  through host_mmio, so the driver runs unmodified.  Each channel has a 128 word FIFO
+* 				  in both directions, drained (output) and filled with silence (input) by a simulated
+* 				  48 kHz codec clock.
+*
+* 				  The codec clock advances either explicitly through audio_sim_clock() or, when
+* 				  ns_per_access is non-zero, by that many nanoseconds on every register access so that
+* 				  busy-polling code sees the FIFOs drain.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __AUDIO_SIM_H__
+#define __AUDIO_SIM_H__
+
+#include <stdint.h>
+#include "wav_writer.h"
+
+#define AUDIO_SIM_FIFO_DEPTH 128
+#define AUDIO_SIM_SAMPLE_RATE 48000
+#define AUDIO_SIM_SPAN 16
+#define AUDIOCFG_SIM_SPAN 16
+
+// The core raises WI when the output FIFOs are 75% empty and RI when the input FIFOs are 75% full
+#define AUDIO_SIM_IRQ_THRESHOLD ((AUDIO_SIM_FIFO_DEPTH * 3) / 4)
+
+typedef struct {
+	uint32_t    data[AUDIO_SIM_FIFO_DEPTH];
+	int         head;
+	int         count;
+} AudioSimFifo;
+
+typedef struct {
+	// Registers
+	uint32_t        control;
+	AudioSimFifo    out_left;
+	AudioSimFifo    out_right;
+	AudioSimFifo    in_left;
+	AudioSimFifo    in_right;
+
+	// WM8731 registers written through the Audio and Video Config core
+	uint16_t        codec_regs[16];
+	uint8_t         cfg_address;
+
+	// GIC interrupt ID raised while RI or WI is set, -1 for none
+	int             irq_id;
+
+	// Codec clock
+	uint32_t        sample_rate;
+	uint32_t        ns_per_access;
+	uint64_t        time_ns;
+	uint64_t        frames_clocked;
+
+	// Statistics
+	int             streaming;
+	unsigned long   accesses;
+	unsigned long   frames_played;
+	unsigned long   underruns;
+	unsigned long   overruns;
+
+	// Output recording, data words are shifted right by data_shift before truncating to 16 bits
+	WavWriter       recorder;
+	int             recording;
+	int             data_shift;
+} AudioSim;
+
+// Resets the model and maps it into the host address space
+void audio_sim_init(AudioSim *sim);
+
+// Records every frame the codec plays to a stereo WAV file
+int audio_sim_record(AudioSim *sim, const char *file_name);
+
+// Advances the codec clock by num_frames sample periods
+void audio_sim_clock(AudioSim *sim, uint32_t num_frames);
+
+// Advances the codec clock by ns nanoseconds of simulated time
+void audio_sim_advance_ns(AudioSim *sim, uint64_t ns);
+
+// Prints the counters
+void audio_sim_report(AudioSim *sim, FILE *out);
+
+// Closes the recording and unmaps the model
+void audio_sim_close(AudioSim *sim);
+
+#endif /* __AUDIO_SIM_H__ */
@@ -0,0 +1,110 @@
+/*
+*********************************************************************************************************
+*
+*                                      AUDIO CORE SIMULATION DEMO
+*
+*                                            LINUX HOST
+*
+* Filename      : audio_sim_demo.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Configures the codec the same way main() in APP/app.c does, then streams one second of
+* 				  a 440 Hz tone against the simulated Audio core, either with write_audio_frames_blocking()
+* 				  ("poll") or through the audio_stream ring and write interrupt ("irq", in blocks the size
+* 				  GenerateSoundTask uses).  OSTimeDly() advances the codec clock, so the register access
+* 				  count shows how much polling the writer does.  The output is recorded to a WAV file
+* 				  and the counters are printed to stderr.
+*
+* 				  Usage: ./audio_sim_demo [poll|irq] [output.wav]
+*
+*********************************************************************************************************
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "../EclipseProject/VirtualPiano/Audio/audio.h"
+#include "../EclipseProject/VirtualPiano/Audio/audio_cfg.h"
+#include "../EclipseProject/VirtualPiano/Audio/audio_stream.h"
+#include "audio_sim.h"
+#include "host_os.h"
+
+#define DEMO_FRAMES AUDIO_SIM_SAMPLE_RATE
+#define DEMO_FREQUENCY 440.0
+#define DEMO_AMPLITUDE 4096
+#define DEMO_BLOCK_FRAMES 256
+
+// Approximate cost of one lightweight bridge access
+#define DEMO_NS_PER_ACCESS 100
+
+static INT32U left[DEMO_FRAMES];
+static INT32U right[DEMO_FRAMES];
+
+// OSTimeDly() hook, lets the codec play while the writer sleeps
+static void demo_delay(void *ctx, uint64_t ns)
+{
+	audio_sim_advance_ns((AudioSim *)ctx, ns);
+}
+
+int main(int argc, char **argv)
+{
+	AudioSim sim;
+	int use_irq = argc > 1 && strcmp(argv[1], "irq") == 0;
+	const char *file_name = argc > 2 ? argv[2] : "audio_sim.wav";
+	int i;
+
+	audio_sim_init(&sim);
+	sim.irq_id = AUDIO_IRQ_ID;
+	sim.ns_per_access = DEMO_NS_PER_ACCESS;
+	host_os_set_delay_hook(demo_delay, &sim);
+	if (audio_sim_record(&sim, file_name) != 0) {
+		fprintf(stderr, "Could not open %s\n", file_name);
+		return 1;
+	}
+
+	// Same codec setup as main()
+	write_audio_cfg_register(LEFT_LINE_IN, LINE_IN_HIGH_VOLUME);
+	write_audio_cfg_register(RIGHT_LINE_IN, LINE_IN_HIGH_VOLUME);
+	write_audio_cfg_register(LEFT_HEADPHONE_OUT, HEADPHONE_HIGH_VOLUME);
+	write_audio_cfg_register(RIGHT_HEADPHONE_OUT, HEADPHONE_HIGH_VOLUME);
+	write_audio_cfg_register(ANALOG_AUDIO_PATH, DIGITAL_AUDIO_CONVERTER);
+	write_audio_cfg_register(DIGITAL_AUDIO_PATH, HIGH_PASS);
+	write_audio_cfg_register(POWER_DOWN, POWER_ON);
+	write_audio_cfg_register(DIGITAL_AUDIO_INTERFACE, LEFT_JUSTIFIED);
+	write_audio_cfg_register(SAMPLING_CONTROL, NORMAL_MODE);
+	write_audio_cfg_register(ACTIVE_CONTROL, ACTIVE);
+	reset_audio_core();
+
+	for (i = 0; i < DEMO_FRAMES; i++) {
+		left[i] = right[i] = (INT32U)(INT32S)(DEMO_AMPLITUDE * sin(2.0 * M_PI * DEMO_FREQUENCY * i / AUDIO_SIM_SAMPLE_RATE));
+	}
+
+	if (use_irq) {
+		audio_stream_init();
+		for (i = 0; i < DEMO_FRAMES; i += DEMO_BLOCK_FRAMES) {
+			int n = DEMO_FRAMES - i < DEMO_BLOCK_FRAMES ? DEMO_FRAMES - i : DEMO_BLOCK_FRAMES;
+			audio_stream_write_blocking(&left[i], &right[i], n);
+		}
+		audio_stream_end();
+	}
+	else {
+		write_audio_frames_blocking(left, right, DEMO_FRAMES);
+	}
+
+	// Let the ring and FIFOs play out
+	while ((use_irq && audio_stream_fill() > 0) || sim.out_left.count > 0 || sim.out_right.count > 0) {
+		audio_sim_clock(&sim, 1);
+	}
+
+	audio_sim_report(&sim, stderr);
+	fprintf(stderr, "Writer slept %lu times\n", host_os_delays);
+	if (use_irq) {
+		fprintf(stderr, "Ring: %u irqs, %u frames out, %u underruns, min fill %u of %u\n",
+				audio_stream_stats.irqs, audio_stream_stats.frames_out, audio_stream_stats.underruns,
+				audio_stream_stats.min_fill, AUDIO_RING_FRAMES);
+	}
+	audio_sim_close(&sim);
+
+	return 0;
+}
@@ -0,0 +1,489 @@
+/*
+*********************************************************************************************************
+*
+*                                   RECORDED SESSION BATCH ANALYSIS
+*
+*                                            LINUX HOST
+*
+* Filename      : batch.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Finds the key presses in long recorded sessions using every core of the host, with
+* 				  the board's own detector.  The keyboard is calibrated on the first frame as replay
+* 				  does, then every frame goes through key_detect_frame() and the key events are
+* 				  printed.
+*
+* 				  A detector carries state from frame to frame, so the session is cut into segments of
+* 				  BATCH_SEGMENT_FRAMES frames and each thread of a stripe pool (stripe_pool.h) runs one
+* 				  segment of a block through its own KeyDetector.  The background remembers the whole
+* 				  session, but it learns from the frames alone: one thread keeps it with
+* 				  key_detect_learn(), a remap and pyramid every KEY_DETECT_BACKGROUND_PERIOD frames, and
+* 				  hands each segment a copy.  Everything else (the changed tiles, the key debounce and
+* 				  the tracks) is short lived, so a detector is restarted on that copy and warmed up on
+* 				  the BATCH_WARMUP_FRAMES frames before its segment, whose events are dropped; by the
+* 				  segment's first frame it is where one detector run from the start would be.  The
+* 				  first segment starts cold on frame 0, as the board does, and a detector whose last
+* 				  segment ended where its next begins, as with one thread, carries on without a
+* 				  warm-up.  Once a block is done the segments' events are taken in order, so the
+* 				  result is the same whatever the number of threads.  The threads meet once per block,
+* 				  not once per frame, and never touch another thread's detector.
+*
+* 				  The seams are checked after the timed passes: the first pass's events are compared,
+* 				  by count and checksum, with one detector run through the whole session on its own,
+* 				  as replay runs it, and batch fails if they differ.  That run is not part of the
+* 				  timings, which are wall time.
+*
+* 				  Sessions are streamed from their files, so their length is not limited by memory.
+* 				  With none given, a synthetic session is analyzed as by replay.  -j sets the threads
+* 				  (default one per online core) and -n the passes over the frames for steadier
+* 				  timings.  Every pass finds the same events; those of the first pass are printed and
+* 				  counted, and a later pass that differs is reported.  The event checksum printed at
+* 				  the end makes runs with different -j easy to compare.
+*
+* 				  Usage: ./batch [-j threads] [-n passes] [frame or session ...]
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../EclipseProject/VirtualPiano/Video/key_detect.h"
+#include "frame_file.h"
+#include "session_cal.h"
+#include "stripe_pool.h"
+
+// Frames each detector reports, and the frames before them it is warmed up on: enough to take in
+// a tile refresh (TILE_REFRESH_PERIOD_DEFAULT) and then the key debounce
+#define BATCH_SEGMENT_FRAMES 64
+#define BATCH_WARMUP_FRAMES 40
+
+#define BATCH_SYNTHETIC_SCENES 8
+#define BATCH_SYNTHETIC_HOLD 8
+
+// One thread's detector and the events of its segment of the block
+typedef struct {
+	KeyDetector     detector;
+	Background      background;		// the session's, as of the first warm-up frame
+	KeyEventRing    ring;
+	KeyEvent        events[BATCH_SEGMENT_FRAMES * KEY_MAP_KEYS];
+	int             num_events;
+	unsigned int    overflows;		// pushes refused by the ring, over every segment
+	unsigned int    frames;			// frames detected, warm-up included
+	unsigned int    next;			// session index of the frame after the last detected
+	double          seconds;
+} BatchWorker;
+
+// Where the frames come from
+typedef struct {
+	char          **files;
+	int             num_files;
+	int             file;			// file being read
+	FILE           *session;		// open session file, NULL for a single dump
+	int             synthetic;		// frames handed out of the synthetic session
+} BatchSource;
+
+// Events of a pass
+typedef struct {
+	unsigned int    downs, ups;
+	unsigned int    frames;
+	unsigned int    checksum;
+} BatchEvents;
+
+// The detector the keys are calibrated on, which then learns the session's background
+static KeyDetector detector;
+static int calibrated;
+
+// The block being detected: the warm-up frames carried over from the last block, then one
+// segment per thread
+static unsigned char *block_buffer;
+static const unsigned char **block;
+static int block_size;
+static int block_frames;
+static int block_carry;
+static unsigned int block_base;		// session index of block[0]
+static BatchWorker *workers[STRIPE_POOL_MAX_THREADS];
+
+static unsigned char synthetic[BATCH_SYNTHETIC_SCENES][FRAME_FILE_BYTES];
+
+static double batch_seconds(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Starts the source over at the first frame
+static void batch_open(BatchSource *source, char **files, int num_files)
+{
+	memset(source, 0, sizeof(*source));
+	source->files = files;
+	source->num_files = num_files;
+}
+
+// Reads the next frame into frame, or points frame at a synthetic one; returns 0, 1 at the end
+// or -1 if a file cannot be read
+static int batch_next(BatchSource *source, unsigned char *frame, const unsigned char **next)
+{
+	*next = frame;
+
+	if (source->num_files == 0) {
+		if (source->synthetic == BATCH_SYNTHETIC_SCENES * BATCH_SYNTHETIC_HOLD) {
+			return 1;
+		}
+		*next = synthetic[source->synthetic++ / BATCH_SYNTHETIC_HOLD];
+		return 0;
+	}
+
+	for (;;) {
+		const char *file_name;
+
+		// Raw dumps back to back, read straight through
+		if (source->session != NULL) {
+			if (fread(frame, 1, FRAME_FILE_BYTES, source->session) == FRAME_FILE_BYTES) {
+				return 0;
+			}
+			fclose(source->session);
+			source->session = NULL;
+			source->file++;
+		}
+
+		if (source->file == source->num_files) {
+			return 1;
+		}
+
+		file_name = source->files[source->file];
+		if (frame_file_count(file_name) > 1) {
+			source->session = fopen(file_name, "rb");
+			if (source->session == NULL) {
+				fprintf(stderr, "cannot read frames from %s\n", file_name);
+				return -1;
+			}
+			continue;
+		}
+
+		source->file++;
+		if (frame_file_load(file_name, frame) != 0) {
+			fprintf(stderr, "cannot read frames from %s\n", file_name);
+			return -1;
+		}
+		return 0;
+	}
+}
+
+// Carries the last block's warm-up frames over and fills the rest, returns the new frames or -1
+static int batch_read_block(BatchSource *source)
+{
+	int carry = block_frames < BATCH_WARMUP_FRAMES ? block_frames : BATCH_WARMUP_FRAMES;
+	int result = 0;
+	int f;
+
+	for (f = 0; f < carry; f++) {
+		const unsigned char *frame = block[block_frames - carry + f];
+		unsigned char *slot = block_buffer + (size_t)f * FRAME_FILE_BYTES;
+
+		// Synthetic frames are not in the buffer, read ones are copied to the front
+		if (frame >= block_buffer && frame < block_buffer + (size_t)block_size * FRAME_FILE_BYTES) {
+			memcpy(slot, frame, FRAME_FILE_BYTES);
+			frame = slot;
+		}
+		block[f] = frame;
+	}
+	block_base += block_frames - carry;
+	block_carry = carry;
+
+	block_frames = carry;
+	while (block_frames < carry + block_size - BATCH_WARMUP_FRAMES &&
+		   (result = batch_next(source, block_buffer + (size_t)block_frames * FRAME_FILE_BYTES,
+								&block[block_frames])) == 0) {
+		block_frames++;
+	}
+
+	return result < 0 ? -1 : block_frames - carry;
+}
+
+// Learns the background up to each segment's warm-up and then up to the next block, on one thread
+static void batch_learn(int stripes)
+{
+	int next = block_frames - (block_frames < BATCH_WARMUP_FRAMES ? block_frames : BATCH_WARMUP_FRAMES);
+	int s, first, warm;
+
+	for (s = 0; s < stripes; s++) {
+		first = block_carry + s * BATCH_SEGMENT_FRAMES;
+		warm = first - BATCH_WARMUP_FRAMES > 0 ? first - BATCH_WARMUP_FRAMES : 0;
+		if (first >= block_frames) {
+			break;
+		}
+
+		while (detector.frames < block_base + warm) {
+			key_detect_learn(&detector, block[detector.frames - block_base]);
+		}
+		memcpy(&workers[s]->background, &detector.background, sizeof(Background));
+	}
+
+	while (detector.frames < block_base + next) {
+		key_detect_learn(&detector, block[detector.frames - block_base]);
+	}
+}
+
+// One thread's segment of the block, warmed up on the frames before it
+static void batch_segment(void *ctx, int stripe, int count)
+{
+	BatchWorker *own = workers[stripe];
+	int first = block_carry + stripe * BATCH_SEGMENT_FRAMES;
+	int last = first + BATCH_SEGMENT_FRAMES < block_frames ? first + BATCH_SEGMENT_FRAMES : block_frames;
+	int warm = first - BATCH_WARMUP_FRAMES > 0 ? first - BATCH_WARMUP_FRAMES : 0;
+	double start = batch_seconds();
+	KeyEvent event;
+	int f;
+
+	(void)ctx;
+	(void)count;
+
+	own->num_events = 0;
+	if (first >= last) {
+		return;
+	}
+
+	// Carry on where the last segment ended, as with one thread, or start over and warm up
+	if (own->next == block_base + first) {
+		warm = first;
+	}
+	else {
+		key_detect_restart(&own->detector, block_base + warm, &own->background);
+	}
+	for (f = warm; f < last; f++) {
+		key_detect_frame(&own->detector, block[f], &own->ring);
+
+		while (key_event_pop(&own->ring, &event) == 0) {
+			if (f >= first) {
+				own->events[own->num_events++] = event;
+			}
+		}
+	}
+
+	own->overflows = own->ring.overflows;
+	own->frames += last - warm;
+	own->next = block_base + last;
+	own->seconds += batch_seconds() - start;
+}
+
+// Counts an event into the pass's checksum
+static void batch_event(BatchEvents *pass, const KeyEvent *event, int print)
+{
+	if (event->down) {
+		pass->downs++;
+	}
+	else {
+		pass->ups++;
+	}
+	if (print) {
+		printf("frame %5u  key %2d %s\n", event->frame, event->key + 1, event->down ? "down" : "up");
+	}
+	pass->checksum = (pass->checksum ^ (event->frame << 8 ^ event->key << 1 ^ event->down)) * 16777619u;
+}
+
+// Takes the block's events in segment order
+static void batch_merge(int stripes, BatchEvents *pass, int print)
+{
+	int s, e;
+
+	for (s = 0; s < stripes; s++) {
+		for (e = 0; e < workers[s]->num_events; e++) {
+			batch_event(pass, &workers[s]->events[e], print);
+		}
+	}
+	pass->frames += block_frames - block_carry;
+}
+
+// One detector through the whole session, as replay runs it; returns 0 or -1
+static int batch_sequential(BatchSource *source, BatchEvents *pass)
+{
+	BatchWorker *own = workers[0];
+	const unsigned char *frame;
+	KeyEvent event;
+	int result;
+
+	key_detect_restart(&own->detector, 0, NULL);
+	while ((result = batch_next(source, block_buffer, &frame)) == 0) {
+		key_detect_frame(&own->detector, frame, &own->ring);
+		while (key_event_pop(&own->ring, &event) == 0) {
+			batch_event(pass, &event, 0);
+		}
+		pass->frames++;
+	}
+
+	return result < 0 ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	double start, pass_start, wall_seconds = 0.0, read_seconds = 0.0, learn_seconds = 0.0;
+	double detect_seconds = 0.0;
+	unsigned int overflows = 0, detected = 0;
+	int passes = 1, opt, pass, s, result;
+	const unsigned char *first;
+	BatchEvents events, sequential;
+	BatchSource source;
+	StripePool pool;
+
+	while ((opt = getopt(argc, argv, "j:n:")) != -1) {
+		if (opt == 'j') {
+			threads = atoi(optarg);
+		}
+		else if (opt == 'n') {
+			passes = atoi(optarg);
+		}
+		else {
+			fprintf(stderr, "usage: %s [-j threads] [-n passes] [frame or session ...]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	threads = threads < 1 ? 1 : threads > STRIPE_POOL_MAX_THREADS ? STRIPE_POOL_MAX_THREADS : threads;
+	block_size = BATCH_WARMUP_FRAMES + threads * BATCH_SEGMENT_FRAMES;
+	block_buffer = malloc((size_t)block_size * FRAME_FILE_BYTES);
+	block = malloc((size_t)block_size * sizeof(*block));
+	if (block_buffer == NULL || block == NULL || passes <= 0) {
+		fprintf(stderr, "usage: %s [-j threads] [-n passes] [frame or session ...]\n", argv[0]);
+		return 1;
+	}
+
+	for (s = 0; s < BATCH_SYNTHETIC_SCENES; s++) {
+		frame_file_synthesize(synthetic[s], s);
+	}
+
+	// Calibrate on the first frame, then start over
+	batch_open(&source, argv + optind, argc - optind);
+	if (batch_next(&source, block_buffer, &first) != 0) {
+		fprintf(stderr, "no frames\n");
+		return 1;
+	}
+	if (source.session != NULL) {
+		fclose(source.session);
+	}
+
+	key_detect_init(&detector);
+	calibrated = session_calibrate(&detector, first) == 0;
+
+	// Every thread detects with the same keys
+	for (s = 0; s < threads; s++) {
+		workers[s] = malloc(sizeof(BatchWorker));
+		if (workers[s] == NULL) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+		key_detect_init(&workers[s]->detector);
+		if (calibrated) {
+			key_detect_use_cal(&workers[s]->detector, &detector.cal);
+		}
+		else {
+			key_detect_use_default(&workers[s]->detector);
+		}
+		key_event_init(&workers[s]->ring);
+		workers[s]->overflows = workers[s]->frames = workers[s]->next = 0;
+		workers[s]->seconds = 0.0;
+	}
+
+	if (stripe_pool_start(&pool, threads, batch_segment, NULL) != 0) {
+		fprintf(stderr, "cannot start %d threads\n", threads);
+		return 1;
+	}
+	printf("%s, %d threads, %d frame segments warmed up on %d frames, %d passes\n",
+		   source.num_files ? "recorded frames" : "synthetic frames", pool.stripes,
+		   BATCH_SEGMENT_FRAMES, BATCH_WARMUP_FRAMES, passes);
+
+	memset(&events, 0, sizeof(events));
+	for (pass = 0; pass < passes; pass++) {
+		BatchEvents this_pass;
+
+		memset(&this_pass, 0, sizeof(this_pass));
+		this_pass.checksum = 2166136261u;
+		batch_open(&source, argv + optind, argc - optind);
+		block_frames = block_carry = 0;
+		block_base = 0;
+		key_detect_restart(&detector, 0, NULL);
+
+		pass_start = batch_seconds();
+		for (;;) {
+			start = batch_seconds();
+			result = batch_read_block(&source);
+			read_seconds += batch_seconds() - start;
+			if (result <= 0) {
+				break;
+			}
+
+			start = batch_seconds();
+			batch_learn(pool.stripes);
+			learn_seconds += batch_seconds() - start;
+
+			start = batch_seconds();
+			stripe_pool_run(&pool);
+			detect_seconds += batch_seconds() - start;
+
+			batch_merge(pool.stripes, &this_pass, pass == 0);
+		}
+		wall_seconds += batch_seconds() - pass_start;
+
+		if (result < 0) {
+			stripe_pool_stop(&pool);
+			return 1;
+		}
+
+		if (pass == 0) {
+			events = this_pass;
+		}
+		else if (this_pass.checksum != events.checksum) {
+			printf("pass %d: %u down, %u up, checksum %08x, not the events of pass 0\n",
+				   pass, this_pass.downs, this_pass.ups, this_pass.checksum);
+		}
+	}
+
+	stripe_pool_stop(&pool);
+
+	if (events.frames == 0) {
+		fprintf(stderr, "no frames\n");
+		return 1;
+	}
+
+	for (s = 0; s < pool.stripes; s++) {
+		overflows += workers[s]->overflows;
+		detected += workers[s]->frames;
+	}
+
+	printf("%u frames in %u blocks, %.1f fps, %.2f us/frame wall time\n", passes * events.frames, pool.jobs,
+		   passes * events.frames / wall_seconds, 1e6 * wall_seconds / (passes * events.frames));
+	printf("  %-20s %8.2f us/frame\n", "read", 1e6 * read_seconds / (passes * events.frames));
+	printf("  %-20s %8.2f us/frame\n", "background", 1e6 * learn_seconds / (passes * events.frames));
+	printf("  %-20s %8.2f us/frame, %.2f frames detected per frame with the warm-up\n", "detect",
+		   1e6 * detect_seconds / (passes * events.frames), (double)detected / (passes * events.frames));
+	for (s = 0; s < pool.stripes; s++) {
+		printf("  thread %-13d %8.2f us/frame busy, %5.1f%% of the detect wall time\n", s,
+			   1e6 * workers[s]->seconds / (passes * events.frames),
+			   detect_seconds > 0.0 ? 100.0 * workers[s]->seconds / detect_seconds : 0.0);
+	}
+	printf("key events per pass: %u down, %u up, %u lost to a full ring, checksum %08x\n",
+		   events.downs, events.ups, overflows, events.checksum);
+
+	// The seams, against one detector through the whole session
+	memset(&sequential, 0, sizeof(sequential));
+	sequential.checksum = 2166136261u;
+	batch_open(&source, argv + optind, argc - optind);
+	if (batch_sequential(&source, &sequential) != 0) {
+		return 1;
+	}
+	printf("one detector: %u down, %u up, checksum %08x, %s\n", sequential.downs, sequential.ups,
+		   sequential.checksum, sequential.checksum == events.checksum ? "the same events" : "other events");
+
+	for (s = 0; s < threads; s++) {
+		free(workers[s]);
+	}
+	free(block);
+	free(block_buffer);
+	return sequential.checksum == events.checksum ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+/*
+*********************************************************************************************************
+*
+*                                      VIDEO BENCHMARK HARNESS
+*
+*                                            LINUX HOST
+*
+* Filename      : bench.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+
+unsigned char bench_frames[BENCH_MAX_FRAMES][FRAME_FILE_BYTES];
+unsigned char bench_screen[VGA_AREA];
+KeyMap bench_map;
+PixelLut bench_lut;
+unsigned char bench_labels[VIDEO_IN_FRAME_WIDTH * VIDEO_IN_FRAME_HEIGHT];
+KeyBitMasks bench_key_bits;
+BitMask bench_mask;
+BlobLabeller bench_blobs;
+
+static unsigned char reference_screen[VGA_AREA];
+
+// The loop KeyDetectTask ran before the row-major kernel
+void bench_original(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	volatile unsigned int *video_in_ptr = (volatile unsigned int *)frame;
+	int i, j;
+
+	memset(key_counts, 0, BENCH_KEYS * sizeof(unsigned short));
+
+	for (i = 0; i < 320; i++) {
+		for (j = 10; j < 240; j++) {
+			int pixel = video_in_read_pixel(video_in_ptr, i, j);
+			int r = (pixel & 0b11100000) >> 5;
+			int g = (pixel & 0b00011100) >> 2;
+			int b = pixel & 0b00000011;
+
+			if (r + g + b > 16) {
+				pixel = 0b11100000;
+				key_counts[i * BENCH_KEYS / VIDEO_IN_FRAME_WIDTH]++;
+			}
+
+			out[((j+240)<<10) + (i+320)] = pixel;
+		}
+	}
+}
+
+double bench_seconds(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Checks one variant against the original loop on every frame, then times it
+double bench_run(const char *name, BenchKernel kernel, int num_frames, int passes, double baseline_fps, int check)
+{
+	unsigned short reference_counts[BENCH_KEYS], counts[BENCH_KEYS];
+	double start, fps;
+	int f, p, y;
+
+	for (f = 0; f < num_frames && check != 0; f++) {
+		bench_original(bench_frames[f], reference_screen, reference_counts);
+		kernel(bench_frames[f], bench_screen, counts);
+
+		for (y = BENCH_FIRST_ROW; y < VIDEO_IN_FRAME_HEIGHT && (check & BENCH_CHECK_SCREEN); y++) {
+			int row = BENCH_SCREEN_OFFSET + (y << 10);
+
+			if (memcmp(reference_screen + row, bench_screen + row, VIDEO_IN_FRAME_WIDTH) != 0) {
+				fprintf(stderr, "%s: frame %d row %d differs from the original loop\n", name, f, y);
+				return -1.0;
+			}
+		}
+
+		if ((check & BENCH_CHECK_COUNTS) && memcmp(reference_counts, counts, sizeof(counts)) != 0) {
+			fprintf(stderr, "%s: frame %d key counts differ from the original loop\n", name, f);
+			return -1.0;
+		}
+	}
+
+	start = bench_seconds();
+	for (p = 0; p < passes; p++) {
+		for (f = 0; f < num_frames; f++) {
+			kernel(bench_frames[f], bench_screen, counts);
+		}
+	}
+	fps = passes * num_frames / (bench_seconds() - start);
+
+	printf("%-28s %10.1f fps  %7.2f us/frame", name, fps, 1e6 / fps);
+	if (baseline_fps > 0.0) {
+		printf("  %5.1fx", fps / baseline_fps);
+	}
+	printf("\n");
+
+	return fps;
+}
+
+// Keys over the keyboard rows only, leaning like a keyboard seen at an angle
+void bench_slanted_map(KeyMap *map)
+{
+	int k;
+
+	key_map_init(map);
+
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		short x0 = (short)(k * VIDEO_IN_FRAME_WIDTH / KEY_MAP_KEYS);
+		short x1 = (short)((k + 1) * VIDEO_IN_FRAME_WIDTH / KEY_MAP_KEYS);
+		short points[8] = { x0, BENCH_KEYBOARD_TOP, x1, BENCH_KEYBOARD_TOP,
+							(short)(x1 + 2), BENCH_KEYBOARD_BOTTOM, (short)(x0 + 2), BENCH_KEYBOARD_BOTTOM };
+
+		key_map_set_polygon(map, k, points, 4);
+	}
+}
+
+// Blobs over bench_map and the keys under their centroids
+void bench_blob_keys(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	unsigned int mask[KEY_MAP_MASK_WORDS];
+
+	(void)out;
+	(void)key_counts;
+	bit_mask_build(&bench_mask, frame, VIDEO_IN_ROW_STRIDE, bench_map.top, bench_map.bottom, &bench_lut);
+	blob_label(&bench_blobs, &bench_mask, bench_map.left, bench_map.top, bench_map.right, bench_map.bottom);
+	blob_keys(&bench_blobs, bench_labels, mask);
+}
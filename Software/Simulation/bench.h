@@ -0,0 +1,78 @@
+/*
+*********************************************************************************************************
+*
+*                                   VIDEO BENCHMARK HARNESS HEADER CODE
+*
+*                                            LINUX HOST
+*
+* Filename      : bench.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : What the video_bench sections share: the frames under test, the screen the kernels
+* 				  draw into, the key map and lookup table most sections detect with, and bench_run(),
+* 				  which checks a kernel against the original KeyDetectTask loop and then times it.
+* 				  Each bench_*.c file checks and times one module; main() in video_bench.c runs them
+* 				  in order, and a later section may rely on the map an earlier one calibrated.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include "../EclipseProject/VirtualPiano/Video/video_kernel.h"
+#include "../EclipseProject/VirtualPiano/Video/key_map.h"
+#include "../EclipseProject/VirtualPiano/Video/bit_mask.h"
+#include "../EclipseProject/VirtualPiano/Video/blob.h"
+#include "frame_file.h"
+
+#define BENCH_MAX_FRAMES 64
+#define BENCH_FIRST_ROW 10
+#define BENCH_KEYS 88
+
+// Frame the calibration sections draw the synthetic keyboard into
+#define BENCH_CAL_FRAME (BENCH_MAX_FRAMES - 1)
+
+// What bench_run compares against the original loop
+#define BENCH_CHECK_SCREEN 0x01
+#define BENCH_CHECK_COUNTS 0x02
+#define BENCH_CHECK_ALL (BENCH_CHECK_SCREEN | BENCH_CHECK_COUNTS)
+
+// Keyboard rows of the synthetic frames
+#define BENCH_KEYBOARD_TOP 120
+#define BENCH_KEYBOARD_BOTTOM 220
+
+// Same quadrant offset KeyDetectTask draws at
+#define BENCH_SCREEN_OFFSET ((240 << 10) + 320)
+
+typedef void (*BenchKernel)(const unsigned char *frame, unsigned char *screen, unsigned short *key_counts);
+
+extern unsigned char bench_frames[BENCH_MAX_FRAMES][FRAME_FILE_BYTES];
+extern unsigned char bench_screen[VGA_AREA];
+extern KeyMap bench_map;
+extern PixelLut bench_lut;
+extern unsigned char bench_labels[VIDEO_IN_FRAME_WIDTH * VIDEO_IN_FRAME_HEIGHT];	// of bench_map
+extern KeyBitMasks bench_key_bits;
+extern BitMask bench_mask;
+extern BlobLabeller bench_blobs;
+
+// Harness, bench.c
+double bench_seconds(void);
+void bench_original(const unsigned char *frame, unsigned char *out, unsigned short *key_counts);
+double bench_run(const char *name, BenchKernel kernel, int num_frames, int passes, double baseline_fps, int check);
+void bench_slanted_map(KeyMap *map);
+void bench_blob_keys(const unsigned char *frame, unsigned char *out, unsigned short *key_counts);
+
+// Sections in the order they run, each returns 0 or -1 once a check fails; the threshold
+// section returns the original loop's frame rate, the baseline of the others
+double bench_threshold_section(int num_frames, int passes);
+int bench_blob_section(int num_frames, int passes, double baseline);
+int bench_key_cal_section(int num_frames, int passes, double baseline);
+int bench_remap_section(int num_frames, int passes, double baseline);
+int bench_pyramid_section(int num_frames, int passes, double baseline);
+int bench_edge_section(int num_frames, int passes, double baseline);
+int bench_key_state_section(int passes);
+int bench_motion_section(int passes, double baseline);
+
+#endif /* __BENCH_H__ */
@@ -0,0 +1,227 @@
+/*
+*********************************************************************************************************
+*
+*                                    BLOB AND BIT MASK BENCHMARK
+*
+*                                            LINUX HOST
+*
+* Filename      : bench_blob.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The blob labeller (Video/blob.c) against a plain flood fill, on the frames and on
+* 				  random masks dense enough to join and split components every way.  The packed bit
+* 				  mask it reads (Video/bit_mask.c) is checked pixel by pixel against the lookup table,
+* 				  and its popcount key scores against the original loop and key_map_detect(), then the
+* 				  scores and the labelling are timed.
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+
+// Random masks for the blob check
+#define BENCH_BLOB_MASKS 16
+#define BENCH_BLOB_MASK_X 100
+#define BENCH_BLOB_MASK_Y 120
+#define BENCH_BLOB_MASK_SIZE 64
+
+static BlobStats flood_blobs[VIDEO_IN_PIXEL_SIZE];
+static int flood_stack[VIDEO_IN_PIXEL_SIZE];
+static unsigned char flood_seen[VIDEO_IN_PIXEL_SIZE];
+
+// Plain 8-connected flood fill of the bright pixels in rows first_row.., returns the number of components
+static int bench_flood(const unsigned char *frame, int first_row)
+{
+	int num_blobs = 0;
+	int x, y;
+
+	memset(flood_seen, 0, sizeof(flood_seen));
+
+	for (y = first_row; y < VIDEO_IN_FRAME_HEIGHT; y++) {
+		for (x = 0; x < VIDEO_IN_FRAME_WIDTH; x++) {
+			BlobStats *stats = &flood_blobs[num_blobs];
+			int top = 0;
+
+			if (flood_seen[y * VIDEO_IN_FRAME_WIDTH + x] ||
+				!PIXEL_LUT_BRIGHT(&bench_lut, frame[y * VIDEO_IN_ROW_STRIDE + x])) {
+				continue;
+			}
+
+			memset(stats, 0, sizeof(*stats));
+			stats->x0 = stats->x1 = (short)x;
+			stats->y0 = stats->y1 = (short)y;
+			flood_seen[y * VIDEO_IN_FRAME_WIDTH + x] = 1;
+			flood_stack[top++] = y * VIDEO_IN_FRAME_WIDTH + x;
+
+			while (top > 0) {
+				int px = flood_stack[--top] % VIDEO_IN_FRAME_WIDTH;
+				int py = flood_stack[top] / VIDEO_IN_FRAME_WIDTH;
+				int nx, ny;
+
+				stats->area++;
+				stats->sum_x += px;
+				stats->sum_y += py;
+				stats->x0 = px < stats->x0 ? px : stats->x0;
+				stats->x1 = px > stats->x1 ? px : stats->x1;
+				stats->y1 = py > stats->y1 ? py : stats->y1;
+
+				for (ny = py - 1; ny <= py + 1; ny++) {
+					for (nx = px - 1; nx <= px + 1; nx++) {
+						if (nx < 0 || nx >= VIDEO_IN_FRAME_WIDTH || ny < first_row || ny >= VIDEO_IN_FRAME_HEIGHT ||
+							flood_seen[ny * VIDEO_IN_FRAME_WIDTH + nx] ||
+							!PIXEL_LUT_BRIGHT(&bench_lut, frame[ny * VIDEO_IN_ROW_STRIDE + nx])) {
+							continue;
+						}
+						flood_seen[ny * VIDEO_IN_FRAME_WIDTH + nx] = 1;
+						flood_stack[top++] = ny * VIDEO_IN_FRAME_WIDTH + nx;
+					}
+				}
+			}
+
+			stats->x1++;
+			stats->y1++;
+			num_blobs++;
+		}
+	}
+
+	return num_blobs;
+}
+
+// Every reported blob must be one of the flood fill's components, and no component may be missed
+static int bench_check_blob_frame(const char *name, int f, const unsigned char *frame)
+{
+	int total = bench_flood(frame, BENCH_FIRST_ROW);
+	int i, j;
+
+	int x, y;
+
+	bit_mask_build(&bench_mask, frame, VIDEO_IN_ROW_STRIDE, 0, VIDEO_IN_FRAME_HEIGHT, &bench_lut);
+
+	for (y = 0; y < VIDEO_IN_FRAME_HEIGHT; y++) {
+		for (x = 0; x < VIDEO_IN_FRAME_WIDTH; x++) {
+			if (BIT_MASK_TEST(&bench_mask, x, y) != PIXEL_LUT_BRIGHT(&bench_lut, frame[y * VIDEO_IN_ROW_STRIDE + x])) {
+				fprintf(stderr, "bit mask: %s %d pixel (%d, %d) differs from the lookup table\n", name, f, x, y);
+				return -1;
+			}
+		}
+	}
+
+	blob_init(&bench_blobs, 1);
+	blob_label(&bench_blobs, &bench_mask, 0, BENCH_FIRST_ROW, VIDEO_IN_FRAME_WIDTH, VIDEO_IN_FRAME_HEIGHT);
+
+	if (bench_blobs.runs_dropped != 0 || bench_blobs.num_blobs + (int)bench_blobs.blobs_dropped != total) {
+		fprintf(stderr, "blobs: %s %d has %d components, labeller found %d + %u dropped\n",
+				name, f, total, bench_blobs.num_blobs, bench_blobs.blobs_dropped);
+		return -1;
+	}
+
+	for (i = 0; i < bench_blobs.num_blobs; i++) {
+		const Blob *blob = &bench_blobs.blobs[i];
+
+		for (j = 0; j < total; j++) {
+			const BlobStats *stats = &flood_blobs[j];
+
+			if (stats->area == blob->area && stats->x0 == blob->x0 && stats->y0 == blob->y0 &&
+				stats->x1 == blob->x1 && stats->y1 == blob->y1 &&
+				(float)stats->sum_x / stats->area == blob->cx && (float)stats->sum_y / stats->area == blob->cy) {
+				break;
+			}
+		}
+
+		if (j == total || (i > 0 && blob->area > bench_blobs.blobs[i - 1].area)) {
+			fprintf(stderr, "blobs: %s %d blob %d (%u px at %.1f, %.1f) is not a flood fill component\n",
+					name, f, i, blob->area, blob->cx, blob->cy);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int bench_check_blobs(int num_frames)
+{
+	static unsigned char mask[FRAME_FILE_BYTES];
+	int f, x, y;
+
+	pixel_lut_init(&bench_lut, PIXEL_LUT_THRESHOLD_DEFAULT);
+
+	for (f = 0; f < num_frames; f++) {
+		if (bench_check_blob_frame("frame", f, bench_frames[f]) != 0) {
+			return -1;
+		}
+	}
+
+	// Dense noise joins and splits components in every way, diagonals included
+	srand(1);
+	for (f = 0; f < BENCH_BLOB_MASKS; f++) {
+		memset(mask, 0, sizeof(mask));
+
+		for (y = 0; y < BENCH_BLOB_MASK_SIZE; y++) {
+			for (x = 0; x < BENCH_BLOB_MASK_SIZE; x++) {
+				if (rand() % 16 < 6 + f % 4) {
+					mask[(BENCH_BLOB_MASK_Y + y) * VIDEO_IN_ROW_STRIDE + BENCH_BLOB_MASK_X + x] = 0xFF;
+				}
+			}
+		}
+
+		if (bench_check_blob_frame("mask", f, mask) != 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void bench_bit_mask(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	unsigned int mask[KEY_MAP_MASK_WORDS];
+
+	(void)out;
+	bit_mask_build(&bench_mask, frame, VIDEO_IN_ROW_STRIDE, bench_map.top, bench_map.bottom, &bench_lut);
+	bit_mask_score_keys(&bench_key_bits, &bench_mask, key_counts, mask);
+}
+
+// Checks the labeller and the bit mask scores, then times them
+int bench_blob_section(int num_frames, int passes, double baseline)
+{
+	int f;
+
+	if (bench_check_blobs(num_frames) != 0) {
+		return -1;
+	}
+
+	key_map_init_uniform(&bench_map, 0, BENCH_FIRST_ROW, VIDEO_IN_FRAME_WIDTH, VIDEO_IN_FRAME_HEIGHT);
+	bit_mask_build_keys(&bench_key_bits, &bench_map);
+	printf("bit mask, %5u bytes         %6d key words\n", (unsigned int)sizeof(BitMask), bench_key_bits.num_words);
+	if (bench_run("  full-frame zones", bench_bit_mask, num_frames, passes, baseline, BENCH_CHECK_COUNTS) < 0.0) {
+		return -1;
+	}
+
+	bench_slanted_map(&bench_map);
+	bit_mask_build_keys(&bench_key_bits, &bench_map);
+	bench_run("  keyboard polygons", bench_bit_mask, num_frames, passes, baseline, 0);
+	for (f = 0; f < num_frames; f++) {
+		unsigned short counts[KEY_MAP_KEYS], bit_counts[KEY_MAP_KEYS];
+		unsigned int mask[KEY_MAP_MASK_WORDS];
+
+		key_map_detect(&bench_map, bench_frames[f], VIDEO_IN_ROW_STRIDE, counts, mask);
+		bench_bit_mask(bench_frames[f], bench_screen, bit_counts);
+		if (memcmp(counts, bit_counts, sizeof(counts)) != 0) {
+			fprintf(stderr, "bit mask: frame %d polygon key counts differ from key_map_detect\n", f);
+			return -1;
+		}
+	}
+
+	key_map_init_uniform(&bench_map, 0, BENCH_KEYBOARD_TOP, VIDEO_IN_FRAME_WIDTH, BENCH_KEYBOARD_BOTTOM);
+	key_map_build_labels(&bench_map, bench_labels);
+	blob_init(&bench_blobs, KEY_MAP_MIN_PIXELS_DEFAULT);
+	bench_blob_keys(bench_frames[0], bench_screen, NULL);
+	printf("blobs, keyboard rows         %6d in frame 0, %d runs\n", bench_blobs.num_blobs, bench_blobs.num_runs);
+	bench_run("  label + keys", bench_blob_keys, num_frames, passes, baseline, 0);
+
+	return 0;
+}
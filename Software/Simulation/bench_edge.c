@@ -0,0 +1,181 @@
+/*
+*********************************************************************************************************
+*
+*                                       EDGE FILTER BENCHMARK
+*
+*                                            LINUX HOST
+*
+* Filename      : bench_edge.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The grey conversion and Sobel kernels of the edge filter (Video/edge.c): grey against
+* 				  the lookup table's gray level, both vector kernels against plain C at odd starts and
+* 				  lengths, whole frames against Sobel computed from its definition, and a black to white
+* 				  step.  Then the filter is timed in plain C and vectorized, in megapixels per second.
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../EclipseProject/VirtualPiano/Video/edge.h"
+#include "bench.h"
+
+static EdgeFilter bench_edges;
+static unsigned char edge_frame[FRAME_FILE_BYTES];
+static unsigned char edge_grey[VIDEO_IN_FRAME_HEIGHT][VIDEO_IN_FRAME_WIDTH];
+static unsigned char step_frame[FRAME_FILE_BYTES];
+
+// Software edges of the whole frame
+static void bench_edge_pass(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	(void)out;
+	(void)key_counts;
+	edge_filter_frame(&bench_edges, frame, VIDEO_IN_ROW_STRIDE, edge_frame, VIDEO_IN_ROW_STRIDE, 0, VIDEO_IN_FRAME_HEIGHT);
+}
+
+// The same with the plain C kernels
+static void bench_edge_scalar(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	int y;
+
+	(void)out;
+	(void)key_counts;
+	for (y = 0; y < VIDEO_IN_FRAME_HEIGHT; y++) {
+		video_grey_scalar(frame + y * VIDEO_IN_ROW_STRIDE, VIDEO_IN_FRAME_WIDTH, edge_grey[y]);
+	}
+
+	memset(edge_frame, 0, VIDEO_IN_FRAME_WIDTH);
+	memset(edge_frame + (VIDEO_IN_FRAME_HEIGHT - 1) * VIDEO_IN_ROW_STRIDE, 0, VIDEO_IN_FRAME_WIDTH);
+	for (y = 1; y < VIDEO_IN_FRAME_HEIGHT - 1; y++) {
+		video_sobel_scalar(edge_grey[y - 1], edge_grey[y], edge_grey[y + 1], VIDEO_IN_FRAME_WIDTH,
+						   edge_frame + y * VIDEO_IN_ROW_STRIDE);
+	}
+}
+
+// Edge pixel at (x, y) from the definition: Sobel of the luma, |gx| + |gy| as grey RGB332
+static int bench_edge_reference(const unsigned char *frame, int x, int y)
+{
+	static const int kx[3][3] = { { -1, 0, 1 }, { -2, 0, 2 }, { -1, 0, 1 } };
+	int gx = 0, gy = 0, i, j, value;
+
+	if (x == 0 || y == 0 || x == VIDEO_IN_FRAME_WIDTH - 1 || y == VIDEO_IN_FRAME_HEIGHT - 1) {
+		return 0;
+	}
+
+	for (j = -1; j <= 1; j++) {
+		for (i = -1; i <= 1; i++) {
+			int pixel = frame[(y + j) * VIDEO_IN_ROW_STRIDE + x + i];
+			// rgb2gs() of the channels scaled to 8 bits, in Q8
+			int grey = ((int)(PIXEL_LUT_GRAY_R * 255.0 / 7 * 256.0 + 0.5) * ((pixel >> 5) & 0x07) +
+						(int)(PIXEL_LUT_GRAY_G * 255.0 / 7 * 256.0 + 0.5) * ((pixel >> 2) & 0x07) +
+						(int)(PIXEL_LUT_GRAY_B * 255.0 / 3 * 256.0 + 0.5) * (pixel & 0x03)) >> 8;
+
+			gx += kx[j + 1][i + 1] * grey;
+			gy += kx[i + 1][j + 1] * grey;
+		}
+	}
+
+	value = abs(gx) + abs(gy);
+	value = value > 255 ? 255 : value;
+	return (value & 0xE0) | ((value >> 5) << 2) | (value >> 6);
+}
+
+static int bench_check_edges(int num_frames)
+{
+	static const int offsets[3] = { 0, 1, 7 };
+	unsigned char grey[VIDEO_IN_FRAME_WIDTH], grey_check[VIDEO_IN_FRAME_WIDTH];
+	unsigned char out[VIDEO_IN_FRAME_WIDTH], out_check[VIDEO_IN_FRAME_WIDTH];
+	unsigned int edges = 0;
+	int f, i, x, y;
+
+	// The grey conversion is the PixelLut's gray level, give or take the Q8 rounding
+	for (i = 0; i < PIXEL_LUT_SIZE; i++) {
+		unsigned char pixel = (unsigned char)i;
+
+		video_grey_scalar(&pixel, 1, grey);
+		if (abs(grey[0] - PIXEL_LUT_GRAY(&bench_lut, pixel)) > 1) {
+			fprintf(stderr, "edges: grey of pixel 0x%02X is %d, the lookup table has %d\n", i, grey[0],
+					PIXEL_LUT_GRAY(&bench_lut, pixel));
+			return -1;
+		}
+	}
+
+	// Vector kernels against plain C, at odd starts and lengths for the tails, on the pixels
+	// themselves as grey rows for the full byte range
+	for (f = 0; f < num_frames; f++) {
+		for (y = 1; y < VIDEO_IN_FRAME_HEIGHT - 1; y++) {
+			for (i = 0; i < 3; i++) {
+				const unsigned char *row = bench_frames[f] + y * VIDEO_IN_ROW_STRIDE + offsets[i];
+				int count = VIDEO_IN_FRAME_WIDTH - offsets[i] - y % 19;
+
+				video_grey(row, count, grey);
+				video_grey_scalar(row, count, grey_check);
+				video_sobel(row - VIDEO_IN_ROW_STRIDE, row, row + VIDEO_IN_ROW_STRIDE, count, out);
+				video_sobel_scalar(row - VIDEO_IN_ROW_STRIDE, row, row + VIDEO_IN_ROW_STRIDE, count, out_check);
+				if (memcmp(grey, grey_check, count) != 0 || memcmp(out, out_check, count) != 0) {
+					fprintf(stderr, "edges: frame %d row %d from %d differs from plain C\n", f, y, offsets[i]);
+					return -1;
+				}
+			}
+		}
+	}
+
+	// Whole frames against the definition
+	edge_filter_init(&bench_edges);
+	for (f = 0; f < num_frames; f++) {
+		bench_edge_pass(bench_frames[f], bench_screen, NULL);
+		for (y = 0; y < VIDEO_IN_FRAME_HEIGHT; y++) {
+			for (x = 0; x < VIDEO_IN_FRAME_WIDTH; x++) {
+				int pixel = edge_frame[y * VIDEO_IN_ROW_STRIDE + x];
+
+				if (pixel != bench_edge_reference(bench_frames[f], x, y)) {
+					fprintf(stderr, "edges: frame %d pixel (%d, %d) differs from the definition\n", f, x, y);
+					return -1;
+				}
+				edges += pixel != 0;
+			}
+		}
+	}
+
+	// A black to white step is a white line two pixels wide, flat areas are black
+	memset(step_frame, 0, sizeof(step_frame));
+	for (y = 0; y < VIDEO_IN_FRAME_HEIGHT; y++) {
+		memset(step_frame + y * VIDEO_IN_ROW_STRIDE + VIDEO_IN_FRAME_WIDTH / 2, 0xFF, VIDEO_IN_FRAME_WIDTH / 2);
+	}
+	bench_edge_pass(step_frame, bench_screen, NULL);
+	for (x = 0; x < VIDEO_IN_FRAME_WIDTH; x++) {
+		int expected = x == VIDEO_IN_FRAME_WIDTH / 2 - 1 || x == VIDEO_IN_FRAME_WIDTH / 2 ? 0xFF : 0x00;
+
+		if (edge_frame[100 * VIDEO_IN_ROW_STRIDE + x] != expected) {
+			fprintf(stderr, "edges: step pixel %d is 0x%02X, not 0x%02X\n", x, edge_frame[100 * VIDEO_IN_ROW_STRIDE + x], expected);
+			return -1;
+		}
+	}
+
+	printf("edges, 3x3 Sobel             %6d px, %u edge pixels over the frames\n",
+		   VIDEO_IN_FRAME_WIDTH * VIDEO_IN_FRAME_HEIGHT, edges);
+	return 0;
+}
+
+// Checks the edge kernels and the filter, then times them
+int bench_edge_section(int num_frames, int passes, double baseline)
+{
+	if (bench_check_edges(num_frames) != 0) {
+		return -1;
+	}
+
+	{
+		double mp = VIDEO_IN_FRAME_WIDTH * VIDEO_IN_FRAME_HEIGHT / 1e6;
+		double fps;
+
+		fps = bench_run("  plain C", bench_edge_scalar, num_frames, passes, baseline, 0);
+		printf("%-28s %10.1f MP/s\n", "  throughput", fps * mp);
+		fps = bench_run("  vector", bench_edge_pass, num_frames, passes, baseline, 0);
+		printf("%-28s %10.1f MP/s\n", "  throughput", fps * mp);
+	}
+
+	return 0;
+}
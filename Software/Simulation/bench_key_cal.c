@@ -0,0 +1,116 @@
+/*
+*********************************************************************************************************
+*
+*                                     KEY CALIBRATION BENCHMARK
+*
+*                                            LINUX HOST
+*
+* Filename      : bench_key_cal.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Calibrates (Video/key_cal.c) the keyboard of a synthetic frame: the keys must follow
+* 				  the piano from A0, each must own its centre in the label table, every pixel below the
+* 				  black keys must belong to a white key, and the storage checksum must catch a change.
+* 				  Then the calibration is timed, and the blob keys again on the calibrated map, which
+* 				  the sections after this one keep using.
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include "../EclipseProject/VirtualPiano/Video/key_cal.h"
+#include "bench.h"
+
+static KeyCal bench_cal;
+
+static void bench_key_cal_pass(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	(void)out;
+	(void)key_counts;
+	key_cal_find(&bench_cal, frame, VIDEO_IN_ROW_STRIDE, &bench_lut);
+	key_cal_apply(&bench_cal, &bench_map);
+	key_map_build_labels(&bench_map, bench_labels);
+}
+
+// Calibrates a synthetic frame: the keys must follow the piano from A0 and cover the keyboard
+static int bench_check_key_cal(void)
+{
+	static const unsigned char black_note[12] = { 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1 };	// from A
+	int result, k, x, y;
+
+	frame_file_synthesize(bench_frames[BENCH_CAL_FRAME], 0);
+	result = key_cal_find(&bench_cal, bench_frames[BENCH_CAL_FRAME], VIDEO_IN_ROW_STRIDE, &bench_lut);
+	if (result != KEY_CAL_OK) {
+		fprintf(stderr, "key cal: synthetic keyboard not found (%d)\n", result);
+		return -1;
+	}
+
+	// The drawing starts and ends on a gap column
+	if (bench_cal.top != BENCH_KEYBOARD_TOP || bench_cal.bottom != BENCH_KEYBOARD_BOTTOM ||
+		bench_cal.left > 1 || bench_cal.right < VIDEO_IN_FRAME_WIDTH - 1) {
+		fprintf(stderr, "key cal: keyboard at %d..%d x %d..%d\n",
+				bench_cal.left, bench_cal.right, bench_cal.top, bench_cal.bottom);
+		return -1;
+	}
+
+	key_cal_apply(&bench_cal, &bench_map);
+	key_map_build_labels(&bench_map, bench_labels);
+
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		const KeyCalKey *key = &bench_cal.keys[k];
+
+		if (key->black != black_note[k % 12]) {
+			fprintf(stderr, "key cal: key %d is %s\n", k, key->black ? "black" : "white");
+			return -1;
+		}
+
+		// Every key owns its centre, halfway down its own part of the keyboard
+		x = (key->top_x0 + key->top_x1) / 2;
+		y = key->black ? (bench_cal.top + bench_cal.split) / 2 : (bench_cal.split + bench_cal.bottom) / 2;
+		if (bench_labels[y * VIDEO_IN_FRAME_WIDTH + x] != k || key_map_key_at(&bench_map, x, y) != k) {
+			fprintf(stderr, "key cal: key %d does not own (%d, %d)\n", k, x, y);
+			return -1;
+		}
+	}
+
+	// Every keyboard pixel below the black keys belongs to a white key
+	for (y = bench_cal.split; y < bench_cal.bottom; y++) {
+		for (x = bench_cal.left; x < bench_cal.right; x++) {
+			k = bench_labels[y * VIDEO_IN_FRAME_WIDTH + x];
+			if (k == KEY_MAP_NO_KEY || bench_cal.keys[k].black) {
+				fprintf(stderr, "key cal: (%d, %d) is not on a white key\n", x, y);
+				return -1;
+			}
+		}
+	}
+
+	if (!key_cal_valid(&bench_cal)) {
+		fprintf(stderr, "key cal: fresh calibration fails its checksum\n");
+		return -1;
+	}
+
+	bench_cal.keys[40].x0++;
+	if (key_cal_valid(&bench_cal)) {
+		fprintf(stderr, "key cal: corrupted calibration passes its checksum\n");
+		return -1;
+	}
+	bench_cal.keys[40].x0--;
+
+	return 0;
+}
+
+// Checks the calibration of the synthetic keyboard and times it, leaving bench_map calibrated
+int bench_key_cal_section(int num_frames, int passes, double baseline)
+{
+	if (bench_check_key_cal() != 0) {
+		return -1;
+	}
+
+	printf("key calibration              %6u px, %d spans\n", bench_map.area, bench_map.num_spans);
+	bench_run("  find + map + labels", bench_key_cal_pass, num_frames, passes, baseline, 0);
+	bench_key_cal_pass(bench_frames[BENCH_CAL_FRAME], bench_screen, NULL);
+	bench_run("  label + keys", bench_blob_keys, num_frames, passes, baseline, 0);
+
+	return 0;
+}
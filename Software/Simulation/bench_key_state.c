@@ -0,0 +1,205 @@
+/*
+*********************************************************************************************************
+*
+*                                        KEY STATE BENCHMARK
+*
+*                                            LINUX HOST
+*
+* Filename      : bench_key_state.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The hysteresis and debounce of Video/key_state.c against a per-key reference written
+* 				  out plainly, on random presses with dropouts and spikes: every event must come out in
+* 				  key order in its frame.  A release met by a full event ring must still come out once
+* 				  the ring drains.  Then an update and the drain of its events are timed.
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../EclipseProject/VirtualPiano/Video/key_state.h"
+#include "bench.h"
+
+// Noisy key detections for the key state check
+#define BENCH_KEY_STATE_FRAMES 4000
+
+static KeyState bench_state;
+static KeyEventRing bench_events;
+static unsigned short state_counts[BENCH_KEY_STATE_FRAMES][KEY_MAP_KEYS];
+static unsigned int state_candidates[BENCH_KEY_STATE_FRAMES][KEY_MAP_MASK_WORDS];
+
+// Per-key debounce written out plainly, to check key_state_update against
+typedef struct {
+	int down, run;
+} BenchKey;
+
+static int bench_reference_key(BenchKey *key, int candidate, int count)
+{
+	int raw = key->down ? count >= KEY_STATE_OFF_PIXELS_DEFAULT : candidate && count >= KEY_STATE_ON_PIXELS_DEFAULT;
+
+	if (raw == key->down) {
+		key->run = 0;
+		return 0;
+	}
+
+	if (++key->run < (key->down ? KEY_STATE_OFF_FRAMES_DEFAULT : KEY_STATE_ON_FRAMES_DEFAULT)) {
+		return 0;
+	}
+
+	key->down = raw;
+	key->run = 0;
+	return 1;
+}
+
+// Random presses with dropouts and spikes: events must match the reference, in key order per frame
+static int bench_check_key_state(void)
+{
+	BenchKey keys[KEY_MAP_KEYS];
+	int lit[KEY_MAP_KEYS];
+	KeyEvent event;
+	int f, k, events = 0;
+
+	memset(keys, 0, sizeof(keys));
+	memset(lit, 0, sizeof(lit));
+	memset(state_candidates, 0, sizeof(state_candidates));
+	srand(7);
+
+	for (f = 0; f < BENCH_KEY_STATE_FRAMES; f++) {
+		for (k = 0; k < KEY_MAP_KEYS; k++) {
+			if (rand() % 200 == 0) {
+				lit[k] = !lit[k];
+			}
+
+			// Lit keys waver around both thresholds and drop out now and then, dark ones spike
+			state_counts[f][k] = (unsigned short)(lit[k] ? (rand() % 8 == 0 ? rand() % 6 : 3 + rand() % 12)
+													   : (rand() % 16 == 0 ? rand() % 12 : 0));
+			if (lit[k] ? rand() % 6 != 0 : rand() % 24 == 0) {
+				state_candidates[f][k >> 5] |= 1u << (k & 31);
+			}
+		}
+	}
+
+	key_state_init(&bench_state, KEY_STATE_ON_PIXELS_DEFAULT, KEY_STATE_OFF_PIXELS_DEFAULT,
+				   KEY_STATE_ON_FRAMES_DEFAULT, KEY_STATE_OFF_FRAMES_DEFAULT);
+	key_event_init(&bench_events);
+
+	for (f = 0; f < BENCH_KEY_STATE_FRAMES; f++) {
+		key_state_update(&bench_state, state_candidates[f], state_counts[f], (unsigned int)f, &bench_events);
+
+		for (k = 0; k < KEY_MAP_KEYS; k++) {
+			if (!bench_reference_key(&keys[k], (state_candidates[f][k >> 5] >> (k & 31)) & 1, state_counts[f][k])) {
+				continue;
+			}
+
+			if (key_event_pop(&bench_events, &event) != 0 || event.key != k || event.down != keys[k].down ||
+				event.frame != (unsigned int)f) {
+				fprintf(stderr, "key state: frame %d key %d %s missing or out of order\n", f, k, keys[k].down ? "down" : "up");
+				return -1;
+			}
+			events++;
+		}
+
+		if (key_event_pop(&bench_events, &event) == 0) {
+			fprintf(stderr, "key state: frame %d has an extra event for key %d\n", f, event.key);
+			return -1;
+		}
+	}
+
+	printf("key state, %d frames          %6d events, %u chattering runs absorbed\n",
+		   BENCH_KEY_STATE_FRAMES, events, bench_state.chatter);
+	return 0;
+}
+
+// A release met by a full ring must still come out once the ring drains
+static int bench_check_key_overflow(void)
+{
+	unsigned int candidates[KEY_MAP_MASK_WORDS];
+	unsigned short counts[KEY_MAP_KEYS];
+	KeyEvent event;
+	unsigned int f = 0;
+	int i;
+
+	key_state_init(&bench_state, KEY_STATE_ON_PIXELS_DEFAULT, KEY_STATE_OFF_PIXELS_DEFAULT,
+				   KEY_STATE_ON_FRAMES_DEFAULT, KEY_STATE_OFF_FRAMES_DEFAULT);
+	key_event_init(&bench_events);
+
+	// Key 40 down
+	memset(candidates, 0, sizeof(candidates));
+	memset(counts, 0, sizeof(counts));
+	candidates[40 >> 5] = 1u << (40 & 31);
+	counts[40] = KEY_STATE_ON_PIXELS_DEFAULT;
+	for (i = 0; i < KEY_STATE_ON_FRAMES_DEFAULT; i++) {
+		key_state_update(&bench_state, candidates, counts, f++, &bench_events);
+	}
+	if (key_event_pop(&bench_events, &event) != 0 || event.key != 40 || !event.down) {
+		fprintf(stderr, "key overflow: key 40 did not go down\n");
+		return -1;
+	}
+
+	// Released into a full ring, for longer than the debounce
+	event.key = 0;
+	while (key_event_push(&bench_events, &event) == 0) {
+	}
+	bench_events.overflows = 0;
+	memset(candidates, 0, sizeof(candidates));
+	counts[40] = 0;
+	for (i = 0; i < 2 * KEY_STATE_OFF_FRAMES_DEFAULT; i++) {
+		key_state_update(&bench_state, candidates, counts, f++, &bench_events);
+	}
+	if ((bench_state.down[40 >> 5] >> (40 & 31) & 1) == 0) {
+		fprintf(stderr, "key overflow: key 40 came up with no event queued\n");
+		return -1;
+	}
+
+	while (key_event_pop(&bench_events, &event) == 0) {
+	}
+	key_state_update(&bench_state, candidates, counts, f, &bench_events);
+	if (key_event_pop(&bench_events, &event) != 0 || event.key != 40 || event.down || event.frame != f) {
+		fprintf(stderr, "key overflow: release of key 40 lost to the full ring\n");
+		return -1;
+	}
+
+	printf("key state, full ring          release held for %u refused pushes\n", bench_events.overflows);
+	return 0;
+}
+
+static double bench_key_state(int passes)
+{
+	KeyEvent event;
+	double start;
+	int p, f;
+
+	key_state_init(&bench_state, KEY_STATE_ON_PIXELS_DEFAULT, KEY_STATE_OFF_PIXELS_DEFAULT,
+				   KEY_STATE_ON_FRAMES_DEFAULT, KEY_STATE_OFF_FRAMES_DEFAULT);
+	key_event_init(&bench_events);
+	start = bench_seconds();
+
+	for (p = 0; p < passes; p++) {
+		for (f = 0; f < BENCH_KEY_STATE_FRAMES; f++) {
+			key_state_update(&bench_state, state_candidates[f], state_counts[f], (unsigned int)f, &bench_events);
+			while (key_event_pop(&bench_events, &event) == 0) {
+			}
+		}
+	}
+
+	return passes * BENCH_KEY_STATE_FRAMES / (bench_seconds() - start);
+}
+
+// Checks the key states against the reference and times them
+int bench_key_state_section(int passes)
+{
+	if (bench_check_key_state() != 0 || bench_check_key_overflow() != 0) {
+		return -1;
+	}
+
+	{
+		double fps = bench_key_state(passes > 10 ? passes / 10 : 1);
+
+		printf("%-28s %10.1f fps  %7.2f us/frame\n", "  update + drain", fps, 1e6 / fps);
+	}
+
+	return 0;
+}
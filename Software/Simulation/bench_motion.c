@@ -0,0 +1,131 @@
+/*
+*********************************************************************************************************
+*
+*                                       TILE CHANGE BENCHMARK
+*
+*                                            LINUX HOST
+*
+* Filename      : bench_motion.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : One lit spot sliding over a still keyboard, run through the detector
+* 				  (Video/key_detect.c) looking only under the tiles tile_change_detect() marks and again
+* 				  with every tile refreshed: both must pick and score the same keys on every frame, then
+* 				  both are timed.
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "../EclipseProject/VirtualPiano/Video/key_detect.h"
+#include "bench.h"
+
+// Motion sequence
+#define BENCH_MOTION_FRAMES 32
+#define BENCH_MOTION_STEP 8
+#define BENCH_MOTION_RADIUS 4
+
+static KeyDetector bench_detector, bench_full_detector;
+static unsigned char motion[BENCH_MOTION_FRAMES][FRAME_FILE_BYTES];
+
+// A still frame with one bright spot moving right a few pixels per frame
+static void bench_motion_frames(void)
+{
+	int f, x, y;
+
+	for (f = 0; f < BENCH_MOTION_FRAMES; f++) {
+		int cx = 20 + f * BENCH_MOTION_STEP;
+		int cy = (BENCH_KEYBOARD_TOP + BENCH_KEYBOARD_BOTTOM) / 2;
+
+		frame_file_synthesize(motion[f], 0);
+
+		for (y = cy - BENCH_MOTION_RADIUS; y <= cy + BENCH_MOTION_RADIUS; y++) {
+			for (x = cx - BENCH_MOTION_RADIUS; x <= cx + BENCH_MOTION_RADIUS; x++) {
+				if (x >= 0 && x < VIDEO_IN_FRAME_WIDTH) {
+					motion[f][y * VIDEO_IN_ROW_STRIDE + x] = 0xFF;
+				}
+			}
+		}
+	}
+}
+
+// A detector on full-frame zones, ready for the sequence
+static void bench_motion_start(KeyDetector *det)
+{
+	key_detect_init(det);
+	key_detect_use_uniform(det, 0, BENCH_FIRST_ROW, VIDEO_IN_FRAME_WIDTH, VIDEO_IN_FRAME_HEIGHT);
+}
+
+// One frame of the sequence, with every tile treated as changed when full
+static void bench_motion_frame(KeyDetector *det, int f, int full)
+{
+	if (full) {
+		tile_change_invalidate(&det->tiles);
+	}
+	key_detect_frame(det, motion[f], NULL);
+}
+
+// Detecting under the changed tiles alone must score and pick the same keys as every tile
+static int bench_check_motion(void)
+{
+	int f;
+
+	bench_motion_start(&bench_detector);
+	bench_motion_start(&bench_full_detector);
+
+	for (f = 0; f < BENCH_MOTION_FRAMES; f++) {
+		bench_motion_frame(&bench_detector, f, 0);
+		bench_motion_frame(&bench_full_detector, f, 1);
+
+		if (memcmp(bench_detector.key_counts, bench_full_detector.key_counts, sizeof(bench_detector.key_counts)) != 0 ||
+			memcmp(bench_detector.key_mask, bench_full_detector.key_mask, sizeof(bench_detector.key_mask)) != 0) {
+			fprintf(stderr, "tile change: frame %d keys differ from a detector refreshing every tile\n", f);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+// Runs the sequence through the detector, returns frames per second
+static double bench_motion(KeyDetector *det, int full, int passes, unsigned int *tiles_per_frame)
+{
+	double start;
+	int f, p;
+
+	bench_motion_start(det);
+	start = bench_seconds();
+
+	for (p = 0; p < passes; p++) {
+		for (f = 0; f < BENCH_MOTION_FRAMES; f++) {
+			bench_motion_frame(det, f, full);
+		}
+	}
+
+	*tiles_per_frame = det->tiles.tiles_processed / (passes * BENCH_MOTION_FRAMES);
+	return passes * BENCH_MOTION_FRAMES / (bench_seconds() - start);
+}
+
+// Checks the tile by tile detector against refreshing every tile and times both
+int bench_motion_section(int passes, double baseline)
+{
+	unsigned int tiles;
+	double fps;
+
+	bench_motion_frames();
+	if (bench_check_motion() != 0) {
+		return -1;
+	}
+
+	printf("motion sequence, full-frame zones\n");
+	fps = bench_motion(&bench_full_detector, 1, passes, &tiles);
+	printf("%-28s %10.1f fps  %7.2f us/frame  %5.1fx  %u of %d tiles/frame\n", "  detect, every tile",
+		   fps, 1e6 / fps, fps / baseline, tiles, TILE_COUNT);
+	fps = bench_motion(&bench_detector, 0, passes, &tiles);
+	printf("%-28s %10.1f fps  %7.2f us/frame  %5.1fx  %u of %d tiles/frame\n", "  detect, changed tiles",
+		   fps, 1e6 / fps, fps / baseline, tiles, TILE_COUNT);
+
+	return 0;
+}
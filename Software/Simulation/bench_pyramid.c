@@ -0,0 +1,300 @@
+/*
+*********************************************************************************************************
+*
+*                                 PYRAMID AND BACKGROUND BENCHMARK
+*
+*                                            LINUX HOST
+*
+* Filename      : bench_pyramid.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The coarse-to-fine pass (Video/pyramid.c) on the calibrated keys: its 2x2 reduction
+* 				  against plain C, then its mask, blobs and key scores against the full resolution pass
+* 				  on lit and idle frames in turn.  The running background (Video/background.c) kernels
+* 				  are checked against plain C, then the keys found against a background learned in a
+* 				  dimmed room against those the fixed threshold finds at full light.  Both passes are
+* 				  timed lit, idle and dimmed, and the background update on its own.  The frames are left
+* 				  painted out and dimmed.
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "../EclipseProject/VirtualPiano/Video/pyramid.h"
+#include "../EclipseProject/VirtualPiano/Video/background.h"
+#include "bench.h"
+
+// Background check: updates learned from dimmed idle frames before detecting
+#define BENCH_BACKGROUND_UPDATES 32
+
+static Pyramid bench_pyramid;
+static BitMask bench_pyramid_mask;
+static BlobLabeller bench_pyramid_blobs;
+static unsigned int bench_full_keys[KEY_MAP_MASK_WORDS], bench_pyramid_keys[KEY_MAP_MASK_WORDS];
+static unsigned char idle_frame[FRAME_FILE_BYTES];
+static unsigned char dim_frame[FRAME_FILE_BYTES];
+static Background bench_background;
+
+// KeyDetectTask's pass before the pyramid: the whole keyboard at full resolution
+static void bench_full_pass(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	unsigned int pressed[KEY_MAP_MASK_WORDS];
+
+	(void)out;
+	bit_mask_build(&bench_mask, frame, VIDEO_IN_ROW_STRIDE, bench_map.top, bench_map.bottom, &bench_lut);
+	blob_label(&bench_blobs, &bench_mask, bench_map.left, bench_map.top, bench_map.right, bench_map.bottom);
+	blob_keys(&bench_blobs, bench_labels, bench_full_keys);
+	bit_mask_score_keys(&bench_key_bits, &bench_mask, key_counts, pressed);
+}
+
+// The same through the pyramid, full resolution only under hot level 1 pixels
+static void bench_pyramid_pass(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	unsigned int pressed[KEY_MAP_MASK_WORDS];
+
+	(void)out;
+	if (pyramid_build(&bench_pyramid, frame, VIDEO_IN_ROW_STRIDE,
+					  bench_map.left, bench_map.top, bench_map.right, bench_map.bottom) == 0) {
+		bench_pyramid_blobs.num_blobs = 0;
+		memset(bench_pyramid_keys, 0, sizeof(bench_pyramid_keys));
+		memset(key_counts, 0, KEY_MAP_KEYS * sizeof(unsigned short));
+		return;
+	}
+
+	pyramid_refine(&bench_pyramid, &bench_pyramid_mask, frame, VIDEO_IN_ROW_STRIDE, &bench_lut);
+	blob_label(&bench_pyramid_blobs, &bench_pyramid_mask,
+			   bench_pyramid.x0, bench_pyramid.y0, bench_pyramid.x1, bench_pyramid.y1);
+	blob_keys(&bench_pyramid_blobs, bench_labels, bench_pyramid_keys);
+	bit_mask_score_keys(&bench_key_bits, &bench_pyramid_mask, key_counts, pressed);
+}
+
+// Paints the bright pixels of a frame the colour of a white key
+static void bench_paint_out(const unsigned char *frame, unsigned char *out)
+{
+	int i;
+
+	for (i = 0; i < FRAME_FILE_BYTES; i++) {
+		out[i] = PIXEL_LUT_BRIGHT(&bench_lut, frame[i]) ? 0xDB : frame[i];		// RGB332(6, 6, 3)
+	}
+}
+
+static int bench_check_pyramid(int num_frames)
+{
+	static const int offsets[3] = { 0, 1, 7 };
+	unsigned char out[PYRAMID_WIDTH], out_check[PYRAMID_WIDTH];
+	unsigned short full_counts[KEY_MAP_KEYS], pyramid_counts[KEY_MAP_KEYS];
+	unsigned int hot_rows = 0, words = 0;
+	int f, i, x, y;
+
+	// Vector reduction against plain C, at odd starts and lengths for the tails
+	for (f = 0; f < num_frames; f++) {
+		for (y = 0; y < VIDEO_IN_FRAME_HEIGHT; y += 2) {
+			for (i = 0; i < 3; i++) {
+				const unsigned char *row = bench_frames[f] + y * VIDEO_IN_ROW_STRIDE + offsets[i];
+				int count = PYRAMID_WIDTH - offsets[i];
+
+				if (video_brightness_2x2(row, row + VIDEO_IN_ROW_STRIDE, count, out) !=
+					video_brightness_2x2_scalar(row, row + VIDEO_IN_ROW_STRIDE, count, out_check) ||
+					memcmp(out, out_check, count) != 0) {
+					fprintf(stderr, "pyramid: frame %d row %d offset %d reduction differs from plain C\n",
+							f, y, offsets[i]);
+					return -1;
+				}
+			}
+		}
+	}
+
+	// Lit, idle and lit again, so words packed for one frame must be cleared for the next
+	pyramid_init(&bench_pyramid, &bench_lut);
+	memset(&bench_pyramid_mask, 0, sizeof(bench_pyramid_mask));
+	blob_init(&bench_pyramid_blobs, KEY_MAP_MIN_PIXELS_DEFAULT);
+
+	for (f = 0; f < 3 * num_frames; f++) {
+		const unsigned char *frame = bench_frames[(f / 3 + (f % 3 == 2)) % num_frames];
+
+		if (f % 3 == 1) {
+			bench_paint_out(bench_frames[f / 3], idle_frame);
+			frame = idle_frame;
+		}
+
+		bench_full_pass(frame, bench_screen, full_counts);
+		bench_pyramid_pass(frame, bench_screen, pyramid_counts);
+		hot_rows += bench_pyramid.num_hot_rows;
+
+		// An idle frame leaves the mask unread until the next refine clears it
+		for (y = bench_map.top; y < bench_map.bottom && bench_pyramid.num_hot_rows > 0; y++) {
+			for (x = bench_map.left; x < bench_map.right; x++) {
+				if (BIT_MASK_TEST(&bench_mask, x, y) != BIT_MASK_TEST(&bench_pyramid_mask, x, y)) {
+					fprintf(stderr, "pyramid: step %d pixel (%d, %d) differs from the full pass\n", f, x, y);
+					return -1;
+				}
+			}
+		}
+
+		if (bench_blobs.num_blobs != bench_pyramid_blobs.num_blobs ||
+			memcmp(bench_blobs.blobs, bench_pyramid_blobs.blobs, bench_blobs.num_blobs * sizeof(Blob)) != 0 ||
+			memcmp(bench_full_keys, bench_pyramid_keys, sizeof(bench_full_keys)) != 0 ||
+			memcmp(full_counts, pyramid_counts, sizeof(full_counts)) != 0) {
+			fprintf(stderr, "pyramid: step %d blobs or keys differ from the full pass\n", f);
+			return -1;
+		}
+	}
+
+	words = bench_pyramid.words_packed;
+	printf("pyramid, threshold %2d         %d steps, %u idle, %.1f hot rows and %.1f words/step\n",
+		   bench_pyramid.threshold, 3 * num_frames, bench_pyramid.idle_frames,
+		   (double)hot_rows / (3 * num_frames), (double)words / (3 * num_frames));
+	return 0;
+}
+
+// The room at three quarters of the light: every channel scaled by 3/4
+static void bench_dim(const unsigned char *frame, unsigned char *out)
+{
+	int i;
+
+	for (i = 0; i < FRAME_FILE_BYTES; i++) {
+		int r = ((frame[i] >> 5) & 0x07) * 3 / 4, g = ((frame[i] >> 2) & 0x07) * 3 / 4, b = (frame[i] & 0x03) * 3 / 4;
+
+		out[i] = (unsigned char)((r << 5) | (g << 2) | b);
+	}
+}
+
+static int bench_check_background(int num_frames)
+{
+	unsigned short means[PYRAMID_WIDTH + 7], means_check[PYRAMID_WIDTH + 7], counts[KEY_MAP_KEYS];
+	unsigned char samples[PYRAMID_WIDTH + 7], limits[PYRAMID_WIDTH + 7], limits_check[PYRAMID_WIDTH + 7];
+	unsigned int seed = 12345, full_keys = 0, fixed_keys = 0, background_keys = 0;
+	int i, f, x, y, count, shift;
+
+	// Kernels against plain C on random means and samples, every length up to a row plus a tail
+	for (count = 0; count <= PYRAMID_WIDTH + 7; count++) {
+		for (shift = 0; shift < 10; shift++) {
+			for (i = 0; i < count; i++) {
+				seed = seed * 1103515245u + 12345u;
+				samples[i] = (unsigned char)((seed >> 16) % 18);
+				means[i] = means_check[i] = (unsigned short)((seed >> 8) % (18 * 256));
+				limits[i] = (unsigned char)((seed >> 4) % 18);
+			}
+
+			if (video_any_above(samples, limits, count) != video_any_above_scalar(samples, limits, count)) {
+				fprintf(stderr, "background: %d value compare differs from plain C\n", count);
+				return -1;
+			}
+
+			video_ema_q8(means, samples, count, shift, shift + 3, BACKGROUND_DELTA_DEFAULT, limits);
+			video_ema_q8_scalar(means_check, samples, count, shift, shift + 3, BACKGROUND_DELTA_DEFAULT, limits_check);
+			if (memcmp(means, means_check, count * sizeof(means[0])) != 0 || memcmp(limits, limits_check, count) != 0) {
+				fprintf(stderr, "background: %d means with shift %d differ from plain C\n", count, shift);
+				return -1;
+			}
+		}
+	}
+
+	// Learn the keyboard with nothing lit in a dim room
+	pyramid_init(&bench_pyramid, &bench_lut);
+	memset(&bench_pyramid_mask, 0, sizeof(bench_pyramid_mask));
+	background_init(&bench_background, BACKGROUND_SHIFT_DEFAULT, BACKGROUND_HOT_SHIFT_DEFAULT, BACKGROUND_DELTA_DEFAULT);
+	for (i = 0; i < BENCH_BACKGROUND_UPDATES; i++) {
+		bench_paint_out(bench_frames[i % num_frames], idle_frame);
+		bench_dim(idle_frame, dim_frame);
+		pyramid_build(&bench_pyramid, dim_frame, VIDEO_IN_ROW_STRIDE,
+					  bench_map.left, bench_map.top, bench_map.right, bench_map.bottom);
+		background_update(&bench_background, &bench_pyramid);
+	}
+
+	// Lit keys found in the dim room: fixed threshold, then against the background
+	for (f = 0; f < num_frames; f++) {
+		bench_full_pass(bench_frames[f], bench_screen, counts);
+		for (i = 0; i < KEY_MAP_MASK_WORDS; i++) {
+			full_keys += bit_mask_popcount(bench_full_keys[i]);
+		}
+
+		bench_dim(bench_frames[f], dim_frame);
+		pyramid_use_limits(&bench_pyramid, NULL);
+		bench_pyramid_pass(dim_frame, bench_screen, counts);
+		for (i = 0; i < KEY_MAP_MASK_WORDS; i++) {
+			fixed_keys += bit_mask_popcount(bench_pyramid_keys[i]);
+		}
+
+		pyramid_use_limits(&bench_pyramid, bench_background.limits);
+		bench_pyramid_pass(dim_frame, bench_screen, counts);
+		for (i = 0; i < KEY_MAP_MASK_WORDS; i++) {
+			background_keys += bit_mask_popcount(bench_pyramid_keys[i]);
+		}
+
+		if (memcmp(bench_full_keys, bench_pyramid_keys, sizeof(bench_full_keys)) != 0) {
+			fprintf(stderr, "background: frame %d keys in the dim room differ from full light\n", f);
+			return -1;
+		}
+
+		// The two levels agree: every lit pixel in the window was packed
+		for (y = bench_map.top; y < bench_map.bottom && bench_pyramid.num_hot_rows > 0; y++) {
+			for (x = bench_map.left; x < bench_map.right; x++) {
+				const unsigned char *row = dim_frame + y * VIDEO_IN_ROW_STRIDE;
+				int sum = ((row[x] >> 5) & 0x07) + ((row[x] >> 2) & 0x07) + (row[x] & 0x03);
+				int lit = sum > bench_background.limits[(y >> 1) * PYRAMID_WIDTH + (x >> 1)];
+
+				if ((int)BIT_MASK_TEST(&bench_pyramid_mask, x, y) != lit) {
+					fprintf(stderr, "background: frame %d pixel (%d, %d) differs from its limit\n", f, x, y);
+					return -1;
+				}
+			}
+		}
+	}
+
+	printf("background, dimmed to 3/4     %u keys lit at full light, %u found by threshold, %u by background\n",
+		   full_keys, fixed_keys, background_keys);
+	pyramid_use_limits(&bench_pyramid, NULL);
+	return 0;
+}
+
+// Learns the window of the last pyramid build
+static void bench_background_update(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	(void)frame;
+	(void)out;
+	(void)key_counts;
+	background_update(&bench_background, &bench_pyramid);
+}
+
+// Checks the pyramid and the background against the full pass and times both
+int bench_pyramid_section(int num_frames, int passes, double baseline)
+{
+	int f;
+
+	bit_mask_build_keys(&bench_key_bits, &bench_map);
+	if (bench_check_pyramid(num_frames) != 0) {
+		return -1;
+	}
+
+	if (bench_check_background(num_frames) != 0) {
+		return -1;
+	}
+
+	{
+		double full_fps, pyramid_fps;
+
+		bench_run("  full pass, lit", bench_full_pass, num_frames, passes, baseline, 0);
+		bench_run("  pyramid, lit", bench_pyramid_pass, num_frames, passes, baseline, 0);
+
+		// The frames are not needed lit after this
+		for (f = 0; f < num_frames; f++) {
+			bench_paint_out(bench_frames[f], bench_frames[f]);
+		}
+		full_fps = bench_run("  full pass, idle", bench_full_pass, num_frames, passes, baseline, 0);
+		pyramid_fps = bench_run("  pyramid, idle", bench_pyramid_pass, num_frames, passes, baseline, 0);
+		printf("%-28s %10.2f of the full pass\n", "  idle pyramid time", full_fps / pyramid_fps);
+
+		// The background learned above, on the idle frames dimmed like it
+		for (f = 0; f < num_frames; f++) {
+			bench_dim(bench_frames[f], bench_frames[f]);
+		}
+		pyramid_use_limits(&bench_pyramid, bench_background.limits);
+		bench_run("  pyramid, dim, background", bench_pyramid_pass, num_frames, passes, baseline, 0);
+		bench_run("  background update", bench_background_update, num_frames, passes, baseline, 0);
+	}
+
+	return 0;
+}
@@ -0,0 +1,194 @@
+/*
+*********************************************************************************************************
+*
+*                                    PERSPECTIVE REMAP BENCHMARK
+*
+*                                            LINUX HOST
+*
+* Filename      : bench_remap.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Draws the synthetic keyboard at an angle and checks the perspective remap
+* 				  (Video/remap.c) maps the corners of its strip onto the outline and back, that
+* 				  key_cal_find_outline() finds the outline drawn, and that every key calibrated in the
+* 				  rectified strip maps back onto the same key of the straight calibration the key
+* 				  calibration section left in bench_labels.  Then the strip gather is timed.
+*
+*********************************************************************************************************
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../EclipseProject/VirtualPiano/Video/key_cal.h"
+#include "../EclipseProject/VirtualPiano/Video/remap.h"
+#include "bench.h"
+
+static Remap bench_remap, bench_skew;
+static KeyCal bench_rect_cal;
+static unsigned char skew_frame[FRAME_FILE_BYTES];
+static unsigned char rect_frame[FRAME_FILE_BYTES];
+
+// The synthetic keyboard seen from in front and above, the far (black key) end narrower
+static const short bench_skew_corners[8] = { 25, 100, 295, 100, 315, 200, 5, 200 };
+
+// Unit square position of a frame position under bench_skew, through the inverse homography
+static void bench_unskew(float x, float y, float *s, float *t)
+{
+	const float *h = bench_skew.h;
+	float i0 = h[4] * h[8] - h[5] * h[7], i1 = h[2] * h[7] - h[1] * h[8], i2 = h[1] * h[5] - h[2] * h[4];
+	float i3 = h[5] * h[6] - h[3] * h[8], i4 = h[0] * h[8] - h[2] * h[6], i5 = h[2] * h[3] - h[0] * h[5];
+	float i6 = h[3] * h[7] - h[4] * h[6], i7 = h[1] * h[6] - h[0] * h[7], i8 = h[0] * h[4] - h[1] * h[3];
+	float w = i6 * x + i7 * y + i8;
+
+	*s = (i0 * x + i1 * y + i2) / w;
+	*t = (i3 * x + i4 * y + i5) / w;
+}
+
+// Draws the keyboard of a synthetic frame into the skewed outline.  A frame pixel takes the
+// keyboard pixel under its centre, or the darkest other than black whose centre its width
+// covers, as a lens would blur the one pixel gaps between white keys rather than step over them;
+// outside the outline it is the background above the keys.
+static void bench_skew_frame(const unsigned char *flat, unsigned char *out)
+{
+	int x, y;
+
+	for (y = 0; y < VIDEO_IN_FRAME_HEIGHT; y++) {
+		for (x = 0; x < VIDEO_IN_ROW_STRIDE; x++) {
+			unsigned char pixel = flat[(y % BENCH_KEYBOARD_TOP) * VIDEO_IN_ROW_STRIDE + x];
+			float s0, s1, t;
+
+			bench_unskew(x + 0.5f, y + 0.5f, &s0, &t);
+			if (x < VIDEO_IN_FRAME_WIDTH && s0 >= 0.0f && s0 < 1.0f && t >= 0.0f && t < 1.0f) {
+				const unsigned char *row = flat + (BENCH_KEYBOARD_TOP + (int)(t * (BENCH_KEYBOARD_BOTTOM - BENCH_KEYBOARD_TOP))) * VIDEO_IN_ROW_STRIDE;
+				int fx;
+
+				pixel = row[(int)(s0 * VIDEO_IN_FRAME_WIDTH)];
+				bench_unskew(x + 1.0f, y + 0.5f, &s1, &t);
+				bench_unskew(x + 0.0f, y + 0.5f, &s0, &t);
+				for (fx = (int)(s0 * VIDEO_IN_FRAME_WIDTH); fx < VIDEO_IN_FRAME_WIDTH && fx + 0.5f < s1 * VIDEO_IN_FRAME_WIDTH; fx++) {
+					if (fx + 0.5f >= s0 * VIDEO_IN_FRAME_WIDTH && row[fx] != 0 && row[fx] < pixel) {
+						pixel = row[fx];
+					}
+				}
+			}
+			out[y * VIDEO_IN_ROW_STRIDE + x] = pixel;
+		}
+	}
+}
+
+// Calibrates the synthetic keyboard seen at an angle through its rectified strip: the outline
+// must match the drawing, and every key found in the strip must map back onto the same key of
+// the straight calibration
+static int bench_check_remap(void)
+{
+	static const unsigned char black_note[12] = { 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1 };	// from A
+	short corners[8];
+	float x, y, s, t;
+	int result, i, k;
+
+	if (remap_init(&bench_skew, bench_skew_corners, VIDEO_IN_ROW_STRIDE) != 0) {
+		fprintf(stderr, "remap: drawing outline rejected\n");
+		return -1;
+	}
+
+	// Corners of the strip land on the corners of the outline, and back
+	for (i = 0; i < 4; i++) {
+		float u = (i == 1 || i == 2) ? (float)bench_skew.width : 0.0f;
+		float v = i >= 2 ? (float)bench_skew.height : 0.0f;
+
+		remap_point(&bench_skew, u, v, &x, &y);
+		bench_unskew(x, y, &s, &t);
+		if (fabsf(x - bench_skew_corners[2 * i]) > 0.01f || fabsf(y - bench_skew_corners[2 * i + 1]) > 0.01f ||
+			fabsf(s - u / bench_skew.width) > 0.001f || fabsf(t - v / bench_skew.height) > 0.001f) {
+			fprintf(stderr, "remap: corner %d maps to (%.2f, %.2f), back to (%.3f, %.3f)\n", i, x, y, s, t);
+			return -1;
+		}
+	}
+
+	bench_skew_frame(bench_frames[BENCH_CAL_FRAME], skew_frame);
+	result = key_cal_find(&bench_rect_cal, skew_frame, VIDEO_IN_ROW_STRIDE, &bench_lut);
+	printf("remap, keyboard at an angle   straight calibration %s (%d)\n",
+		   result == KEY_CAL_OK ? "succeeds" : "fails", result);
+
+	result = key_cal_find_outline(skew_frame, VIDEO_IN_ROW_STRIDE, &bench_lut, corners);
+	if (result != KEY_CAL_OK) {
+		fprintf(stderr, "remap: outline not found (%d)\n", result);
+		return -1;
+	}
+	for (i = 0; i < 8; i++) {
+		if (abs(corners[i] - bench_skew_corners[i]) > 2) {
+			fprintf(stderr, "remap: outline corner %d at (%d, %d), drawn at (%d, %d)\n", i / 2,
+					corners[i & ~1], corners[i | 1], bench_skew_corners[i & ~1], bench_skew_corners[i | 1]);
+			return -1;
+		}
+	}
+
+	if (remap_init(&bench_remap, corners, VIDEO_IN_ROW_STRIDE) != 0) {
+		fprintf(stderr, "remap: outline found rejected\n");
+		return -1;
+	}
+
+	memset(rect_frame, 0, sizeof(rect_frame));
+	remap_frame(&bench_remap, skew_frame, rect_frame, VIDEO_IN_ROW_STRIDE);
+	result = key_cal_find(&bench_rect_cal, rect_frame, VIDEO_IN_ROW_STRIDE, &bench_lut);
+	if (result != KEY_CAL_OK) {
+		fprintf(stderr, "remap: keys not found in the rectified strip (%d)\n", result);
+		return -1;
+	}
+
+	// The centre of each key goes through the outline found and back through the drawn one
+	for (k = 0; k < KEY_MAP_KEYS; k++) {
+		const KeyCalKey *key = &bench_rect_cal.keys[k];
+		float v = key->black ? (bench_rect_cal.top + bench_rect_cal.split) / 2.0f :
+							   (bench_rect_cal.split + bench_rect_cal.bottom) / 2.0f;
+
+		if (key->black != black_note[k % 12]) {
+			fprintf(stderr, "remap: key %d is %s\n", k, key->black ? "black" : "white");
+			return -1;
+		}
+
+		remap_point(&bench_remap, (key->top_x0 + key->top_x1) / 2.0f, v, &x, &y);
+		bench_unskew(x, y, &s, &t);
+		x = s * VIDEO_IN_FRAME_WIDTH;
+		y = BENCH_KEYBOARD_TOP + t * (BENCH_KEYBOARD_BOTTOM - BENCH_KEYBOARD_TOP);
+		if (x < 0.0f || x >= VIDEO_IN_FRAME_WIDTH || y < 0.0f || y >= VIDEO_IN_FRAME_HEIGHT ||
+			bench_labels[(int)y * VIDEO_IN_FRAME_WIDTH + (int)x] != k) {
+			fprintf(stderr, "remap: key %d maps to (%.1f, %.1f) of the straight keyboard\n", k, x, y);
+			return -1;
+		}
+	}
+
+	bench_rect_cal.rectified = 1;
+	memcpy(bench_rect_cal.corners, corners, sizeof(corners));
+	key_cal_seal(&bench_rect_cal);
+	if (!key_cal_valid(&bench_rect_cal)) {
+		fprintf(stderr, "remap: rectified calibration fails its checksum\n");
+		return -1;
+	}
+
+	printf("remap, strip %3d x %3d        %6d px, outline (%d, %d) (%d, %d) (%d, %d) (%d, %d)\n",
+		   bench_remap.width, bench_remap.height, bench_remap.width * bench_remap.height,
+		   corners[0], corners[1], corners[2], corners[3], corners[4], corners[5], corners[6], corners[7]);
+	return 0;
+}
+
+static void bench_remap_frame(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	(void)out;
+	(void)key_counts;
+	remap_frame(&bench_remap, frame, rect_frame, VIDEO_IN_ROW_STRIDE);
+}
+
+// Checks the remap of the keyboard at an angle and times the gather
+int bench_remap_section(int num_frames, int passes, double baseline)
+{
+	if (bench_check_remap() != 0) {
+		return -1;
+	}
+	bench_run("  gather strip", bench_remap_frame, num_frames, passes, baseline, 0);
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+/*
+*********************************************************************************************************
+*
+*                                  THRESHOLD AND KEY MAP BENCHMARK
+*
+*                                            LINUX HOST
+*
+* Filename      : bench_threshold.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The original KeyDetectTask loop (video_in_read_pixel() per pixel, x outermost)
+* 				  against the row-major threshold kernel of Video/video_kernel.c, in plain C and
+* 				  vectorized, every variant's screen and per-key counts checked against the original.
+* 				  Then key_map_detect() (Video/key_map.c) on full-width zones, checked against the same
+* 				  counts, and timed on keyboard rectangles and slanted polygons.
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+
+static void bench_columns_to_keys(const unsigned short *column_counts, unsigned short *key_counts)
+{
+	int i;
+
+	memset(key_counts, 0, BENCH_KEYS * sizeof(unsigned short));
+
+	for (i = 0; i < VIDEO_IN_FRAME_WIDTH; i++) {
+		key_counts[i * BENCH_KEYS / VIDEO_IN_FRAME_WIDTH] += column_counts[i];
+	}
+}
+
+static void bench_scalar(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	unsigned short column_counts[VIDEO_IN_FRAME_WIDTH] = { 0 };
+
+	video_threshold_rows_scalar(frame, VIDEO_IN_ROW_STRIDE, out + BENCH_SCREEN_OFFSET, VGA_Y,
+								VIDEO_IN_FRAME_WIDTH, BENCH_FIRST_ROW, VIDEO_IN_FRAME_HEIGHT,
+								VIDEO_THRESHOLD_DEFAULT, VIDEO_MARKER_RED, column_counts);
+	bench_columns_to_keys(column_counts, key_counts);
+}
+
+static void bench_vector(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	unsigned short column_counts[VIDEO_IN_FRAME_WIDTH] = { 0 };
+
+	video_threshold_rows(frame, VIDEO_IN_ROW_STRIDE, out + BENCH_SCREEN_OFFSET, VGA_Y,
+						 VIDEO_IN_FRAME_WIDTH, BENCH_FIRST_ROW, VIDEO_IN_FRAME_HEIGHT,
+						 VIDEO_THRESHOLD_DEFAULT, VIDEO_MARKER_RED, column_counts);
+	bench_columns_to_keys(column_counts, key_counts);
+}
+
+static void bench_key_map(const unsigned char *frame, unsigned char *out, unsigned short *key_counts)
+{
+	unsigned int mask[KEY_MAP_MASK_WORDS];
+
+	(void)out;
+	key_map_detect(&bench_map, frame, VIDEO_IN_ROW_STRIDE, key_counts, mask);
+}
+
+// Checks every threshold variant and times them and the key map, returns the baseline
+double bench_threshold_section(int num_frames, int passes)
+{
+	double baseline;
+
+	baseline = bench_run("original (column-major)", bench_original, num_frames, passes, 0.0, BENCH_CHECK_ALL);
+	if (baseline < 0.0 ||
+		bench_run("row-major scalar", bench_scalar, num_frames, passes, baseline, BENCH_CHECK_ALL) < 0.0 ||
+#if defined(VIDEO_KERNEL_NEON)
+		bench_run("row-major NEON", bench_vector, num_frames, passes, baseline, BENCH_CHECK_ALL) < 0.0) {
+#elif defined(VIDEO_KERNEL_SSE2)
+		bench_run("row-major SSE2", bench_vector, num_frames, passes, baseline, BENCH_CHECK_ALL) < 0.0) {
+#else
+		bench_run("row-major (no SIMD)", bench_vector, num_frames, passes, baseline, BENCH_CHECK_ALL) < 0.0) {
+#endif
+		return -1.0;
+	}
+
+	key_map_init_uniform(&bench_map, 0, BENCH_FIRST_ROW, VIDEO_IN_FRAME_WIDTH, VIDEO_IN_FRAME_HEIGHT);
+	printf("key map, full-frame zones    %6u px\n", bench_map.area);
+	if (bench_run("  detect", bench_key_map, num_frames, passes, baseline, BENCH_CHECK_COUNTS) < 0.0) {
+		return -1.0;
+	}
+
+	key_map_init_uniform(&bench_map, 0, BENCH_KEYBOARD_TOP, VIDEO_IN_FRAME_WIDTH, BENCH_KEYBOARD_BOTTOM);
+	printf("key map, keyboard rectangles %6u px\n", bench_map.area);
+	bench_run("  detect", bench_key_map, num_frames, passes, baseline, 0);
+
+	bench_slanted_map(&bench_map);
+	printf("key map, keyboard polygons   %6u px, %d spans\n", bench_map.area, bench_map.num_spans);
+	bench_run("  detect", bench_key_map, num_frames, passes, baseline, 0);
+
+	return baseline;
+}
@@ -0,0 +1,170 @@
+/*
+*********************************************************************************************************
+*
+*                                      RECORDED VIDEO-IN FRAMES
+*
+*                                            LINUX HOST
+*
+* Filename      : frame_file.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "frame_file.h"
+
+// Synthetic scene
+#define SYNTH_KEYBOARD_TOP 120
+#define SYNTH_KEYBOARD_BOTTOM 220
+#define SYNTH_BLACK_KEY_BOTTOM 180
+#define SYNTH_WHITE_KEYS 52
+#define SYNTH_LIT_KEYS 3
+#define SYNTH_LED_RADIUS 4
+
+#define RGB332(r, g, b) (unsigned char)(((r) << 5) | ((g) << 2) | (b))
+
+int frame_file_load(const char *file_name, unsigned char *frame)
+{
+	FILE *file = fopen(file_name, "rb");
+	long size;
+	int y;
+
+	if (file == NULL) {
+		return -1;
+	}
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	memset(frame, 0, FRAME_FILE_BYTES);
+
+	if (size == FRAME_FILE_BYTES) {
+		if (fread(frame, 1, FRAME_FILE_BYTES, file) != FRAME_FILE_BYTES) {
+			size = -1;
+		}
+	}
+	else if (size == FRAME_FILE_PACKED_BYTES) {
+		for (y = 0; y < VIDEO_IN_FRAME_HEIGHT; y++) {
+			if (fread(frame + y * VIDEO_IN_ROW_STRIDE, 1, VIDEO_IN_FRAME_WIDTH, file) != VIDEO_IN_FRAME_WIDTH) {
+				size = -1;
+				break;
+			}
+		}
+	}
+	else {
+		size = -1;
+	}
+
+	fclose(file);
+	return size < 0 ? -1 : 0;
+}
+
+int frame_file_count(const char *file_name)
+{
+	FILE *file = fopen(file_name, "rb");
+	long size;
+
+	if (file == NULL) {
+		return 0;
+	}
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fclose(file);
+
+	return size > 0 && size % FRAME_FILE_BYTES == 0 ? (int)(size / FRAME_FILE_BYTES) : 0;
+}
+
+int frame_file_load_index(const char *file_name, int index, unsigned char *frame)
+{
+	FILE *file = fopen(file_name, "rb");
+	int result = -1;
+
+	if (file == NULL) {
+		return -1;
+	}
+
+	if (fseek(file, (long)index * FRAME_FILE_BYTES, SEEK_SET) == 0 &&
+		fread(frame, 1, FRAME_FILE_BYTES, file) == FRAME_FILE_BYTES) {
+		result = 0;
+	}
+
+	fclose(file);
+	return result;
+}
+
+int frame_file_save(const char *file_name, const unsigned char *frame)
+{
+	FILE *file = fopen(file_name, "wb");
+	size_t written;
+
+	if (file == NULL) {
+		return -1;
+	}
+
+	written = fwrite(frame, 1, FRAME_FILE_BYTES, file);
+	fclose(file);
+	return written == FRAME_FILE_BYTES ? 0 : -1;
+}
+
+void frame_file_synthesize(unsigned char *frame, unsigned int seed)
+{
+	unsigned int noise = seed * 2654435761u + 1;
+	int lit[SYNTH_LIT_KEYS];
+	int x, y, k;
+
+	for (k = 0; k < SYNTH_LIT_KEYS; k++) {
+		noise = noise * 1103515245u + 12345u;
+		lit[k] = (int)((noise >> 16) % SYNTH_WHITE_KEYS);
+	}
+
+	for (y = 0; y < VIDEO_IN_FRAME_HEIGHT; y++) {
+		unsigned char *row = frame + y * VIDEO_IN_ROW_STRIDE;
+
+		for (x = 0; x < VIDEO_IN_ROW_STRIDE; x++) {
+			unsigned char pixel = RGB332(1, 1, 1);
+
+			if (x >= VIDEO_IN_FRAME_WIDTH) {
+				pixel = 0;
+			}
+			else if (y >= SYNTH_KEYBOARD_TOP && y < SYNTH_KEYBOARD_BOTTOM) {
+				int key_width = VIDEO_IN_FRAME_WIDTH * 16 / SYNTH_WHITE_KEYS;
+				int offset = (x * 16) % key_width;
+				int white = (x * 16) / key_width;
+				int note = (white + 5) % 7;
+
+				// White keys are light grey under r + g + b = 16, separated by dark gaps
+				pixel = offset < 16 ? RGB332(1, 1, 0) : RGB332(6, 6, 3);
+
+				// Black keys sit on the boundary after C, D, F, G and A, from A0 up to C8
+				if (y < SYNTH_BLACK_KEY_BOTTOM && note != 2 && note != 6 && offset > key_width * 2 / 3 &&
+					white < SYNTH_WHITE_KEYS - 1) {
+					pixel = RGB332(0, 0, 0);
+				}
+				if (y < SYNTH_BLACK_KEY_BOTTOM && note != 0 && note != 3 && offset < key_width / 3 && white > 0) {
+					pixel = RGB332(0, 0, 0);
+				}
+
+				// Saturated LED spot in the middle of a lit key
+				for (k = 0; k < SYNTH_LIT_KEYS; k++) {
+					int cx = (lit[k] * key_width + key_width / 2) / 16;
+					int cy = (SYNTH_BLACK_KEY_BOTTOM + SYNTH_KEYBOARD_BOTTOM) / 2;
+
+					if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= SYNTH_LED_RADIUS * SYNTH_LED_RADIUS) {
+						pixel = RGB332(7, 7, 3);
+					}
+				}
+			}
+
+			// Sensor noise flips the low bits now and then
+			noise = noise * 1103515245u + 12345u;
+			if (x < VIDEO_IN_FRAME_WIDTH && ((noise >> 24) & 0x1f) == 0) {
+				pixel ^= (unsigned char)((noise >> 8) & 0x25);
+			}
+
+			row[x] = pixel;
+		}
+	}
+}
@@ -0,0 +1,46 @@
+/*
+*********************************************************************************************************
+*
+*                                      RECORDED VIDEO-IN FRAMES
+*
+*                                            LINUX HOST
+*
+* Filename      : frame_file.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : A recorded frame is a raw dump of the video-in buffer: 240 rows of RGB332 pixels, 512
+* 				  bytes apart with 320 pixels used.  Dumps taken from the board and files written by
+* 				  ImageProcessing/make_frames.py are both in this layout; a packed 320x240 file is
+* 				  accepted too.  A recorded session is raw dumps back to back, one per captured frame,
+* 				  as make_frames.py -o writes.  When no recording is at hand, frame_file_synthesize() draws an 88 key
+* 				  keyboard, A0 to C8, with a few lit keys so the harnesses still have something to
+* 				  chew on.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __FRAME_FILE_H__
+#define __FRAME_FILE_H__
+
+#include "../EclipseProject/VirtualPiano/Video/video.h"
+
+#define FRAME_FILE_BYTES (VIDEO_IN_FRAME_HEIGHT * VIDEO_IN_ROW_STRIDE)
+#define FRAME_FILE_PACKED_BYTES (VIDEO_IN_FRAME_HEIGHT * VIDEO_IN_FRAME_WIDTH)
+
+// Reads a recorded frame into frame[FRAME_FILE_BYTES], returns 0 on success
+int frame_file_load(const char *file_name, unsigned char *frame);
+
+// Number of raw video-in dumps in a session file, 0 if its size is not a whole number of them
+int frame_file_count(const char *file_name);
+
+// Reads frame index of a session file into frame[FRAME_FILE_BYTES], returns 0 on success
+int frame_file_load_index(const char *file_name, int index, unsigned char *frame);
+
+// Writes frame[FRAME_FILE_BYTES] as a raw video-in dump, returns 0 on success
+int frame_file_save(const char *file_name, const unsigned char *frame);
+
+// Draws a synthetic keyboard frame, seed picks the lit keys and the sensor noise
+void frame_file_synthesize(unsigned char *frame, unsigned int seed);
+
+#endif /* __FRAME_FILE_H__ */
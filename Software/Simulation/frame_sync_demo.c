@@ -0,0 +1,263 @@
+/*
+*********************************************************************************************************
+*
+*                                    VIDEO-IN FRAME SYNC DEMO
+*
+*                                            LINUX HOST
+*
+* Filename      : frame_sync_demo.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Runs the capture loop against a simulated Video-In DMA controller completing NTSC frames
+* 				  every 33.367 ms, one 1 ms OS tick at a time.  "sync" polls the controller every tick
+* 				  with frame_sync_poll() and wakes capture when it posts, as FrameSyncTask does; "sleep"
+* 				  sleeps a fixed 33 ticks between captures, as CaptureTask used to.  Every 10th frame a
+* 				  higher priority task holds the CPU for the given number of ticks.
+*
+* 				  The mean and worst time from a frame completing to capture copying it, the frames
+* 				  copied twice or never and, for "sync", the frame_sync counters are printed.
+*
+* 				  With "sync", capture copies into a frame ring of the given depth and a lower priority
+* 				  detection task takes a frame from it by the given policy and holds it for the given
+* 				  number of ticks, as KeyDetectTask does.  Detection checks that the frame numbers it
+* 				  takes only increase and that a frame is not rewritten while it holds it, and the
+* 				  mean and worst age of the frames it starts on and the ring counters are printed.
+*
+* 				  Usage: ./frame_sync_demo [sync|sleep] [target fps] [stall ticks] [detect ticks]
+* 				                           [ring depth] [newest|oldest]
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../EclipseProject/VirtualPiano/Video/frame_sync.h"
+#include "../EclipseProject/VirtualPiano/Video/frame_ring.h"
+#include "host_mmio.h"
+
+#define DEMO_FRAMES 300
+#define DEMO_FRAME_US 33367
+#define DEMO_TICK_US 1000
+#define DEMO_TICKS_PER_SEC 1000
+#define DEMO_SLEEP_TICKS 33
+#define DEMO_LATE_TICKS 4
+#define DEMO_STALL_EVERY 10
+
+// Simulated Video-In DMA controller
+#define DEMO_VIDEO_IN_BASE 0xFF203060
+#define DEMO_VIDEO_IN_SPAN 0x20
+#define DEMO_BUFFER_ADDR 0xC8000000
+
+typedef struct {
+	uint32_t        buffer, back, status;
+	unsigned int    frame;			// frames completed
+	uint64_t        done_us;		// when the last one completed
+	uint64_t        next_us;
+} DemoVideoIn;
+
+static DemoVideoIn video_in;
+static FrameSync sync;
+
+// Captured frames, each holding only the number of the frame copied into it
+static unsigned char ring_frames[FRAME_RING_MAX_FRAMES][sizeof(unsigned int)];
+static FrameRing ring;
+
+static uint32_t demo_read(void *ctx, uint32_t offset, int width)
+{
+	DemoVideoIn *v = (DemoVideoIn *)ctx;
+
+	(void)width;
+
+	switch (offset) {
+	case FRAME_SYNC_BUFFER_OFFSET:
+		return v->buffer;
+	case FRAME_SYNC_BACK_OFFSET:
+		return v->back;
+	case FRAME_SYNC_STATUS_OFFSET:
+		return v->status;
+	}
+
+	return 0;
+}
+
+static void demo_write(void *ctx, uint32_t offset, uint32_t data, int width)
+{
+	DemoVideoIn *v = (DemoVideoIn *)ctx;
+
+	(void)width;
+
+	switch (offset) {
+	case FRAME_SYNC_BUFFER_OFFSET:
+		v->status |= FRAME_SYNC_STATUS_SWAP;
+		break;
+	case FRAME_SYNC_BACK_OFFSET:
+		v->back = data;
+		break;
+	}
+}
+
+// Completes the frames due by now, making any requested swap
+static void demo_decode(uint64_t now_us)
+{
+	while (video_in.next_us <= now_us) {
+		uint32_t swap = video_in.buffer;
+
+		video_in.frame++;
+		video_in.done_us = video_in.next_us;
+		video_in.next_us += DEMO_FRAME_US;
+
+		if (video_in.status & FRAME_SYNC_STATUS_SWAP) {
+			video_in.buffer = video_in.back;
+			video_in.back = swap;
+			video_in.status &= ~FRAME_SYNC_STATUS_SWAP;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int use_sleep = argc > 1 && strcmp(argv[1], "sleep") == 0;
+	int fps = argc > 2 ? atoi(argv[2]) : 30;
+	int stall = argc > 3 ? atoi(argv[3]) : 0;
+	int detect = argc > 4 ? atoi(argv[4]) : 40;
+	int depth = argc > 5 ? atoi(argv[5]) : 3;
+	FrameRingPolicy policy = argc > 6 && strcmp(argv[6], "oldest") == 0 ? FRAME_RING_KEEP_OLDEST : FRAME_RING_NEWEST_WINS;
+	unsigned char *buffers[FRAME_RING_MAX_FRAMES];
+	const FrameRingSlot *held = NULL;
+	unsigned int detect_until = 0, last_seq = 0, out_of_order = 0, torn = 0;
+	uint64_t age_sum = 0;
+	int i;
+	unsigned int last_frame = 0, copies = 0, twice = 0, never = 0, late = 0;
+	unsigned int tick, busy_until = 0, wake = 0, posted = 0, stalled = 0;
+	uint64_t latency_sum = 0, latency_max = 0;
+
+	if (fps <= 0 || fps > DEMO_TICKS_PER_SEC || detect < 0 || depth < 2 || depth > FRAME_RING_MAX_FRAMES) {
+		fprintf(stderr, "usage: %s [sync|sleep] [target fps] [stall ticks] [detect ticks] [ring depth 2-%d] "
+				"[newest|oldest]\n", argv[0], FRAME_RING_MAX_FRAMES);
+		return 1;
+	}
+
+	for (i = 0; i < depth; i++) {
+		buffers[i] = ring_frames[i];
+	}
+	frame_ring_init(&ring, buffers, depth, policy);
+
+	memset(&video_in, 0, sizeof(video_in));
+	video_in.buffer = video_in.back = DEMO_BUFFER_ADDR;
+	video_in.next_us = DEMO_FRAME_US;
+	host_mmio_map(DEMO_VIDEO_IN_BASE, DEMO_VIDEO_IN_SPAN, demo_read, demo_write, &video_in);
+
+	frame_sync_init(&sync, (void *)DEMO_VIDEO_IN_BASE, DEMO_TICKS_PER_SEC / fps, DEMO_LATE_TICKS);
+
+	for (tick = 0; video_in.frame < DEMO_FRAMES; tick++) {
+		uint64_t now_us = (uint64_t)tick * DEMO_TICK_US;
+		int run = 0;
+
+		demo_decode(now_us);
+
+		// A higher priority task takes the CPU for a while every DEMO_STALL_EVERY frames
+		if (stall > 0 && video_in.frame / DEMO_STALL_EVERY != stalled) {
+			stalled = video_in.frame / DEMO_STALL_EVERY;
+			busy_until = tick + stall;
+		}
+
+		// FrameSyncTask outranks the stall, capture does not
+		if (!use_sleep && frame_sync_poll(&sync, tick)) {
+			posted = 1;
+		}
+
+		if (tick < busy_until) {
+			continue;
+		}
+
+		if (use_sleep) {
+			run = tick >= wake;
+		}
+		else if (posted) {
+			frame_sync_take(&sync, tick);
+			posted = 0;
+			run = 1;
+		}
+
+		// Copy the newest complete frame
+		if (run && video_in.frame > 0) {
+			uint64_t latency = now_us - video_in.done_us;
+
+			if (video_in.frame == last_frame) {
+				twice++;
+			}
+			else {
+				never += video_in.frame - last_frame - 1;
+			}
+
+			if (latency > DEMO_LATE_TICKS * DEMO_TICK_US) {
+				late++;
+			}
+
+			if (latency > latency_max) {
+				latency_max = latency;
+			}
+
+			latency_sum += latency;
+			last_frame = video_in.frame;
+			copies++;
+			wake = tick + DEMO_SLEEP_TICKS;
+
+			// Into the ring, numbered and stamped as CaptureTask does
+			if (!use_sleep) {
+				FrameRingSlot *slot = frame_ring_fill_begin(&ring);
+
+				if (slot != NULL) {
+					memcpy(slot->data, &video_in.frame, sizeof(video_in.frame));
+					frame_ring_fill_end(&ring, slot, sync.frames, sync.ready_tick);
+				}
+			}
+		}
+
+		// Detection runs below capture, finishing with its frame before taking the next
+		if (use_sleep || tick < detect_until) {
+			continue;
+		}
+
+		if (held != NULL) {
+			unsigned int seen;
+
+			memcpy(&seen, held->data, sizeof(seen));
+			if (seen != held->seq) {
+				torn++;
+			}
+			frame_ring_release(&ring);
+			held = NULL;
+		}
+
+		held = frame_ring_acquire(&ring, tick);
+		if (held != NULL) {
+			if (held->seq <= last_seq) {
+				out_of_order++;
+			}
+			last_seq = held->seq;
+			age_sum += tick - held->stamp;
+			detect_until = tick + detect;
+		}
+	}
+
+	printf("%s at %d fps, %u tick stalls: %u frames, %u copies, %.2f ms mean and %.2f ms worst latency, "
+		   "%u copied twice, %u never, %u late\n",
+		   use_sleep ? "sleep" : "sync", fps, stall, video_in.frame, copies,
+		   copies ? latency_sum / 1e3 / copies : 0.0, latency_max / 1e3, twice, never, late);
+
+	if (!use_sleep) {
+		printf("frame sync: %u frames, %u posted, %u skipped, %u dropped, %u late, %u ticks max latency\n",
+			   sync.frames, sync.posted, sync.skipped, sync.dropped, sync.late, sync.max_latency);
+		printf("frame ring: %d deep, %s, %d tick detection: %u filled, %u dropped, %u replaced, %u taken, "
+			   "%u skipped, %.1f ticks mean and %u worst age, %u out of order, %u rewritten while held\n",
+			   depth, policy == FRAME_RING_NEWEST_WINS ? "newest wins" : "keep oldest", detect,
+			   ring.filled, ring.dropped, ring.replaced, ring.taken, ring.skipped,
+			   ring.taken ? (double)age_sum / ring.taken : 0.0, ring.max_age, out_of_order, torn);
+	}
+
+	host_mmio_unmap_all();
+	return 0;
+}
@@ -0,0 +1,62 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST BSP INTERRUPT SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : host_int.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Models the GIC closely enough for level-triggered peripheral interrupts: a raised
+* 				  line runs its handler immediately, and handlers do not nest.
+*
+*********************************************************************************************************
+*/
+
+#include <stddef.h>
+#include <lib_def.h>
+#include <bsp_int.h>
+
+static BSP_INT_FNCT_PTR int_vect_tbl[HOST_INT_SRC_CNT];
+static CPU_BOOLEAN int_en[HOST_INT_SRC_CNT];
+static CPU_BOOLEAN in_handler = DEF_NO;
+
+void BSP_IntSrcEn(CPU_INT32U int_id)
+{
+	if (int_id < HOST_INT_SRC_CNT) {
+		int_en[int_id] = DEF_YES;
+	}
+}
+
+void BSP_IntSrcDis(CPU_INT32U int_id)
+{
+	if (int_id < HOST_INT_SRC_CNT) {
+		int_en[int_id] = DEF_NO;
+	}
+}
+
+CPU_BOOLEAN BSP_IntVectSet(CPU_INT32U int_id, CPU_INT32U int_prio, CPU_INT08U int_target_list, BSP_INT_FNCT_PTR int_fnct)
+{
+	(void)int_prio;
+	(void)int_target_list;
+
+	if (int_id >= HOST_INT_SRC_CNT) {
+		return DEF_NO;
+	}
+
+	int_vect_tbl[int_id] = int_fnct;
+	return DEF_YES;
+}
+
+void host_int_raise(CPU_INT32U int_id)
+{
+	if (int_id >= HOST_INT_SRC_CNT || !int_en[int_id] || int_vect_tbl[int_id] == NULL || in_handler) {
+		return;
+	}
+
+	in_handler = DEF_YES;
+	int_vect_tbl[int_id](0);
+	in_handler = DEF_NO;
+}
@@ -0,0 +1,90 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST MEMORY-MAPPED I/O SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : host_mmio.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Address decoder for the simulated lightweight bridge.  Regions are searched linearly;
+* 				  there are only ever a handful of them.
+*
+*********************************************************************************************************
+*/
+
+#include <stddef.h>
+#include "host_mmio.h"
+
+typedef struct {
+	uintptr_t               base;
+	uint32_t                span;
+	HOST_MMIO_READ_FNCT     read_fnct;
+	HOST_MMIO_WRITE_FNCT    write_fnct;
+	void                   *ctx;
+} HostMmioRegion;
+
+static HostMmioRegion regions[HOST_MMIO_MAX_REGIONS];
+static int num_regions = 0;
+
+unsigned long host_mmio_unmapped = 0;
+
+int host_mmio_map(uintptr_t base, uint32_t span, HOST_MMIO_READ_FNCT read_fnct, HOST_MMIO_WRITE_FNCT write_fnct, void *ctx)
+{
+	if (num_regions >= HOST_MMIO_MAX_REGIONS) {
+		return -1;
+	}
+
+	regions[num_regions].base = base;
+	regions[num_regions].span = span;
+	regions[num_regions].read_fnct = read_fnct;
+	regions[num_regions].write_fnct = write_fnct;
+	regions[num_regions].ctx = ctx;
+	num_regions++;
+
+	return 0;
+}
+
+void host_mmio_unmap_all(void)
+{
+	num_regions = 0;
+}
+
+static HostMmioRegion *find_region(uintptr_t addr)
+{
+	int i;
+
+	for (i = 0; i < num_regions; i++) {
+		if (addr >= regions[i].base && addr - regions[i].base < regions[i].span) {
+			return &regions[i];
+		}
+	}
+
+	return NULL;
+}
+
+uint32_t host_mmio_read(uintptr_t addr, int width)
+{
+	HostMmioRegion *region = find_region(addr);
+
+	if (region == NULL || region->read_fnct == NULL) {
+		host_mmio_unmapped++;
+		return 0;
+	}
+
+	return region->read_fnct(region->ctx, (uint32_t)(addr - region->base), width);
+}
+
+void host_mmio_write(uintptr_t addr, uint32_t data, int width)
+{
+	HostMmioRegion *region = find_region(addr);
+
+	if (region == NULL || region->write_fnct == NULL) {
+		host_mmio_unmapped++;
+		return;
+	}
+
+	region->write_fnct(region->ctx, (uint32_t)(addr - region->base), data, width);
+}
@@ -0,0 +1,42 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST MEMORY-MAPPED I/O SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : host_mmio.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Maps ranges of the DE1-SoC physical address space onto simulated peripherals.  The
+* 				  socal.h shim sends every alt_read_xxx()/alt_write_xxx() here.  Accesses that hit no
+* 				  mapped range are ignored (reads return 0) and counted in host_mmio_unmapped.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __HOST_MMIO_H__
+#define __HOST_MMIO_H__
+
+#include <stdint.h>
+
+#define HOST_MMIO_MAX_REGIONS 8
+
+typedef uint32_t (*HOST_MMIO_READ_FNCT)(void *ctx, uint32_t offset, int width);
+typedef void     (*HOST_MMIO_WRITE_FNCT)(void *ctx, uint32_t offset, uint32_t data, int width);
+
+// Number of accesses that did not hit any mapped region
+extern unsigned long host_mmio_unmapped;
+
+// Maps [base, base + span) to a simulated peripheral, returns 0 on success
+int host_mmio_map(uintptr_t base, uint32_t span, HOST_MMIO_READ_FNCT read_fnct, HOST_MMIO_WRITE_FNCT write_fnct, void *ctx);
+
+// Removes every mapping
+void host_mmio_unmap_all(void);
+
+// Register accessors used by the socal.h shim
+uint32_t host_mmio_read(uintptr_t addr, int width);
+void host_mmio_write(uintptr_t addr, uint32_t data, int width);
+
+#endif /* __HOST_MMIO_H__ */
@@ -0,0 +1,45 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST uC/OS-II KERNEL SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : host_os.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Single threaded stand-ins for the uC/OS-II services used by the drivers.
+*
+*********************************************************************************************************
+*/
+
+#include <stddef.h>
+#include "host_os.h"
+
+static INT32U os_time = 0;
+static HOST_OS_DELAY_FNCT delay_hook = NULL;
+static void *delay_ctx = NULL;
+
+unsigned long host_os_delays = 0;
+
+void host_os_set_delay_hook(HOST_OS_DELAY_FNCT delay_fnct, void *ctx)
+{
+	delay_hook = delay_fnct;
+	delay_ctx = ctx;
+}
+
+void OSTimeDly(INT32U ticks)
+{
+	os_time += ticks;
+	host_os_delays++;
+
+	if (delay_hook != NULL) {
+		delay_hook(delay_ctx, (uint64_t)ticks * 1000000000ull / OS_TICKS_PER_SEC);
+	}
+}
+
+INT32U OSTimeGet(void)
+{
+	return os_time;
+}
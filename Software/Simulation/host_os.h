@@ -0,0 +1,31 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST uC/OS-II KERNEL SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : host_os.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Hooks that tie the kernel shim to the simulated hardware clock.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __HOST_OS_H__
+#define __HOST_OS_H__
+
+#include <stdint.h>
+#include <ucos_ii.h>
+
+typedef void (*HOST_OS_DELAY_FNCT)(void *ctx, uint64_t ns);
+
+// Number of OSTimeDly() calls made so far
+extern unsigned long host_os_delays;
+
+// Installs the function that advances simulated time when a task sleeps
+void host_os_set_delay_hook(HOST_OS_DELAY_FNCT delay_fnct, void *ctx);
+
+#endif /* __HOST_OS_H__ */
@@ -0,0 +1,39 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST BSP INTERRUPT SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : bsp_int.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Same prototypes as BSP/bsp_int.h.  The host interrupt controller in host_int.c calls
+* 				  registered handlers when a simulated peripheral raises its line.
+*
+*********************************************************************************************************
+*/
+
+#ifndef  BSP_INT_PRESENT
+#define  BSP_INT_PRESENT
+
+#include "cpu.h"
+
+#define  HOST_INT_SRC_CNT       256u
+
+typedef  void  (*BSP_INT_FNCT_PTR)(CPU_INT32U);
+
+void        BSP_IntSrcEn        (CPU_INT32U        int_id);
+
+void        BSP_IntSrcDis       (CPU_INT32U        int_id);
+
+CPU_BOOLEAN BSP_IntVectSet      (CPU_INT32U        int_id,
+                                 CPU_INT32U        int_prio,
+                                 CPU_INT08U        int_target_list,
+                                 BSP_INT_FNCT_PTR  int_fnct);
+
+// Runs the handler for int_id if it is enabled and not already running
+void        host_int_raise      (CPU_INT32U        int_id);
+
+#endif /* BSP_INT_PRESENT */
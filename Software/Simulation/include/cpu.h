@@ -0,0 +1,34 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST uC/CPU SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : cpu.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The uC/CPU data types from uC-CPU/ARM-Cortex-A/cpu.h for host builds.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __HOST_CPU_H__
+#define __HOST_CPU_H__
+
+#include <stdint.h>
+
+typedef uint8_t         CPU_BOOLEAN;
+typedef uint8_t         CPU_INT08U;
+typedef int8_t          CPU_INT08S;
+typedef uint16_t        CPU_INT16U;
+typedef int16_t         CPU_INT16S;
+typedef uint32_t        CPU_INT32U;
+typedef int32_t         CPU_INT32S;
+typedef uint64_t        CPU_INT64U;
+typedef int64_t         CPU_INT64S;
+typedef float           CPU_FP32;
+typedef double          CPU_FP64;
+
+#endif /* __HOST_CPU_H__ */
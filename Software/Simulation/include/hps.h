@@ -0,0 +1,28 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST HPS ADDRESS MAP SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : hps.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Stand-in for the Altera hwlib "hps.h" when building the drivers on a Linux host.
+* 				  Only the bridge base addresses used by the Virtual Piano drivers are provided.  The
+* 				  addresses are plain integers; all accesses go through the socal.h shim.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __HOST_HPS_H__
+#define __HOST_HPS_H__
+
+#include <stdint.h>
+
+#define ALT_HPS_ADDR            0x00000000u
+#define ALT_LWFPGASLVS_ADDR     0xFF200000u
+#define ALT_LWFPGASLVS_OFST     0xFF200000u
+
+#endif /* __HOST_HPS_H__ */
@@ -0,0 +1,30 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST uC/LIB SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : lib_def.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The handful of uC-LIBS/lib_def.h constants used by the application code.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __HOST_LIB_DEF_H__
+#define __HOST_LIB_DEF_H__
+
+#define  DEF_NO                0u
+#define  DEF_YES               1u
+#define  DEF_FALSE             0u
+#define  DEF_TRUE              1u
+
+#define  DEF_BIT_00            0x01u
+#define  DEF_BIT_01            0x02u
+#define  DEF_BIT_02            0x04u
+#define  DEF_BIT_03            0x08u
+
+#endif /* __HOST_LIB_DEF_H__ */
@@ -0,0 +1,38 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST uC/OS-II PORT SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : os_cpu.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Provides the uC/OS-II data types from uCOS-II/Ports/os_cpu.h so the drivers compile on
+* 				  a Linux host.  Critical sections are no-ops; the simulation is single threaded.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __HOST_OS_CPU_H__
+#define __HOST_OS_CPU_H__
+
+typedef unsigned char  BOOLEAN;
+typedef unsigned char  INT8U;
+typedef signed   char  INT8S;
+typedef unsigned short INT16U;
+typedef signed   short INT16S;
+typedef unsigned int   INT32U;
+typedef signed   int   INT32S;
+typedef float          FP32;
+typedef double         FP64;
+
+typedef unsigned int   OS_STK;
+typedef unsigned int   OS_CPU_SR;
+
+#define  OS_CRITICAL_METHOD    3u
+#define  OS_ENTER_CRITICAL()   {(void)cpu_sr;}
+#define  OS_EXIT_CRITICAL()    {(void)cpu_sr;}
+
+#endif /* __HOST_OS_CPU_H__ */
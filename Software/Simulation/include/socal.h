@@ -0,0 +1,33 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST SOCAL REGISTER ACCESS SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : socal.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Stand-in for the Altera hwlib "socal.h".  The alt_read/alt_write accessors are routed to
+* 				  host_mmio, which dispatches each access to whichever simulated peripheral has mapped
+* 				  the address.  This lets the board drivers run unmodified on the host.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __HOST_SOCAL_H__
+#define __HOST_SOCAL_H__
+
+#include <stdint.h>
+#include "../host_mmio.h"
+
+#define alt_read_byte(src)          ((uint8_t)  host_mmio_read((uintptr_t)(src), 1))
+#define alt_read_hword(src)         ((uint16_t) host_mmio_read((uintptr_t)(src), 2))
+#define alt_read_word(src)          ((uint32_t) host_mmio_read((uintptr_t)(src), 4))
+
+#define alt_write_byte(dest, src)   host_mmio_write((uintptr_t)(dest), (uint32_t)(src), 1)
+#define alt_write_hword(dest, src)  host_mmio_write((uintptr_t)(dest), (uint32_t)(src), 2)
+#define alt_write_word(dest, src)   host_mmio_write((uintptr_t)(dest), (uint32_t)(src), 4)
+
+#endif /* __HOST_SOCAL_H__ */
@@ -0,0 +1,32 @@
+/*
+*********************************************************************************************************
+*
+*                                      HOST uC/OS-II KERNEL SHIM
+*
+*                                            LINUX HOST
+*
+* Filename      : ucos_ii.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : The subset of the uC/OS-II API used by the drivers, implemented in host_os.c.  Time
+* 				  delays do not sleep; they advance simulated time through the hook installed with
+* 				  host_os_set_delay_hook().
+*
+*********************************************************************************************************
+*/
+
+#ifndef __HOST_UCOS_II_H__
+#define __HOST_UCOS_II_H__
+
+#include "os_cpu.h"
+
+#define  OS_TICKS_PER_SEC       1000u
+
+#define  OS_ERR_NONE               0u
+#define  OS_PRIO_SELF           0xFFu
+
+void          OSTimeDly               (INT32U           ticks);
+INT32U        OSTimeGet               (void);
+
+#endif /* __HOST_UCOS_II_H__ */
@@ -0,0 +1,43 @@
+/*
+*********************************************************************************************************
+*
+*                                      PIXEL LOOKUP TABLE DUMP
+*
+*                                            LINUX HOST
+*
+* Filename      : pixel_lut_dump.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Prints the RGB332 lookup table from Video/pixel_lut.c as CSV so that
+* 				  ImageProcessing/test_pixel_lut.py can check it against rgb2hsl() and rgb2gs().
+*
+* 				  Usage: ./pixel_lut_dump [threshold] > pixel_lut.csv
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../EclipseProject/VirtualPiano/Video/pixel_lut.h"
+
+int main(int argc, char **argv)
+{
+	PixelLut lut;
+	int pixel;
+
+	pixel_lut_init(&lut, argc > 1 ? atof(argv[1]) : PIXEL_LUT_THRESHOLD_DEFAULT);
+
+	printf("threshold,%.17g\n", lut.threshold);
+	printf("pixel,r,g,b,lightness,gray,bright\n");
+
+	for (pixel = 0; pixel < PIXEL_LUT_SIZE; pixel++) {
+		int r, g, b;
+
+		pixel_lut_rgb((unsigned char)pixel, &r, &g, &b);
+		printf("%d,%d,%d,%d,%d,%d,%d\n", pixel, r, g, b,
+			   PIXEL_LUT_LIGHTNESS(&lut, pixel), PIXEL_LUT_GRAY(&lut, pixel), PIXEL_LUT_BRIGHT(&lut, pixel));
+	}
+
+	return 0;
+}
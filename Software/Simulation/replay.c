@@ -0,0 +1,269 @@
+/*
+*********************************************************************************************************
+*
+*                                      RECORDED FRAME REPLAY
+*
+*                                            LINUX HOST
+*
+* Filename      : replay.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Plays recorded frames through the key detector and the VGA preview as KeyDetectTask
+* 				  runs them, one frame at a time, calling the same Video/ functions on buffers laid
+* 				  out like the video-in memory (512 byte rows).  The preview goes to the simulated
+* 				  pixel buffer controller (vga_sim.c), refreshed twice per captured frame.
+*
+* 				  The first frame is the calibration reference, tried by session_calibrate() as
+* 				  KeyDetectTask would: through the keyboard's outline and rectified strip, then as it
+* 				  is, and failing both with the default equal zones.  Each frame then goes through
+* 				  key_detect_frame() and the preview (Video/key_preview.c), every step timed through
+* 				  the detector's step hook.  The key events are printed as they are drained from the
+* 				  ring, followed by the frame rate, the time per frame of every stage and the
+* 				  detector's counters.
+*
+* 				  Frames are raw video-in dumps or sessions of them (see frame_file.h), in the order
+* 				  given; ImageProcessing/make_frames.py converts the sample images into either.  With
+* 				  none given, a synthetic session of REPLAY_SYNTHETIC_SCENES scenes is played, each
+* 				  held for REPLAY_SYNTHETIC_HOLD frames.  -n replays the frames that many times for
+* 				  steadier timings, printing the events of the first pass only.
+*
+* 				  Usage: ./replay [-n passes] [frame or session ...]
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../EclipseProject/VirtualPiano/Video/key_detect.h"
+#include "../EclipseProject/VirtualPiano/Video/key_preview.h"
+#include "../EclipseProject/VirtualPiano/Video/vga_buffer.h"
+#include "../EclipseProject/VirtualPiano/Video/dirty_rect.h"
+#include "frame_file.h"
+#include "session_cal.h"
+#include "vga_sim.h"
+
+#define REPLAY_MAX_FRAMES 4096
+#define REPLAY_SYNTHETIC_SCENES 8
+#define REPLAY_SYNTHETIC_HOLD 8
+#define REPLAY_REFRESHES_PER_FRAME 2
+
+// The detector's steps, then the preview
+#define REPLAY_STAGE_PREVIEW KEY_DETECT_STEPS
+#define REPLAY_STAGES (KEY_DETECT_STEPS + 1)
+
+static const char *stage_names[REPLAY_STAGES] = {
+	"remap", "tile change", "pyramid", "blobs + key scores", "background", "key state", "tracker", "preview"
+};
+
+static unsigned char *frames;
+static int num_frames;
+
+// The detector KeyDetectTask runs and the ring it fills for the note scheduler
+static KeyDetector detector;
+static KeyEventRing events;
+
+// Preview, drawn as the detect loop draws it
+static KeyPreview preview;
+static int preview_count;
+static VgaSim sim;
+static VgaBuffer vga;
+static DirtyRects rects;
+static unsigned long previews, previews_put_off;
+
+static double stage_seconds[REPLAY_STAGES];
+static double stage_start;
+
+static double replay_seconds(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Charges the time since the last stage ended to this one
+static void replay_lap(int stage)
+{
+	double now = replay_seconds();
+
+	stage_seconds[stage] += now - stage_start;
+	stage_start = now;
+}
+
+// The detector's step hook
+static void replay_step(void *ctx, KeyDetectStep step)
+{
+	(void)ctx;
+	replay_lap(step);
+}
+
+// Appends a file's frames, a single dump or a session of them
+static int replay_load(const char *file_name)
+{
+	int count = frame_file_count(file_name);
+	int i;
+
+	if (count == 0) {
+		count = 1;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (num_frames == REPLAY_MAX_FRAMES) {
+			fprintf(stderr, "%s: more than %d frames, the rest are left out\n", file_name, REPLAY_MAX_FRAMES);
+			return 0;
+		}
+		if ((count == 1 ? frame_file_load(file_name, frames + (size_t)num_frames * FRAME_FILE_BYTES) :
+			 frame_file_load_index(file_name, i, frames + (size_t)num_frames * FRAME_FILE_BYTES)) != 0) {
+			return -1;
+		}
+		num_frames++;
+	}
+
+	return 0;
+}
+
+// Updates the back buffer with the changed tiles and keys and swaps it in, as KeyDetectTask does
+static void replay_preview(void)
+{
+	unsigned char *back;
+
+	if (++preview_count < KEY_PREVIEW_PERIOD) {
+		return;
+	}
+	if (vga_buffer_swap_pending(&vga)) {
+		previews_put_off++;
+		return;
+	}
+
+	back = vga.pixels[vga.back];
+	dirty_rect_flush(&rects, back, vga.pixels[vga.back ^ 1], VGA_Y);
+	key_preview_draw(&preview, back, &detector, &rects);
+
+	vga_buffer_swap(&vga);
+	preview_count = 0;
+	previews++;
+}
+
+// The body of KeyDetectTask's loop for one frame, returns the number of key events
+static int replay_frame(const unsigned char *frame)
+{
+	int num_events;
+
+	stage_start = replay_seconds();
+	num_events = key_detect_frame(&detector, frame, &events);
+
+	key_preview_frame(&preview, &detector);
+	replay_preview();
+	replay_lap(REPLAY_STAGE_PREVIEW);
+
+	return num_events;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int downs = 0, ups = 0, frame_count = 0;
+	double start, seconds, total = 0.0;
+	int passes = 1, opt, pass, f, s;
+	KeyEvent event;
+
+	while ((opt = getopt(argc, argv, "n:")) != -1) {
+		if (opt == 'n') {
+			passes = atoi(optarg);
+		}
+		else {
+			fprintf(stderr, "usage: %s [-n passes] [frame or session ...]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	frames = malloc((size_t)REPLAY_MAX_FRAMES * FRAME_FILE_BYTES);
+	if (frames == NULL || passes <= 0) {
+		fprintf(stderr, "usage: %s [-n passes] [frame or session ...]\n", argv[0]);
+		return 1;
+	}
+
+	for (; optind < argc; optind++) {
+		if (replay_load(argv[optind]) != 0) {
+			fprintf(stderr, "cannot read frames from %s\n", argv[optind]);
+			return 1;
+		}
+	}
+
+	if (num_frames == 0) {
+		for (s = 0; s < REPLAY_SYNTHETIC_SCENES; s++) {
+			for (f = 0; f < REPLAY_SYNTHETIC_HOLD; f++) {
+				frame_file_synthesize(frames + (size_t)num_frames++ * FRAME_FILE_BYTES, s);
+			}
+		}
+		printf("%d synthetic frames, %d scenes, %d passes\n", num_frames, REPLAY_SYNTHETIC_SCENES, passes);
+	}
+	else {
+		printf("%d recorded frames, %d passes\n", num_frames, passes);
+	}
+
+	// Start up as KeyDetectTask does, with every step timed
+	key_detect_init(&detector);
+	session_calibrate(&detector, frames);
+	key_event_init(&events);
+	detector.step_fnct = replay_step;
+
+	vga_sim_init(&sim);
+	// The model starts with buffer 0 on screen, so drawing starts in buffer 1
+	vga_buffer_init(&vga, (void *)VGA_BUFFER_CTRL_BASE,
+					vga_sim_pixels(&sim, VGA_BUFFER_1_ADDR), VGA_BUFFER_1_ADDR,
+					vga_sim_pixels(&sim, VGA_BUFFER_0_ADDR), VGA_BUFFER_0_ADDR);
+	dirty_rect_init(&rects, VGA_SIM_WIDTH, VGA_SIM_HEIGHT);
+	key_preview_init(&preview);
+	for (s = 0; s < 2; s++) {
+		key_preview_clear(vga.pixels[s], &detector);
+	}
+	vga_sim_start(&sim);
+
+	for (pass = 0; pass < passes; pass++) {
+		for (f = 0; f < num_frames; f++) {
+			start = replay_seconds();
+			replay_frame(frames + (size_t)f * FRAME_FILE_BYTES);
+			frame_count++;
+			total += replay_seconds() - start;
+
+			// The note scheduler's side of the ring
+			while (key_event_pop(&events, &event) == 0) {
+				if (event.down) {
+					downs++;
+				}
+				else {
+					ups++;
+				}
+				if (pass == 0) {
+					printf("frame %5u  key %2d %s\n", event.frame, event.key + 1, event.down ? "down" : "up");
+				}
+			}
+
+			for (s = 0; s < REPLAY_REFRESHES_PER_FRAME; s++) {
+				vga_sim_retrace(&sim);
+			}
+		}
+	}
+
+	seconds = total / frame_count;
+	printf("%u frames, %.1f fps, %.2f us/frame\n", frame_count, 1.0 / seconds, 1e6 * seconds);
+	for (s = 0; s < REPLAY_STAGES; s++) {
+		printf("  %-20s %8.2f us/frame  %5.1f%%\n", stage_names[s], 1e6 * stage_seconds[s] / frame_count,
+			   100.0 * stage_seconds[s] / total);
+	}
+	printf("key events: %u down, %u up, %u lost to a full ring, %u chattering runs absorbed\n",
+		   downs, ups, events.overflows, detector.state.chatter);
+	printf("tiles: %.1f of %d processed per frame, tracker: %u tracks started, %u settled track frames\n",
+		   (double)detector.tiles.tiles_processed / frame_count, TILE_COUNT,
+		   detector.tracker.started, detector.tracker.settled);
+	printf("preview: %lu drawn, %lu put off, %lu bytes flushed\n", previews, previews_put_off, rects.bytes_flushed);
+	vga_sim_report(&sim, stdout);
+
+	vga_sim_close(&sim);
+	free(frames);
+	return 0;
+}
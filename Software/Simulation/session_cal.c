@@ -0,0 +1,39 @@
+/*
+*********************************************************************************************************
+*
+*                                      RECORDED SESSION CALIBRATION
+*
+*                                            LINUX HOST
+*
+* Filename      : session_cal.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include "session_cal.h"
+
+int session_calibrate(KeyDetector *det, const unsigned char *frame)
+{
+	const KeyCal *cal = &det->cal;
+	int result = key_detect_calibrate(det, frame);
+
+	if (result == KEY_CAL_OK && key_detect_use_cal(det, cal) == 0) {
+		if (cal->rectified) {
+			printf("calibration: %d x %d strip rectified from (%d, %d) (%d, %d) (%d, %d) (%d, %d)\n",
+				   det->remap.width, det->remap.height, cal->corners[0], cal->corners[1],
+				   cal->corners[2], cal->corners[3], cal->corners[4], cal->corners[5],
+				   cal->corners[6], cal->corners[7]);
+		}
+		else {
+			printf("calibration: straight, keyboard rows %d..%d, columns %d..%d\n",
+				   cal->top, cal->bottom, cal->left, cal->right);
+		}
+		return 0;
+	}
+
+	key_detect_use_default(det);
+	printf("calibration: none (%d), %d equal zones below row %d\n", result, KEY_MAP_KEYS, KEY_DETECT_KEYBOARD_TOP);
+	return -1;
+}
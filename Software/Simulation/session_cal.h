@@ -0,0 +1,28 @@
+/*
+*********************************************************************************************************
+*
+*                                      RECORDED SESSION CALIBRATION
+*
+*                                            LINUX HOST
+*
+* Filename      : session_cal.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Sets a detector up on a session's first frame as KeyDetectTask would on the board:
+* 				  key_detect_calibrate() through the keyboard's outline and rectified strip, then on the
+* 				  frame as it is, and failing both the default equal zones.  Which of the three was
+* 				  used is printed, so the host tools report their keys the same way.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __SESSION_CAL_H__
+#define __SESSION_CAL_H__
+
+#include "../EclipseProject/VirtualPiano/Video/key_detect.h"
+
+// Calibrates det on frame, returns 0 or -1 when it fell back to key_detect_use_default()
+int session_calibrate(KeyDetector *det, const unsigned char *frame);
+
+#endif /* __SESSION_CAL_H__ */
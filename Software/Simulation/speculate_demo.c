@@ -0,0 +1,297 @@
+/*
+*********************************************************************************************************
+*
+*                                       SPECULATIVE RENDER DEMO
+*
+*                                            LINUX HOST
+*
+* Filename      : speculate_demo.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Plays a scripted performance through the key tracker and the render cache, one video
+* 				  frame at a time.  Fingertips hover over a uniform 88 key map, glide to a key at a
+* 				  few pixels a frame, slowing to half the distance left as they arrive, hold it and
+* 				  move on; the key state machine confirms a press
+* 				  DEMO_CONFIRM_FRAMES frames after the finger stops, which is the note-on.  The blobs
+* 				  handed to key_track_update() are the fingertip centroids with half a pixel of noise.
+*
+* 				  A render costs the given number of ticks.  The speculative renderer only gets the
+* 				  DEMO_SPARE_TICKS of each frame the other tasks leave, less any note-on renders,
+* 				  and takes the keys the tracker sends through a queue of DEMO_QUEUE_SIZE, as
+* 				  SpeculativeRenderTask does.  A note-on waits for the render in progress, as it
+* 				  waits for RenderSem on the board, then copies a cached render or renders itself.
+*
+* 				  The same performance is played without and with speculation.  For each the hit
+* 				  rate, renders evicted unplayed and the ticks they took, and the mean and worst
+* 				  note-on latency are printed.
+*
+* 				  Usage: ./speculate_demo [render ticks] [lookahead frames] [fingers]
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../EclipseProject/VirtualPiano/Video/key_track.h"
+#include "../EclipseProject/VirtualPiano/Synthesizer/render_cache.h"
+
+#define DEMO_FRAMES 9000
+#define DEMO_FRAME_TICKS 33
+#define DEMO_SPARE_TICKS 16
+#define DEMO_QUEUE_SIZE 8
+#define DEMO_CACHE_SLOTS 4
+#define DEMO_CONFIRM_FRAMES 2
+#define DEMO_MAX_FINGERS 5
+#define DEMO_ROW 120
+#define DEMO_SEED 12345u
+
+typedef struct {
+	float           x, target;
+	float           speed;			// pixels / frame
+	int             held;			// frames on the target, -1 while moving
+	int             hold;			// frames it will stay
+	int             key;			// key held down, -1 if none
+	float           lo, hi;			// range the finger plays in
+} DemoFinger;
+
+typedef struct {
+	unsigned int    presses;
+	unsigned int    latency_sum, latency_max;
+	unsigned int    skipped;		// requests for keys cached, down or no longer predicted
+	unsigned int    dropped;		// requests the queue had no room for
+} DemoResult;
+
+static KeyMap key_map;
+static unsigned char labels[VIDEO_IN_FRAME_WIDTH * VIDEO_IN_FRAME_HEIGHT];
+static BlobLabeller blobs;
+static KeyTracker tracker;
+static RenderCache cache;
+static short slot_data[DEMO_CACHE_SLOTS][1];
+static unsigned int seed;
+
+static unsigned int demo_rand(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return (seed >> 16) & 0x7FFF;
+}
+
+static float demo_uniform(float lo, float hi)
+{
+	return lo + (hi - lo) * demo_rand() / 32767.0f;
+}
+
+static int demo_key_at(float x)
+{
+	int key = labels[DEMO_ROW * VIDEO_IN_FRAME_WIDTH + (int)x];
+
+	return key == KEY_MAP_NO_KEY ? -1 : key;
+}
+
+// Picks the next key for a finger, somewhere in its range
+static void demo_next_target(DemoFinger *finger)
+{
+	do {
+		finger->target = demo_uniform(finger->lo, finger->hi);
+	} while (finger->target - finger->x < 8.0f && finger->x - finger->target < 8.0f);
+
+	finger->speed = demo_uniform(2.0f, 7.0f);
+	finger->held = -1;
+	finger->hold = 4 + demo_rand() % 8;
+}
+
+static void demo_run(int speculate, int render_ticks, int lookahead, int num_fingers, DemoResult *result)
+{
+	DemoFinger fingers[DEMO_MAX_FINGERS];
+	short *buffers[DEMO_CACHE_SLOTS];
+	unsigned int requested[KEY_MAP_MASK_WORDS], down[KEY_MAP_MASK_WORDS];
+	int queue[DEMO_QUEUE_SIZE], head = 0, count = 0;
+	RenderSlot *rendering = NULL;
+	int remaining = 0, debt = 0;
+	int frame, f, i, w;
+
+	seed = DEMO_SEED;
+	memset(result, 0, sizeof(*result));
+	memset(requested, 0, sizeof(requested));
+	memset(down, 0, sizeof(down));
+
+	for (i = 0; i < DEMO_CACHE_SLOTS; i++) {
+		buffers[i] = slot_data[i];
+	}
+	renderCacheInit(&cache, buffers, DEMO_CACHE_SLOTS, 1);
+	key_track_init(&tracker, KEY_TRACK_ACCEL_NOISE_DEFAULT, KEY_TRACK_MEASURE_NOISE_DEFAULT, lookahead);
+
+	for (f = 0; f < num_fingers; f++) {
+		fingers[f].lo = 2.0f + (VIDEO_IN_FRAME_WIDTH - 4.0f) * f / num_fingers;
+		fingers[f].hi = 2.0f + (VIDEO_IN_FRAME_WIDTH - 4.0f) * (f + 1) / num_fingers - 1.0f;
+		fingers[f].x = (fingers[f].lo + fingers[f].hi) / 2;
+		fingers[f].key = -1;
+		demo_next_target(&fingers[f]);
+	}
+
+	for (frame = 0; frame < DEMO_FRAMES; frame++) {
+		unsigned int now = frame * DEMO_FRAME_TICKS;
+		int spare = DEMO_SPARE_TICKS;
+
+		// Note-on renders come out of the time the speculative renderer would get
+		if (debt >= spare) {
+			debt -= spare;
+			spare = 0;
+		}
+		else {
+			spare -= debt;
+			debt = 0;
+		}
+
+		// The speculative renderer works through its queue with what is left
+		while (spare > 0) {
+			if (rendering == NULL) {
+				int key;
+
+				if (count == 0) {
+					break;
+				}
+
+				key = queue[head];
+				head = (head + 1) % DEMO_QUEUE_SIZE;
+				count--;
+
+				if (((down[(key - 1) >> 5] >> ((key - 1) & 31)) & 1) ||
+					!((tracker.predicted[(key - 1) >> 5] >> ((key - 1) & 31)) & 1) ||
+					renderCacheFind(&cache, key) != NULL || (rendering = renderCacheClaim(&cache, key, now)) == NULL) {
+					result->skipped++;
+					continue;
+				}
+				remaining = render_ticks;
+			}
+
+			if (remaining > spare) {
+				remaining -= spare;
+				spare = 0;
+			}
+			else {
+				spare -= remaining;
+				renderCacheReady(&cache, rendering, 1, now, render_ticks);
+				rendering = NULL;
+			}
+		}
+
+		// Fingers glide, hold and press
+		blobs.num_blobs = 0;
+		for (f = 0; f < num_fingers; f++) {
+			DemoFinger *finger = &fingers[f];
+
+			if (finger->held < 0) {
+				float left = finger->target - finger->x;
+				float step = left > 0 ? left : -left;
+
+				step = step / 2 < finger->speed ? step / 2 : finger->speed;
+				if (step > 0.25f) {
+					finger->x += left > 0 ? step : -step;
+				}
+				else {
+					finger->x = finger->target;
+					finger->held = 0;
+				}
+			}
+			else if (++finger->held == DEMO_CONFIRM_FRAMES && (finger->key = demo_key_at(finger->x)) >= 0) {
+				unsigned int latency = 0;
+				const RenderSlot *slot;
+
+				// Note-on: wait for the render in progress, then copy or render
+				if (rendering != NULL) {
+					latency += remaining;
+					renderCacheReady(&cache, rendering, 1, now, render_ticks);
+					rendering = NULL;
+				}
+
+				slot = renderCacheHit(&cache, finger->key + 1, now);
+				if (slot == NULL) {
+					latency += render_ticks;
+				}
+
+				debt += latency;
+				down[finger->key >> 5] |= 1u << (finger->key & 31);
+				result->presses++;
+				result->latency_sum += latency;
+				if (latency > result->latency_max) {
+					result->latency_max = latency;
+				}
+			}
+			else if (finger->held >= finger->hold) {
+				if (finger->key >= 0) {
+					down[finger->key >> 5] &= ~(1u << (finger->key & 31));
+					finger->key = -1;
+				}
+				demo_next_target(finger);
+			}
+
+			blobs.blobs[blobs.num_blobs].cx = finger->x + demo_uniform(-0.5f, 0.5f);
+			blobs.blobs[blobs.num_blobs].cy = DEMO_ROW + demo_uniform(-0.5f, 0.5f);
+			blobs.blobs[blobs.num_blobs].area = 40;
+			blobs.num_blobs++;
+		}
+
+		// Send the keys the fingertips are heading for, as KeyDetectTask does
+		key_track_update(&tracker, &blobs, labels);
+		for (w = 0; w < KEY_MAP_MASK_WORDS && speculate; w++) {
+			unsigned int ahead = tracker.predicted[w] & ~down[w] & ~requested[w];
+
+			while (ahead != 0) {
+				int key = 32 * w + bit_mask_ctz(ahead);
+
+				if (count < DEMO_QUEUE_SIZE) {
+					queue[(head + count++) % DEMO_QUEUE_SIZE] = key + 1;
+				}
+				else {
+					result->dropped++;
+				}
+				ahead &= ahead - 1;
+			}
+			requested[w] = tracker.predicted[w];
+		}
+	}
+}
+
+static void demo_print(const char *name, const DemoResult *result)
+{
+	unsigned int lookups = cache.hits + cache.misses;
+	unsigned int spare = DEMO_FRAMES * DEMO_SPARE_TICKS;
+
+	printf("%-11s %5u presses, hit rate %5.1f%%, %5u renders, %5u wasted (%6u ticks, %4.1f%% of spare CPU), "
+		   "%4u skipped, %4u dropped, note-on latency %5.1f mean %3u worst ticks\n",
+		   name, result->presses, lookups ? 100.0 * cache.hits / lookups : 0.0, cache.renders,
+		   cache.wasted, cache.wasted_ticks, 100.0 * cache.wasted_ticks / spare,
+		   result->skipped, result->dropped,
+		   result->presses ? (double)result->latency_sum / result->presses : 0.0, result->latency_max);
+}
+
+int main(int argc, char **argv)
+{
+	int render_ticks = argc > 1 ? atoi(argv[1]) : 40;
+	int lookahead = argc > 2 ? atoi(argv[2]) : KEY_TRACK_LOOKAHEAD_DEFAULT;
+	int num_fingers = argc > 3 ? atoi(argv[3]) : 2;
+	DemoResult result;
+
+	if (render_ticks <= 0 || lookahead < 0 || num_fingers <= 0 || num_fingers > DEMO_MAX_FINGERS) {
+		fprintf(stderr, "usage: %s [render ticks] [lookahead frames] [fingers 1-%d]\n", argv[0], DEMO_MAX_FINGERS);
+		return 1;
+	}
+
+	key_map_init_uniform(&key_map, 0, 10, VIDEO_IN_FRAME_WIDTH, VIDEO_IN_FRAME_HEIGHT);
+	key_map_build_labels(&key_map, labels);
+
+	printf("%d tick renders, %d frame lookahead, %d fingers, %d spare ticks a frame\n",
+		   render_ticks, lookahead, num_fingers, DEMO_SPARE_TICKS);
+
+	demo_run(0, render_ticks, lookahead, num_fingers, &result);
+	demo_print("on demand", &result);
+
+	demo_run(1, render_ticks, lookahead, num_fingers, &result);
+	demo_print("speculative", &result);
+	printf("tracker: %u frames, %u tracks started, %u dropped, %u settled track frames\n",
+		   tracker.frames, tracker.started, tracker.dropped, tracker.settled);
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+/*
+*********************************************************************************************************
+*
+*                                       STRIPE THREAD POOL CODE
+*
+*                                            LINUX HOST
+*
+* Filename      : stripe_pool.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "stripe_pool.h"
+
+// Waits for each job, runs the worker's stripe and reports it done
+static void *stripe_pool_worker(void *arg)
+{
+	StripePoolWorker *worker = (StripePoolWorker *)arg;
+	StripePool *pool = worker->pool;
+	unsigned int job = 0;
+
+	for (;;) {
+		pthread_mutex_lock(&pool->lock);
+		while (pool->job == job && !pool->stopping) {
+			pthread_cond_wait(&pool->start, &pool->lock);
+		}
+		if (pool->stopping) {
+			pthread_mutex_unlock(&pool->lock);
+			return NULL;
+		}
+		job = pool->job;
+		pthread_mutex_unlock(&pool->lock);
+
+		pool->fnct(pool->ctx, worker->stripe, pool->stripes);
+
+		pthread_mutex_lock(&pool->lock);
+		if (--pool->busy == 0) {
+			pthread_cond_signal(&pool->done);
+		}
+		pthread_mutex_unlock(&pool->lock);
+	}
+}
+
+int stripe_pool_start(StripePool *pool, int threads, STRIPE_POOL_FNCT fnct, void *ctx)
+{
+	int i;
+
+	memset(pool, 0, sizeof(*pool));
+
+	threads = threads < 1 ? 1 : threads > STRIPE_POOL_MAX_THREADS ? STRIPE_POOL_MAX_THREADS : threads;
+	pool->fnct = fnct;
+	pool->ctx = ctx;
+	pool->stripes = 1;
+
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->start, NULL);
+	pthread_cond_init(&pool->done, NULL);
+
+	// Stripe 0 is the caller's
+	for (i = 1; i < threads; i++) {
+		pool->workers[i].pool = pool;
+		pool->workers[i].stripe = i;
+		if (pthread_create(&pool->workers[i].thread, NULL, stripe_pool_worker, &pool->workers[i]) != 0) {
+			stripe_pool_stop(pool);
+			return -1;
+		}
+		pool->stripes++;
+	}
+
+	return 0;
+}
+
+void stripe_pool_run(StripePool *pool)
+{
+	pthread_mutex_lock(&pool->lock);
+	pool->busy = pool->stripes - 1;
+	pool->job++;
+	pthread_cond_broadcast(&pool->start);
+	pthread_mutex_unlock(&pool->lock);
+
+	pool->fnct(pool->ctx, 0, pool->stripes);
+
+	pthread_mutex_lock(&pool->lock);
+	while (pool->busy > 0) {
+		pthread_cond_wait(&pool->done, &pool->lock);
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	pool->jobs++;
+}
+
+void stripe_pool_stop(StripePool *pool)
+{
+	int i;
+
+	pthread_mutex_lock(&pool->lock);
+	pool->stopping = 1;
+	pthread_cond_broadcast(&pool->start);
+	pthread_mutex_unlock(&pool->lock);
+
+	for (i = 1; i < pool->stripes; i++) {
+		pthread_join(pool->workers[i].thread, NULL);
+	}
+
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->start);
+	pthread_cond_destroy(&pool->done);
+}
@@ -0,0 +1,66 @@
+/*
+*********************************************************************************************************
+*
+*                                   STRIPE THREAD POOL HEADER CODE
+*
+*                                            LINUX HOST
+*
+* Filename      : stripe_pool.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : A fixed set of POSIX threads that run one job split into stripes, one stripe per
+* 				  thread, the calling thread taking stripe 0.  stripe_pool_run() starts every stripe
+* 				  and returns when all are done, so the stripes of one job never overlap the next.
+* 				  Each stripe is expected to write only its own results; the pool synchronizes once
+* 				  per job, on a mutex, and nothing inside a stripe is shared or atomic.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __STRIPE_POOL_H__
+#define __STRIPE_POOL_H__
+
+#include <pthread.h>
+
+#define STRIPE_POOL_MAX_THREADS 64
+
+// Runs stripe of stripes for the job described by ctx
+typedef void (*STRIPE_POOL_FNCT)(void *ctx, int stripe, int stripes);
+
+typedef struct StripePool StripePool;
+
+typedef struct {
+	StripePool     *pool;
+	int             stripe;
+	pthread_t       thread;
+} StripePoolWorker;
+
+struct StripePool {
+	STRIPE_POOL_FNCT fnct;
+	void           *ctx;
+	int             stripes;
+	StripePoolWorker workers[STRIPE_POOL_MAX_THREADS];
+
+	pthread_mutex_t lock;
+	pthread_cond_t  start;			// a job was posted or the pool is stopping
+	pthread_cond_t  done;			// the last worker finished its stripe
+	unsigned int    job;			// jobs posted
+	int             busy;			// workers still on the current job
+	int             stopping;
+
+	// Statistics
+	unsigned int    jobs;
+};
+
+// Starts threads - 1 workers (1 to STRIPE_POOL_MAX_THREADS threads in all) running fnct on
+// ctx, returns 0 or -1 if a thread could not be created
+int stripe_pool_start(StripePool *pool, int threads, STRIPE_POOL_FNCT fnct, void *ctx);
+
+// Runs every stripe of one job and waits for them all
+void stripe_pool_run(StripePool *pool);
+
+// Joins the workers, pool->stripes and the statistics stay for reports
+void stripe_pool_stop(StripePool *pool);
+
+#endif /* __STRIPE_POOL_H__ */
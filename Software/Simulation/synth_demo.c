@@ -0,0 +1,132 @@
+/*
+*********************************************************************************************************
+*
+*                                      SYNTH ENGINE BLOCK RENDER DEMO
+*
+*                                            LINUX HOST
+*
+* Filename      : synth_demo.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Loads the C1 to C8 recordings from Software/, plays them as an overlapping arpeggio
+* 				  through the synth engine and writes the result with the WAV backend.  Notes are
+* 				  triggered between blocks, the same granularity RenderMixTask has on the board.
+*
+* 				  Usage: ./synth_demo [-b block_frames] [-r sample_rate] [-f s16|f32] [-u] [-o out.wav]
+* 				         ./synth_demo -B     sweep 64 to 512 frame blocks unpaced and report headroom
+*
+* 				  -u turns real-time pacing off, which is what the throughput numbers want.
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "../wav.h"
+#include "synth_wav_backend.h"
+
+#define DEMO_NUM_NOTES 8
+#define DEMO_NOTE_SPACING_MS 250
+#define DEMO_NOTE_LENGTH_MS 1000
+#define DEMO_TAIL_MS 1500
+
+typedef struct {
+	SynthEngine     engine;
+	Sample         *notes[DEMO_NUM_NOTES];
+	uint64_t        frame;
+	int             next_on;
+	int             next_off;
+} DemoSong;
+
+// Render callback: fires the notes that are due by this block, then renders it
+static void demo_render(void *ctx, void *out, int num_frames)
+{
+	DemoSong *song = (DemoSong *)ctx;
+	uint64_t rate = (uint64_t)song->engine.config.sample_rate;
+
+	while (song->next_off < song->next_on &&
+		   (uint64_t)(song->next_off * DEMO_NOTE_SPACING_MS + DEMO_NOTE_LENGTH_MS) * rate / 1000 <= song->frame) {
+		synthNoteOff(&song->engine, song->next_off + 1);
+		song->next_off++;
+	}
+
+	while (song->next_on < DEMO_NUM_NOTES &&
+		   (uint64_t)(song->next_on * DEMO_NOTE_SPACING_MS) * rate / 1000 <= song->frame) {
+		Sample *note = song->notes[song->next_on];
+
+		synthNoteOn(&song->engine, synthAllocVoice(&song->engine), song->next_on + 1, note->data, note->size);
+		song->next_on++;
+	}
+
+	synthRender(&song->engine, out, num_frames);
+	song->frame += (uint64_t)num_frames;
+}
+
+static int demo_play(DemoSong *song, const SynthConfig *config, const char *file_name, int realtime)
+{
+	SynthWavBackend backend;
+	uint64_t total_frames = (uint64_t)((DEMO_NUM_NOTES - 1) * DEMO_NOTE_SPACING_MS + DEMO_NOTE_LENGTH_MS + DEMO_TAIL_MS) * config->sample_rate / 1000;
+	uint32_t num_blocks = (uint32_t)((total_frames + config->block_frames - 1) / config->block_frames);
+
+	synthInit(&song->engine, config);
+	song->frame = 0;
+	song->next_on = 0;
+	song->next_off = 0;
+
+	if (synth_wav_backend_open(&backend, config, file_name, realtime) != 0) {
+		fprintf(stderr, "cannot open %s\n", file_name);
+		return -1;
+	}
+
+	synth_wav_backend_run(&backend, demo_render, song, num_blocks);
+	synth_wav_backend_report(&backend, stdout);
+	synth_wav_backend_close(&backend);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	static DemoSong song;
+	SynthConfig config;
+	const char *file_name = "synth_demo.wav";
+	int realtime = 1;
+	int sweep = 0;
+	int opt, i;
+
+	synthConfigDefault(&config);
+
+	while ((opt = getopt(argc, argv, "b:r:f:uo:B")) != -1) {
+		switch (opt) {
+		case 'b': config.block_frames = atoi(optarg); break;
+		case 'r': config.sample_rate = atoi(optarg); break;
+		case 'f': config.format = strcmp(optarg, "f32") == 0 ? SYNTH_FORMAT_F32 : SYNTH_FORMAT_S16; break;
+		case 'u': realtime = 0; break;
+		case 'o': file_name = optarg; break;
+		case 'B': sweep = 1; break;
+		default:
+			fprintf(stderr, "usage: %s [-b block_frames] [-r sample_rate] [-f s16|f32] [-u] [-o out.wav] [-B]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	for (i = 0; i < DEMO_NUM_NOTES; i++) {
+		char name[32];
+
+		snprintf(name, sizeof(name), "../C%d.wav", i + 1);
+		wavread(name, &song.notes[i]);
+	}
+
+	if (!sweep) {
+		return demo_play(&song, &config, file_name, realtime) == 0 ? 0 : 1;
+	}
+
+	for (config.block_frames = 64; config.block_frames <= 512; config.block_frames *= 2) {
+		if (demo_play(&song, &config, file_name, 0) != 0) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,164 @@
+/*
+*********************************************************************************************************
+*
+*                                      SYNTH WAV FILE BACKEND
+*
+*                                            LINUX HOST
+*
+* Filename      : synth_wav_backend.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <errno.h>
+#include <stdlib.h>
+#include "synth_wav_backend.h"
+
+static uint64_t backend_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void backend_sleep_until(const struct timespec *start, uint64_t offset_ns)
+{
+	struct timespec ts;
+	uint64_t ns = (uint64_t)start->tv_nsec + offset_ns;
+
+	ts.tv_sec = start->tv_sec + (time_t)(ns / 1000000000u);
+	ts.tv_nsec = (long)(ns % 1000000000u);
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+	}
+}
+
+int synth_wav_backend_open(SynthWavBackend *backend, const SynthConfig *config, const char *file_name, int realtime)
+{
+	size_t sample_size = config->format == SYNTH_FORMAT_F32 ? sizeof(float) : sizeof(int16_t);
+
+	backend->config = *config;
+	backend->realtime = realtime;
+	backend->frames = 0;
+	backend->blocks = 0;
+	backend->overruns = 0;
+	backend->late = 0;
+	backend->render_ns_total = 0;
+	backend->render_ns_max = 0;
+
+	backend->block = malloc((size_t)config->block_frames * 2 * sample_size);
+	backend->pcm = malloc((size_t)config->block_frames * 2 * sizeof(int16_t));
+
+	if (backend->block == NULL || backend->pcm == NULL ||
+		wav_writer_open(&backend->writer, file_name, (uint32_t)config->sample_rate, 2) != 0) {
+		free(backend->block);
+		free(backend->pcm);
+		backend->block = NULL;
+		backend->pcm = NULL;
+		return -1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &backend->start);
+	return 0;
+}
+
+uint64_t synth_wav_backend_period_ns(const SynthWavBackend *backend)
+{
+	return (uint64_t)backend->config.block_frames * 1000000000u / (uint64_t)backend->config.sample_rate;
+}
+
+int synth_wav_backend_run(SynthWavBackend *backend, SynthRenderCallback render, void *ctx, uint32_t num_blocks)
+{
+	uint64_t period_ns = synth_wav_backend_period_ns(backend);
+	int samples = backend->config.block_frames * 2;
+	uint32_t b;
+	int i;
+
+	for (b = 0; b < num_blocks; b++) {
+		uint64_t begin = backend_now_ns();
+		uint64_t elapsed;
+
+		render(ctx, backend->block, backend->config.block_frames);
+
+		elapsed = backend_now_ns() - begin;
+		backend->render_ns_total += elapsed;
+		if (elapsed > backend->render_ns_max) {
+			backend->render_ns_max = elapsed;
+		}
+		if (elapsed > period_ns) {
+			backend->overruns++;
+		}
+
+		if (backend->config.format == SYNTH_FORMAT_F32) {
+			const float *in = (const float *)backend->block;
+
+			for (i = 0; i < samples; i++) {
+				float s = in[i] * 32768.0f;
+
+				backend->pcm[i] = s >= 32767.0f ? 32767 : s <= -32768.0f ? -32768 : (int16_t)s;
+			}
+		}
+		else {
+			for (i = 0; i < samples; i++) {
+				backend->pcm[i] = ((const int16_t *)backend->block)[i];
+			}
+		}
+
+		if (backend->realtime) {
+			// Block n has to be ready by the time block n - 1 has finished playing
+			uint64_t due_ns = backend->frames * 1000000000u / (uint64_t)backend->config.sample_rate;
+			struct timespec now;
+			uint64_t now_ns;
+
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			now_ns = (uint64_t)(now.tv_sec - backend->start.tv_sec) * 1000000000u + (uint64_t)now.tv_nsec - (uint64_t)backend->start.tv_nsec;
+
+			if (now_ns > due_ns + period_ns) {
+				backend->late++;
+			}
+			else {
+				backend_sleep_until(&backend->start, due_ns);
+			}
+		}
+
+		if (wav_writer_write(&backend->writer, backend->pcm, (uint32_t)backend->config.block_frames) != 0) {
+			return -1;
+		}
+
+		backend->frames += (uint64_t)backend->config.block_frames;
+		backend->blocks++;
+	}
+
+	return 0;
+}
+
+void synth_wav_backend_report(const SynthWavBackend *backend, FILE *out)
+{
+	uint64_t period_ns = synth_wav_backend_period_ns(backend);
+	double mean_ns = backend->blocks ? (double)backend->render_ns_total / backend->blocks : 0.0;
+	double seconds = (double)backend->render_ns_total / 1e9;
+
+	fprintf(out, "block %4d frames @ %d Hz %s: %u blocks, period %.3f ms\n",
+			backend->config.block_frames, backend->config.sample_rate,
+			backend->config.format == SYNTH_FORMAT_F32 ? "f32" : "s16",
+			backend->blocks, period_ns / 1e6);
+	fprintf(out, "  render mean %.2f us, max %.2f us, throughput %.1f Mframes/s (%.0fx real time)\n",
+			mean_ns / 1e3, backend->render_ns_max / 1e3,
+			seconds > 0.0 ? backend->frames / seconds / 1e6 : 0.0,
+			mean_ns > 0.0 ? period_ns / mean_ns : 0.0);
+	fprintf(out, "  headroom mean %.1f%%, worst %.1f%%, overruns %u, late %u%s\n",
+			100.0 * (1.0 - mean_ns / period_ns),
+			100.0 * (1.0 - (double)backend->render_ns_max / period_ns),
+			backend->overruns, backend->late, backend->realtime ? "" : " (unpaced)");
+}
+
+void synth_wav_backend_close(SynthWavBackend *backend)
+{
+	wav_writer_close(&backend->writer);
+	free(backend->block);
+	free(backend->pcm);
+	backend->block = NULL;
+	backend->pcm = NULL;
+}
@@ -0,0 +1,63 @@
+/*
+*********************************************************************************************************
+*
+*                                      SYNTH WAV FILE BACKEND
+*
+*                                            LINUX HOST
+*
+* Filename      : synth_wav_backend.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Reference audio backend for the synth engine.  Pulls one block at a time through a
+* 				  SynthRenderCallback, the same way AudioOutputTask drains the engine on the board, and
+* 				  writes the blocks to a stereo WAV file.  With real-time pacing on, each block is held
+* 				  back until the moment a codec would have needed it, so a render that overruns its
+* 				  block period shows up as a late block.  Render time is measured per block either way
+* 				  and compared to the block period to give the deadline headroom.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __SYNTH_WAV_BACKEND_H__
+#define __SYNTH_WAV_BACKEND_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "../EclipseProject/VirtualPiano/Synthesizer/synth.h"
+#include "wav_writer.h"
+
+typedef struct {
+	SynthConfig     config;
+	WavWriter       writer;
+	int             realtime;		// sleep until each block's playback time
+	void           *block;			// one block in the configured format
+	int16_t        *pcm;			// the block converted for the WAV file
+	struct timespec start;
+
+	// Counters
+	uint64_t        frames;
+	uint32_t        blocks;
+	uint32_t        overruns;		// renders that took longer than a block period
+	uint32_t        late;			// blocks ready after their playback time (paced only)
+	uint64_t        render_ns_total;
+	uint64_t        render_ns_max;
+} SynthWavBackend;
+
+// Allocates the block buffers and opens the WAV file, returns 0 on success
+int synth_wav_backend_open(SynthWavBackend *backend, const SynthConfig *config, const char *file_name, int realtime);
+
+// Renders and writes num_blocks blocks of config->block_frames frames, returns 0 on success
+int synth_wav_backend_run(SynthWavBackend *backend, SynthRenderCallback render, void *ctx, uint32_t num_blocks);
+
+// Block period in nanoseconds
+uint64_t synth_wav_backend_period_ns(const SynthWavBackend *backend);
+
+// Prints throughput and headroom
+void synth_wav_backend_report(const SynthWavBackend *backend, FILE *out);
+
+// Closes the WAV file and frees the buffers
+void synth_wav_backend_close(SynthWavBackend *backend);
+
+#endif /* __SYNTH_WAV_BACKEND_H__ */
@@ -0,0 +1,150 @@
+/*
+*********************************************************************************************************
+*
+*                                      PIXEL BUFFER SIMULATION
+*
+*                                            LINUX HOST
+*
+* Filename      : vga_sim.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "vga_sim.h"
+
+// Hash of the visible part of a buffer
+static uint32_t vga_sim_hash(VgaSim *sim, uint32_t address)
+{
+	const uint8_t *pixels = vga_sim_pixels(sim, address);
+	uint32_t hash = 2166136261u;
+	int x, y;
+
+	if (pixels == NULL) {
+		return 0;
+	}
+
+	for (y = 0; y < VGA_SIM_HEIGHT; y++) {
+		for (x = 0; x < VGA_SIM_WIDTH; x++) {
+			hash = (hash ^ pixels[y * VGA_SIM_STRIDE + x]) * 16777619u;
+		}
+	}
+
+	return hash;
+}
+
+/*
+ *********************************************************************************************************
+ *                                    Register accessors
+ *********************************************************************************************************
+ */
+static uint32_t vga_sim_read(void *ctx, uint32_t offset, int width)
+{
+	VgaSim *sim = (VgaSim *)ctx;
+
+	(void)width;
+	sim->accesses++;
+
+	switch (offset) {
+	case VGA_BUFFER_FRONT_OFFSET:
+		return sim->front;
+	case VGA_BUFFER_BACK_OFFSET:
+		return sim->back;
+	case VGA_BUFFER_RESOLUTION_OFFSET:
+		return (VGA_SIM_HEIGHT << 16) | VGA_SIM_WIDTH;
+	case VGA_BUFFER_STATUS_OFFSET:
+		return sim->status;
+	}
+
+	return 0;
+}
+
+static void vga_sim_write(void *ctx, uint32_t offset, uint32_t data, int width)
+{
+	VgaSim *sim = (VgaSim *)ctx;
+
+	(void)width;
+	sim->accesses++;
+
+	switch (offset) {
+	case VGA_BUFFER_FRONT_OFFSET:
+		sim->status |= VGA_BUFFER_STATUS_SWAP;
+		break;
+	case VGA_BUFFER_BACK_OFFSET:
+		sim->back = data;
+		break;
+	}
+}
+
+/*
+ *********************************************************************************************************
+ *                                    vga_sim_init()
+ *
+ * Description : Clears the SDRAM and the counters and maps the controller's registers
+ *
+ *********************************************************************************************************
+ */
+void vga_sim_init(VgaSim *sim)
+{
+	memset(sim, 0, sizeof(*sim));
+	sim->front = VGA_BUFFER_0_ADDR;
+	sim->back = VGA_BUFFER_1_ADDR;
+	sim->front_hash = vga_sim_hash(sim, sim->front);
+
+	host_mmio_map((uintptr_t)VGA_BUFFER_CTRL_BASE, VGA_SIM_SPAN, vga_sim_read, vga_sim_write, sim);
+}
+
+uint8_t *vga_sim_pixels(VgaSim *sim, uint32_t address)
+{
+	if (address < VGA_BUFFER_0_ADDR || address - VGA_BUFFER_0_ADDR + VGA_BUFFER_SIZE > VGA_SIM_MEMORY_SPAN) {
+		return NULL;
+	}
+
+	return sim->memory + (address - VGA_BUFFER_0_ADDR);
+}
+
+void vga_sim_start(VgaSim *sim)
+{
+	sim->front_hash = vga_sim_hash(sim, sim->front);
+}
+
+/*
+ *********************************************************************************************************
+ *                                    vga_sim_retrace()
+ *
+ * Description : Ends the current refresh.  A change to the displayed buffer since the refresh began is
+ * 				 a tear.  A pending swap then exchanges Buffer and Backbuffer and clears S.
+ *
+ *********************************************************************************************************
+ */
+void vga_sim_retrace(VgaSim *sim)
+{
+	if (vga_sim_hash(sim, sim->front) != sim->front_hash) {
+		sim->tears++;
+	}
+
+	if (sim->status & VGA_BUFFER_STATUS_SWAP) {
+		uint32_t front = sim->front;
+
+		sim->front = sim->back;
+		sim->back = front;
+		sim->status &= ~VGA_BUFFER_STATUS_SWAP;
+		sim->swaps++;
+	}
+
+	sim->front_hash = vga_sim_hash(sim, sim->front);
+	sim->refreshes++;
+}
+
+void vga_sim_report(VgaSim *sim, FILE *out)
+{
+	fprintf(out, "Pixel buffer: %lu refreshes, %lu swaps, %lu torn, %lu register accesses\n",
+			sim->refreshes, sim->swaps, sim->tears, sim->accesses);
+}
+
+void vga_sim_close(VgaSim *sim)
+{
+	(void)sim;
+	host_mmio_unmap_all();
+}
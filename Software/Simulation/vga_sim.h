@@ -0,0 +1,77 @@
+/*
+*********************************************************************************************************
+*
+*                                      PIXEL BUFFER SIMULATION
+*
+*                                            LINUX HOST
+*
+* Filename      : vga_sim.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Software model of the Altera University IP "Pixel Buffer DMA Controller" as used by
+* 				  Video/vga_buffer.c, together with the FPGA SDRAM it scans the screen out of.  The
+* 				  Buffer, Backbuffer, Resolution and Status registers are mapped at
+* 				  VGA_BUFFER_CTRL_BASE through host_mmio, so the driver runs unmodified; the SDRAM is a
+* 				  host array and vga_sim_pixels() turns a bus address into a pointer into it.
+*
+* 				  Writing Buffer sets S in Status; the swap happens at the next vga_sim_retrace(), which
+* 				  stands for the end of one refresh.  The displayed buffer is hashed at each retrace and
+* 				  a refresh during which it changed is counted as a tear, since the scan-out could have
+* 				  shown part of the old picture and part of the new one.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __VGA_SIM_H__
+#define __VGA_SIM_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include "../EclipseProject/VirtualPiano/Video/vga_buffer.h"
+
+#define VGA_SIM_SPAN 16
+
+// SDRAM modelled from VGA_BUFFER_0_ADDR, room for both buffers
+#define VGA_SIM_MEMORY_SPAN (VGA_BUFFER_1_ADDR - VGA_BUFFER_0_ADDR + VGA_BUFFER_SIZE)
+
+// Visible screen
+#define VGA_SIM_WIDTH 640
+#define VGA_SIM_HEIGHT 480
+#define VGA_SIM_STRIDE 1024
+
+typedef struct {
+	// Registers
+	uint32_t        front;
+	uint32_t        back;
+	uint32_t        status;
+
+	uint8_t         memory[VGA_SIM_MEMORY_SPAN];
+	uint32_t        front_hash;		// displayed buffer at the start of this refresh
+
+	// Statistics
+	unsigned long   accesses;
+	unsigned long   refreshes;
+	unsigned long   swaps;
+	unsigned long   tears;
+} VgaSim;
+
+// Resets the model, buffer 0 in front and buffer 1 behind, and maps it into the host address space
+void vga_sim_init(VgaSim *sim);
+
+// Host pointer for a bus address in the modelled SDRAM, NULL outside it
+uint8_t *vga_sim_pixels(VgaSim *sim, uint32_t address);
+
+// Begins the first refresh; what is drawn before it is drawn with the display off
+void vga_sim_start(VgaSim *sim);
+
+// Ends a refresh: checks the displayed buffer for writes, then makes a requested swap
+void vga_sim_retrace(VgaSim *sim);
+
+// Prints the counters
+void vga_sim_report(VgaSim *sim, FILE *out);
+
+// Unmaps the model
+void vga_sim_close(VgaSim *sim);
+
+#endif /* __VGA_SIM_H__ */
@@ -0,0 +1,194 @@
+/*
+*********************************************************************************************************
+*
+*                                      PIXEL BUFFER SIMULATION DEMO
+*
+*                                            LINUX HOST
+*
+* Filename      : vga_sim_demo.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Draws the KeyDetectTask preview and key strip of a moving spot over the synthetic
+* 				  keyboard against the simulated pixel buffer controller, two refreshes per captured
+* 				  frame.  "swap" copies the regions drawn last time into the back buffer, draws the
+* 				  changed tiles and keys into it and requests a swap, as KeyDetectTask does; "copy"
+* 				  draws into a screen buffer and copies all of it over the displayed buffer every
+* 				  frame, as it used to.  The time to draw and present each frame, the bytes copied and
+* 				  the torn refreshes are printed, and the final screen is checked against a full
+* 				  redraw of the last frame.
+*
+* 				  Usage: ./vga_sim_demo [swap|copy] [frames]
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../EclipseProject/VirtualPiano/Video/video_kernel.h"
+#include "../EclipseProject/VirtualPiano/Video/key_preview.h"
+#include "../EclipseProject/VirtualPiano/Video/vga_buffer.h"
+#include "frame_file.h"
+#include "vga_sim.h"
+
+#define DEMO_FRAMES 240
+#define DEMO_REFRESHES_PER_FRAME 2
+#define DEMO_SPOT_RADIUS 4
+
+static VgaSim sim;
+static VgaBuffer vga;
+static KeyDetector detector;	// its keys and lookup table, the key strip is drawn from them
+static TileChange tiles;
+static unsigned char frame[FRAME_FILE_BYTES];
+static unsigned char screen_buffer[VGA_BUFFER_SIZE];
+static unsigned char expected[VGA_BUFFER_SIZE];
+static unsigned char changed[TILE_COUNT];
+static DirtyRects rects;
+static int spot_x, spot_y;
+
+static double demo_seconds(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// The synthetic keyboard with a lit spot moving right
+static void demo_frame(int f)
+{
+	int x, y;
+
+	spot_x = 20 + (f * 3) % (VIDEO_IN_FRAME_WIDTH - 40);
+	spot_y = 170;
+	frame_file_synthesize(frame, 0);
+
+	for (y = spot_y - DEMO_SPOT_RADIUS; y <= spot_y + DEMO_SPOT_RADIUS; y++) {
+		for (x = spot_x - DEMO_SPOT_RADIUS; x <= spot_x + DEMO_SPOT_RADIUS; x++) {
+			frame[y * VIDEO_IN_ROW_STRIDE + x] = 0xFF;
+		}
+	}
+}
+
+// Thresholds the flagged tiles into the preview quadrant of screen, adding them to dirty
+static void demo_draw(unsigned char *screen, const unsigned char *flags, DirtyRects *dirty)
+{
+	int tx, ty;
+
+	for (ty = 0; ty < TILE_ROWS; ty++) {
+		int first_row = ty * TILE_SIZE < KEY_DETECT_KEYBOARD_TOP ? KEY_DETECT_KEYBOARD_TOP : ty * TILE_SIZE;
+
+		for (tx = 0; tx < TILE_COLS; tx++) {
+			if (flags[ty * TILE_COLS + tx] && first_row < (ty + 1) * TILE_SIZE) {
+				video_threshold_rows_lut(frame + tx * TILE_SIZE, VIDEO_IN_ROW_STRIDE,
+										 screen + (KEY_PREVIEW_Y << 10) + KEY_PREVIEW_X + tx * TILE_SIZE, VGA_Y,
+										 TILE_SIZE, first_row, (ty + 1) * TILE_SIZE,
+										 &detector.lut, VIDEO_MARKER_RED, NULL);
+				if (dirty != NULL) {
+					dirty_rect_add(dirty, KEY_PREVIEW_X + tx * TILE_SIZE, KEY_PREVIEW_Y + first_row,
+								   KEY_PREVIEW_X + (tx + 1) * TILE_SIZE, KEY_PREVIEW_Y + (ty + 1) * TILE_SIZE);
+				}
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int use_copy = argc > 1 && strcmp(argv[1], "copy") == 0;
+	int num_frames = argc > 2 ? atoi(argv[2]) : DEMO_FRAMES;
+	unsigned long bytes_copied = 0, skipped = 0;
+	double busy = 0.0;
+	unsigned char all[TILE_COUNT];
+	int drawn_key = -1, key = -1;
+	int f, r, t;
+
+	vga_sim_init(&sim);
+	vga_buffer_init(&vga, (void *)VGA_BUFFER_CTRL_BASE,
+					vga_sim_pixels(&sim, VGA_BUFFER_1_ADDR), VGA_BUFFER_1_ADDR,
+					vga_sim_pixels(&sim, VGA_BUFFER_0_ADDR), VGA_BUFFER_0_ADDR);
+
+	key_detect_init(&detector);
+	key_detect_use_default(&detector);
+	tile_change_init(&tiles, TILE_SAD_THRESHOLD_DEFAULT, TILE_REFRESH_PERIOD_DEFAULT);
+	dirty_rect_init(&rects, VGA_SIM_WIDTH, VGA_SIM_HEIGHT);
+	key_preview_clear(vga.pixels[0], &detector);
+	key_preview_clear(vga.pixels[1], &detector);
+	key_preview_clear(screen_buffer, &detector);
+	memset(changed, 1, sizeof(changed));
+	vga_sim_start(&sim);
+
+	for (f = 0; f < num_frames; f++) {
+		double start;
+
+		demo_frame(f);
+		tile_change_detect(&tiles, frame, VIDEO_IN_ROW_STRIDE);
+
+		key = key_map_key_at(&detector.map, spot_x, spot_y);
+		for (t = 0; t < TILE_COUNT; t++) {
+			changed[t] |= tiles.changed[t];
+		}
+
+		start = demo_seconds();
+		if (use_copy) {
+			demo_draw(screen_buffer, changed, NULL);
+			if (key != drawn_key) {
+				if (drawn_key >= 0) {
+					key_preview_draw_key(screen_buffer, &detector, drawn_key, 0, NULL);
+				}
+				key_preview_draw_key(screen_buffer, &detector, key, 1, NULL);
+				drawn_key = key;
+			}
+			memset(changed, 0, sizeof(changed));
+			memcpy(vga.pixels[vga.back ^ 1], screen_buffer, VGA_BUFFER_SIZE);
+			bytes_copied += VGA_BUFFER_SIZE;
+		}
+		else if (vga_buffer_swap_pending(&vga)) {
+			skipped++;
+		}
+		else {
+			unsigned char *back = vga.pixels[vga.back];
+
+			dirty_rect_flush(&rects, back, vga.pixels[vga.back ^ 1], VGA_Y);
+			demo_draw(back, changed, &rects);
+			if (key != drawn_key) {
+				if (drawn_key >= 0) {
+					key_preview_draw_key(back, &detector, drawn_key, 0, &rects);
+				}
+				key_preview_draw_key(back, &detector, key, 1, &rects);
+				drawn_key = key;
+			}
+			memset(changed, 0, sizeof(changed));
+			vga_buffer_swap(&vga);
+		}
+		busy += demo_seconds() - start;
+
+		for (r = 0; r < DEMO_REFRESHES_PER_FRAME; r++) {
+			vga_sim_retrace(&sim);
+		}
+	}
+
+	// What a full redraw of the last frame would show
+	memset(all, 1, sizeof(all));
+	key_preview_clear(expected, &detector);
+	demo_draw(expected, all, NULL);
+	key_preview_draw_key(expected, &detector, key, 1, NULL);
+
+	if (!use_copy) {
+		bytes_copied = rects.bytes_flushed;
+	}
+
+	printf("%s: %d frames, %.2f us/frame to draw and present, %lu bytes copied, %lu previews put off\n",
+		   use_copy ? "copy" : "swap", num_frames, 1e6 * busy / num_frames, bytes_copied, skipped);
+	vga_sim_report(&sim, stdout);
+
+	if (memcmp(vga_sim_pixels(&sim, sim.front), expected, VGA_BUFFER_SIZE) != 0) {
+		fprintf(stderr, "screen differs from a full redraw of the last frame\n");
+		return 1;
+	}
+
+	vga_sim_close(&sim);
+	return 0;
+}
@@ -0,0 +1,82 @@
+/*
+*********************************************************************************************************
+*
+*                                      VIDEO KERNEL BENCHMARK
+*
+*                                            LINUX HOST
+*
+* Filename      : video_bench.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Checks each video module against a plain reference, then times it, over recorded or
+* 				  synthetic frames.  Every section lives in its own bench_*.c file and stops the run
+* 				  when a check fails; the frame rates are printed against the original KeyDetectTask
+* 				  loop.
+*
+* 				  Usage: ./video_bench [-n passes] [frame ...]
+*
+* 				  Frames are raw video-in dumps (see frame_file.h); with none given, eight synthetic
+* 				  frames are used.
+*
+*********************************************************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "bench.h"
+
+#define BENCH_SYNTHETIC_FRAMES 8
+#define BENCH_DEFAULT_PASSES 200
+
+int main(int argc, char **argv)
+{
+	int passes = BENCH_DEFAULT_PASSES;
+	int num_frames = 0;
+	double baseline;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:")) != -1) {
+		if (opt == 'n') {
+			passes = atoi(optarg);
+		}
+		else {
+			fprintf(stderr, "usage: %s [-n passes] [frame ...]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	for (; optind < argc && num_frames < BENCH_MAX_FRAMES; optind++) {
+		if (frame_file_load(argv[optind], bench_frames[num_frames]) != 0) {
+			fprintf(stderr, "cannot read frame %s\n", argv[optind]);
+			return 1;
+		}
+		num_frames++;
+	}
+
+	if (num_frames == 0) {
+		for (; num_frames < BENCH_SYNTHETIC_FRAMES; num_frames++) {
+			frame_file_synthesize(bench_frames[num_frames], (unsigned int)num_frames);
+		}
+		printf("%d synthetic frames, %d passes\n", num_frames, passes);
+	}
+	else {
+		printf("%d recorded frames, %d passes\n", num_frames, passes);
+	}
+
+	// Later sections detect with the map the calibration sections leave behind
+	baseline = bench_threshold_section(num_frames, passes);
+	if (baseline < 0.0 ||
+		bench_blob_section(num_frames, passes, baseline) != 0 ||
+		bench_key_cal_section(num_frames, passes, baseline) != 0 ||
+		bench_remap_section(num_frames, passes, baseline) != 0 ||
+		bench_pyramid_section(num_frames, passes, baseline) != 0 ||
+		bench_edge_section(num_frames, passes, baseline) != 0 ||
+		bench_key_state_section(passes) != 0 ||
+		bench_motion_section(passes, baseline) != 0) {
+		return 1;
+	}
+
+	return 0;
+}
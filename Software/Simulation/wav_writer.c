@@ -0,0 +1,87 @@
+/*
+*********************************************************************************************************
+*
+*                                      STREAMING WAV WRITER
+*
+*                                            LINUX HOST
+*
+* Filename      : wav_writer.c
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Little-endian host assumed, as in Software/wav.h.
+*
+*********************************************************************************************************
+*/
+
+#include <string.h>
+#include "wav_writer.h"
+
+#define WAV_HEADER_SIZE 44
+
+static void write_header(WavWriter *writer)
+{
+	uint32_t data_size = writer->frames_written * writer->num_channels * sizeof(int16_t);
+	uint32_t chunk_size = data_size + WAV_HEADER_SIZE - 8;
+	uint32_t fmtchunk_size = 16;
+	uint16_t audio_format = 1;
+	uint16_t block_align = writer->num_channels * sizeof(int16_t);
+	uint32_t byte_rate = writer->sample_rate * block_align;
+	uint16_t bps = 16;
+
+	fseek(writer->file, 0, SEEK_SET);
+	fwrite("RIFF", 1, 4, writer->file);
+	fwrite(&chunk_size, sizeof(chunk_size), 1, writer->file);
+	fwrite("WAVE", 1, 4, writer->file);
+	fwrite("fmt ", 1, 4, writer->file);
+	fwrite(&fmtchunk_size, sizeof(fmtchunk_size), 1, writer->file);
+	fwrite(&audio_format, sizeof(audio_format), 1, writer->file);
+	fwrite(&writer->num_channels, sizeof(writer->num_channels), 1, writer->file);
+	fwrite(&writer->sample_rate, sizeof(writer->sample_rate), 1, writer->file);
+	fwrite(&byte_rate, sizeof(byte_rate), 1, writer->file);
+	fwrite(&block_align, sizeof(block_align), 1, writer->file);
+	fwrite(&bps, sizeof(bps), 1, writer->file);
+	fwrite("data", 1, 4, writer->file);
+	fwrite(&data_size, sizeof(data_size), 1, writer->file);
+}
+
+int wav_writer_open(WavWriter *writer, const char *file_name, uint32_t sample_rate, uint16_t num_channels)
+{
+	memset(writer, 0, sizeof(*writer));
+
+	if ((writer->file = fopen(file_name, "wb")) == NULL) {
+		return -1;
+	}
+
+	writer->sample_rate = sample_rate;
+	writer->num_channels = num_channels;
+	write_header(writer);
+
+	return 0;
+}
+
+int wav_writer_write(WavWriter *writer, const int16_t *frames, uint32_t num_frames)
+{
+	if (writer->file == NULL) {
+		return -1;
+	}
+
+	if (fwrite(frames, sizeof(int16_t) * writer->num_channels, num_frames, writer->file) != num_frames) {
+		return -1;
+	}
+
+	writer->frames_written += num_frames;
+
+	return 0;
+}
+
+void wav_writer_close(WavWriter *writer)
+{
+	if (writer->file == NULL) {
+		return;
+	}
+
+	write_header(writer);
+	fclose(writer->file);
+	writer->file = NULL;
+}
@@ -0,0 +1,41 @@
+/*
+*********************************************************************************************************
+*
+*                                      STREAMING WAV WRITER
+*
+*                                            LINUX HOST
+*
+* Filename      : wav_writer.h
+* Version       : V1.00
+*
+*********************************************************************************************************
+* Note(s)       : Writes 16-bit PCM WAV files a block at a time.  The RIFF and data chunk sizes are
+* 				  patched in when the file is closed, so the total length does not need to be known
+* 				  up front.  Header layout matches WavHeader in Software/wav.h.
+*
+*********************************************************************************************************
+*/
+
+#ifndef __WAV_WRITER_H__
+#define __WAV_WRITER_H__
+
+#include <stdio.h>
+#include <stdint.h>
+
+typedef struct {
+	FILE       *file;
+	uint16_t    num_channels;
+	uint32_t    sample_rate;
+	uint32_t    frames_written;
+} WavWriter;
+
+// Opens file_name and writes a placeholder header, returns 0 on success
+int wav_writer_open(WavWriter *writer, const char *file_name, uint32_t sample_rate, uint16_t num_channels);
+
+// Appends num_frames interleaved frames
+int wav_writer_write(WavWriter *writer, const int16_t *frames, uint32_t num_frames);
+
+// Patches the header sizes and closes the file
+void wav_writer_close(WavWriter *writer);
+
+#endif /* __WAV_WRITER_H__ */